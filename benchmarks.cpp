@@ -0,0 +1,294 @@
+#include "LibS.h"
+
+#include <iostream>
+#include <ostream>
+#include <fstream>
+#include <chrono>
+#include <cstddef>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Keeps results alive so the measured work is not optimized away.
+    volatile double benchmarkSink;
+
+    template <typename FuncT>
+    double measureSeconds(FuncT&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    template <typename T>
+    const char* typeName();
+    template <>
+    const char* typeName<float>() { return "float"; }
+    template <>
+    const char* typeName<double>() { return "double"; }
+
+    template <typename T, int DimV, typename RngT>
+    ls::VecT<T, DimV> randomPoint(RngT& rng, T range)
+    {
+        std::uniform_real_distribution<T> dist(-range, range);
+        if constexpr (DimV == 1) return dist(rng);
+        else if constexpr (DimV == 2) return ls::Vec2<T>(dist(rng), dist(rng));
+        else if constexpr (DimV == 3) return ls::Vec3<T>(dist(rng), dist(rng), dist(rng));
+        else return ls::Vec4<T>(dist(rng), dist(rng), dist(rng), dist(rng));
+    }
+
+    template <typename T, int DimV>
+    std::vector<ls::VecT<T, DimV>> randomPoints(int count, T range)
+    {
+        std::mt19937 rng(1234);
+        std::vector<ls::VecT<T, DimV>> points;
+        points.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            points.emplace_back(randomPoint<T, DimV>(rng, range));
+        }
+        return points;
+    }
+
+    enum struct NoiseBenchmarkMode
+    {
+        Value,
+        Derivative
+    };
+
+    struct NoiseBenchmarkResult
+    {
+        std::string generator;
+        std::string hash;
+        std::string type;
+        int dim;
+        NoiseBenchmarkMode mode;
+        int octaves;
+        long long samples;
+        double seconds;
+    };
+
+    void printCsvHeader(std::ostream& out)
+    {
+        out << "generator,hash,type,dim,mode,octaves,samples,seconds,msamples_per_second\n";
+    }
+
+    void printCsvRow(std::ostream& out, const NoiseBenchmarkResult& result)
+    {
+        out
+            << result.generator << ','
+            << result.hash << ','
+            << result.type << ','
+            << result.dim << ','
+            << (result.mode == NoiseBenchmarkMode::Value ? "value" : "derivative") << ','
+            << result.octaves << ','
+            << result.samples << ','
+            << result.seconds << ','
+            << static_cast<double>(result.samples) / result.seconds / 1e6 << '\n';
+    }
+
+    // Samples every point once through a NoiseSampler with the given octave count.
+    // One octave goes straight to raw/rawDerivative.
+    template <typename T, int DimV, bool HasDerivativeV, typename NoiseT>
+    double measureNoise(NoiseT& noise, const std::vector<ls::VecT<T, DimV>>& points, NoiseBenchmarkMode mode, int octaves)
+    {
+        ls::NoiseSampler<T, DimV> sampler;
+        sampler.setOctaves(octaves);
+        sampler.setPersistence(T(0.5));
+
+        double sum = 0.0;
+        const double seconds = measureSeconds([&]() {
+            if (mode == NoiseBenchmarkMode::Value)
+            {
+                for (const auto& p : points)
+                {
+                    sum += sampler.sample(p, noise);
+                }
+            }
+            else if constexpr (HasDerivativeV)
+            {
+                for (const auto& p : points)
+                {
+                    sum += sampler.sampleDerivative(p, noise).value;
+                }
+            }
+        });
+        benchmarkSink = sum;
+
+        return seconds;
+    }
+
+    template <typename T, int DimV, bool HasDerivativeV, typename NoiseT>
+    void benchmarkNoise(
+        std::ostream& out,
+        const std::string& generator,
+        const std::string& hash,
+        NoiseT& noise,
+        int minOctaves,
+        int maxOctaves,
+        int numSamples)
+    {
+        const auto points = randomPoints<T, DimV>(numSamples, T(1000));
+
+        for (NoiseBenchmarkMode mode : { NoiseBenchmarkMode::Value, NoiseBenchmarkMode::Derivative })
+        {
+            if (mode == NoiseBenchmarkMode::Derivative && !HasDerivativeV) continue;
+
+            for (int octaves = minOctaves; octaves <= maxOctaves; ++octaves)
+            {
+                const double seconds = measureNoise<T, DimV, HasDerivativeV>(noise, points, mode, octaves);
+                printCsvRow(out, NoiseBenchmarkResult{ generator, hash, typeName<T>(), DimV, mode, octaves, numSamples, seconds });
+            }
+        }
+    }
+
+    template <typename T, typename HashT, typename MakeHashT>
+    void benchmarkGenerators(std::ostream& out, const std::string& hash, MakeHashT&& makeHash, int minOctaves, int maxOctaves, int numSamples)
+    {
+        ls::PerlinNoise<T, HashT> perlin(makeHash());
+        ls::SimplexNoise<T, HashT> simplex(makeHash());
+
+        benchmarkNoise<T, 1, false>(out, "perlin", hash, perlin, minOctaves, maxOctaves, numSamples);
+        benchmarkNoise<T, 2, false>(out, "perlin", hash, perlin, minOctaves, maxOctaves, numSamples);
+        benchmarkNoise<T, 3, false>(out, "perlin", hash, perlin, minOctaves, maxOctaves, numSamples);
+        benchmarkNoise<T, 4, false>(out, "perlin", hash, perlin, minOctaves, maxOctaves, numSamples);
+
+        benchmarkNoise<T, 1, true>(out, "simplex", hash, simplex, minOctaves, maxOctaves, numSamples);
+        benchmarkNoise<T, 2, true>(out, "simplex", hash, simplex, minOctaves, maxOctaves, numSamples);
+        benchmarkNoise<T, 3, true>(out, "simplex", hash, simplex, minOctaves, maxOctaves, numSamples);
+        benchmarkNoise<T, 4, true>(out, "simplex", hash, simplex, minOctaves, maxOctaves, numSamples);
+    }
+
+    struct AllocationBenchmarkResult
+    {
+        std::string allocator;
+        int width;
+        int height;
+        long long arrays;
+        double seconds;
+    };
+
+    void printAllocationCsvHeader(std::ostream& out)
+    {
+        out << "allocator,width,height,arrays,seconds,marrays_per_second\n";
+    }
+
+    void printAllocationCsvRow(std::ostream& out, const AllocationBenchmarkResult& result)
+    {
+        out
+            << result.allocator << ','
+            << result.width << ','
+            << result.height << ','
+            << result.arrays << ','
+            << result.seconds << ','
+            << static_cast<double>(result.arrays) / result.seconds / 1e6 << '\n';
+    }
+
+    // Creates arraysPerFrame temporary arrays every frame and destroys them at the end of it,
+    // like scratch grids of per frame algorithms. endFrame is called after the arrays are destroyed.
+    template <typename ArrayT, typename MakeArrayT, typename EndFrameT>
+    double measureTemporaryArrays(int numFrames, int arraysPerFrame, MakeArrayT&& makeArray, EndFrameT&& endFrame)
+    {
+        std::vector<ArrayT> frameArrays;
+        frameArrays.reserve(arraysPerFrame);
+
+        double sum = 0.0;
+        const double seconds = measureSeconds([&]() {
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                for (int i = 0; i < arraysPerFrame; ++i)
+                {
+                    frameArrays.emplace_back(makeArray());
+                    ArrayT& arr = frameArrays.back();
+                    arr(i % arr.width(), 0) = 1.0f;
+                    sum += arr(0, 0);
+                }
+                frameArrays.clear();
+                endFrame();
+            }
+        });
+        benchmarkSink = sum;
+
+        return seconds;
+    }
+}
+
+// Writes one CSV row per configuration:
+// both generators, 1D-4D, value and derivative (simplex only), float and double, 1-8 octaves.
+void runNoiseBenchmarks(std::ostream& out, int numSamples = 1 << 16)
+{
+    const auto makeHash = []() { return ls::OriginalPerlinPermTable{}; };
+
+    printCsvHeader(out);
+    benchmarkGenerators<float, ls::OriginalPerlinPermTable>(out, "OriginalPerlinPermTable", makeHash, 1, 8, numSamples);
+    benchmarkGenerators<double, ls::OriginalPerlinPermTable>(out, "OriginalPerlinPermTable", makeHash, 1, 8, numSamples);
+}
+
+// Same CSV format, single octave float noise for every hash policy.
+// makeHash is called for every noise generator, not all tables are copyable.
+void runHashBenchmarks(std::ostream& out, int numSamples = 1 << 18)
+{
+    printCsvHeader(out);
+    benchmarkGenerators<float, ls::OriginalPerlinPermTable>(out, "OriginalPerlinPermTable", []() { return ls::OriginalPerlinPermTable{}; }, 1, 1, numSamples);
+    benchmarkGenerators<float, ls::PermTable<256>>(out, "PermTable<256>", []() { return ls::PermTable<256>::shuffled(std::mt19937(1234)); }, 1, 1, numSamples);
+    benchmarkGenerators<float, ls::CompactPermTable>(out, "CompactPermTable", []() { return ls::CompactPermTable::shuffled(std::mt19937(1234)); }, 1, 1, numSamples);
+    benchmarkGenerators<float, ls::IntegerHash>(out, "IntegerHash", []() { return ls::IntegerHash{}; }, 1, 1, numSamples);
+    benchmarkGenerators<float, ls::SeededIntegerHash>(out, "SeededIntegerHash", []() { return ls::SeededIntegerHash(1234); }, 1, 1, numSamples);
+}
+
+// One CSV row per allocator and array size. Compares the global heap
+// with a per frame arena (monotonic buffer released after every frame) and a pool.
+void runAllocationBenchmarks(std::ostream& out, int numFrames = 64, int arraysPerFrame = 256)
+{
+    printAllocationCsvHeader(out);
+    for (int size : { 8, 32, 128 })
+    {
+        const long long numArrays = static_cast<long long>(numFrames) * arraysPerFrame;
+
+        const double heapSeconds = measureTemporaryArrays<ls::Array2<float>>(
+            numFrames, arraysPerFrame,
+            [size]() { return ls::Array2<float>(size, size); },
+            []() {}
+        );
+        printAllocationCsvRow(out, AllocationBenchmarkResult{ "new", size, size, numArrays, heapSeconds });
+
+        // big enough for a whole frame, so the arena never goes upstream
+        std::vector<std::byte> frameBuffer(static_cast<std::size_t>(arraysPerFrame) * size * size * sizeof(float) * 2);
+        std::pmr::monotonic_buffer_resource arena(frameBuffer.data(), frameBuffer.size());
+        const double arenaSeconds = measureTemporaryArrays<ls::pmr::Array2<float>>(
+            numFrames, arraysPerFrame,
+            [size, &arena]() { return ls::pmr::Array2<float>(size, size, &arena); },
+            [&arena]() { arena.release(); }
+        );
+        printAllocationCsvRow(out, AllocationBenchmarkResult{ "monotonic_buffer_resource", size, size, numArrays, arenaSeconds });
+
+        std::pmr::unsynchronized_pool_resource pool;
+        const double poolSeconds = measureTemporaryArrays<ls::pmr::Array2<float>>(
+            numFrames, arraysPerFrame,
+            [size, &pool]() { return ls::pmr::Array2<float>(size, size, &pool); },
+            []() {}
+        );
+        printAllocationCsvRow(out, AllocationBenchmarkResult{ "unsynchronized_pool_resource", size, size, numArrays, poolSeconds });
+    }
+}
+
+// Sections have different columns, so each one goes to its own file with a single header.
+void mainBenchmarks()
+{
+    {
+        std::ofstream out("noise_benchmarks.csv");
+        runNoiseBenchmarks(out);
+    }
+    {
+        std::ofstream out("hash_benchmarks.csv");
+        runHashBenchmarks(out);
+    }
+    {
+        std::ofstream out("allocation_benchmarks.csv");
+        runAllocationBenchmarks(out);
+    }
+}
@@ -1,11 +1,20 @@
 #include "LibS.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 template struct ls::Array2<int>;
 template struct ls::Array3<int>;
 template struct ls::Array3<int, 4, 4, 4>;
+template struct ls::Array2<int, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Dynamic, ls::RowMajorLayout>;
+template struct ls::Array3<int, 4, 4, 4, ls::ArrayStorageType::Automatic, ls::MortonTiledLayout<2>>;
+template struct ls::Array2<float, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Dynamic, ls::PaddedColumnMajorLayout<16>, ls::AlignedAllocator<float, 64>>;
+template struct ls::Array2<float, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Mapped>;
+template struct ls::Array3<int, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Mapped>;
+template struct ls::Array2View<int>;
+template struct ls::Array3View<float>;
 
 template struct ls::Vec2<float>;
 template struct ls::Edge2<float>;
@@ -32,6 +41,8 @@ template struct ls::EulerAngles<float>;
 template struct ls::AxisAngle<float>;
 
 template struct ls::CellularAutomaton2<ls::ConwaysGameOfLifeRule, ls::CellularAutomatonTopology::Finite>;
+template struct ls::BitPackedCellularAutomaton2<ls::ConwaysGameOfLifeRule, ls::CellularAutomatonTopology::Toroidal>;
+template struct ls::BitPackedCellularAutomaton2<ls::LifeLikeRule, ls::CellularAutomatonTopology::Finite>;
 
 template struct ls::Matrix<float, 2, 2>;
 template struct ls::Matrix<float, 2, 4>;
@@ -99,6 +110,40 @@ void mainExamples()
         ls::NoiseSampler2F sampler;
 
         std::cout << sampler.sample(ls::Vec2<float>(124.0f, 321.0f), noise) << '\n';
+
+        ls::Array2<float> heightmap(64, 64);
+        sampler.setOctaves(4);
+        sampler.sampleGrid(heightmap, ls::Vec2<float>(124.0f, 321.0f), ls::Vec2<float>(0.5f, 0.5f), noise);
+        std::cout << heightmap(10, 20) << '\n';
+
+        std::vector<ls::Vec2<float>> coords;
+        for (int i = 0; i < 37; ++i)
+        {
+            coords.emplace_back(i * 0.37f, i * -0.73f);
+        }
+        std::vector<float> values(coords.size());
+        noise.rawBatch(coords.data(), coords.size(), ls::Vec2<int>(256, 256), values.data());
+        std::cout << values[20] << '\n';
+
+        ls::ThreadPool pool(4);
+        ls::NoiseFieldGenerator generator(pool, 32);
+        ls::Array2<float> region(256, 256);
+        generator.generate(region, sampler, ls::Vec2<float>(124.0f, 321.0f), ls::Vec2<float>(0.5f, 0.5f), noise);
+        std::cout << region(10, 20) << '\n';
+
+        ls::FractalNoiseSampler2F fractal;
+        fractal.setOctaves(8);
+        fractal.setPersistence(0.5f);
+        fractal.setType(ls::FractalNoiseType::Ridged);
+        fractal.setWarpStrength(4.0f);
+        auto shading = fractal.sampleWarpedDerivative(ls::Vec2<float>(124.0f, 321.0f), noise);
+        std::cout << shading.value << ' ' << shading.derivative.x << ' ' << shading.derivative.y << '\n';
+
+        ls::FixedOctaveNoiseSampler<float, 2, 4, std::ratio<1, 2>> fixedSampler;
+        std::cout << fixedSampler.sample(ls::Vec2<float>(124.0f, 321.0f), noise) << '\n';
+
+        ls::NoiseTileCache<float> tileCache(64, 0.5f, 16 * 1024 * 1024);
+        std::cout << tileCache.sample(sampler, noise, 1234, ls::Vec2<float>(124.25f, 321.75f)) << '\n';
     }
 
     std::cout << ls::Triangle3F({ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }).area() << '\n';
@@ -440,6 +485,55 @@ void mainExamples()
         ca.iterate(1);
 
         std::cout << static_cast<int>(ca(99, 99)) << '\n';
+
+        ls::ThreadPool pool;
+        ca.compileRule(2);
+        ca.iterate(10, pool);
+
+        std::cout << static_cast<int>(ca(99, 99)) << '\n';
+        std::cout << ca.activeTileCount() << ' ' << ca.activeCellCount() << '\n';
+    }
+
+    {
+        //cave smoothing, a cell becomes a wall when at least half of the 7x7 region are walls
+        enum struct Cave { Floor, Wall };
+        std::vector<Cave> outputs(50, Cave::Floor);
+        std::fill(outputs.begin() + 25, outputs.end(), Cave::Wall);
+
+        auto ca = ls::FiniteCellularAutomaton2<ls::RadiusQuantityRule<Cave>>(200, 200, ls::RadiusQuantityRule<Cave>(Cave::Wall, 3, outputs));
+        ca.fill([](auto x, auto y) {return (x * 31 + y * 17) % 7 < 3 ? Cave::Wall : Cave::Floor; });
+        ca.iterate(4);
+
+        std::cout << static_cast<int>(ca(100, 100)) << '\n';
+    }
+
+    {
+        auto ca = ls::ToroidalBitPackedCellularAutomaton2<ls::ConwaysGameOfLifeRule>(1000, 1000);
+        ca.fill([](auto x, auto y) {return (x * 7 + y * 13) % 5 == 0 ? ls::ConwaysGameOfLifeRule::StateType::Live : ls::ConwaysGameOfLifeRule::StateType::Dead; });
+        ca.iterate(100);
+
+        std::cout << ca.numLiveCells() << '\n';
+
+        auto highLife = ls::FiniteBitPackedCellularAutomaton2<ls::LifeLikeRule>(100, 100, ls::LifeLikeRule(0b1001000, 0b1100));
+        highLife.set(50, 50, ls::LifeLikeRule::StateType::Live);
+        highLife.iterate(1);
+
+        std::cout << static_cast<int>(highLife(50, 50)) << '\n';
+    }
+
+    {
+        //glider
+        using State = ls::ConwaysGameOfLifeRule::StateType;
+        ls::HashLife<ls::ConwaysGameOfLifeRule> life;
+        life.set(1, 0, State::Live);
+        life.set(2, 1, State::Live);
+        life.set(0, 2, State::Live);
+        life.set(1, 2, State::Live);
+        life.set(2, 2, State::Live);
+        life.advance(1000000000);
+
+        const auto region = life.extract(250000000, 250000000, 3, 3);
+        std::cout << life.population() << ' ' << static_cast<int>(region(1, 0)) << '\n';
     }
 
     {
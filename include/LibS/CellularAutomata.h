@@ -1,3 +1,5 @@
 #pragma once
 
 #include "CellularAutomata/CellularAutomaton2.h"
+#include "CellularAutomata/BitPackedCellularAutomaton2.h"
+#include "CellularAutomata/HashLife.h"
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "CellularAutomaton2.h"
+
+#include "LibS/Detail.h"
+
+#include "Fwd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ls
+{
+    // Cellular automaton for two state outer totalistic rules (ConwaysGameOfLifeRule, LifeLikeRule).
+    // Cells are stored as bits, 64 consecutive cells of a column per word, and a whole word
+    // is advanced at once by summing the 8 shifted neighbour words with bitwise adders.
+    // RuleT has to provide StateType with Dead and Live, birthMask() and survivalMask().
+    // Produces the same generations as CellularAutomaton2 with the same rule and topology.
+    template <typename RuleT, CellularAutomatonTopology TopologyV>
+    struct BitPackedCellularAutomaton2 : protected RuleT
+    {
+    public:
+        using RuleType = RuleT;
+        using StateType = typename RuleT::StateType;
+        using SizeType = detail::SizeType;
+        using WordType = std::uint64_t;
+        static constexpr CellularAutomatonTopology topology = TopologyV;
+        static constexpr SizeType cellsPerWord = 64;
+
+        //only for rules that can be default constructed, so that explicit instantiations with other rules compile
+        template <typename RuleFwdT = RuleT, typename EnableT = std::enable_if_t<std::is_default_constructible<RuleFwdT>::value>>
+        BitPackedCellularAutomaton2(SizeType width, SizeType height) :
+            RuleType{},
+            m_width(width),
+            m_height(height),
+            m_wordsPerColumn((height + cellsPerWord - 1) / cellsPerWord),
+            m_words(static_cast<std::size_t>(width * m_wordsPerColumn), 0),
+            m_nextWords(m_words.size(), 0),
+            m_emptyColumn(static_cast<std::size_t>(m_wordsPerColumn), 0)
+        {
+
+        }
+
+        template <typename RuleFwdT>
+        BitPackedCellularAutomaton2(SizeType width, SizeType height, RuleFwdT&& rule) :
+            RuleType(std::forward<RuleFwdT>(rule)),
+            m_width(width),
+            m_height(height),
+            m_wordsPerColumn((height + cellsPerWord - 1) / cellsPerWord),
+            m_words(static_cast<std::size_t>(width * m_wordsPerColumn), 0),
+            m_nextWords(m_words.size(), 0),
+            m_emptyColumn(static_cast<std::size_t>(m_wordsPerColumn), 0)
+        {
+
+        }
+
+        BitPackedCellularAutomaton2(const BitPackedCellularAutomaton2&) = default;
+        BitPackedCellularAutomaton2(BitPackedCellularAutomaton2&&) noexcept = default;
+        BitPackedCellularAutomaton2& operator=(const BitPackedCellularAutomaton2&) = default;
+        BitPackedCellularAutomaton2& operator=(BitPackedCellularAutomaton2&&) noexcept = default;
+        ~BitPackedCellularAutomaton2() = default;
+
+        StateType operator()(SizeType x, SizeType y) const
+        {
+            return (word(x, y) >> bitIndex(y)) & 1u ? StateType::Live : StateType::Dead;
+        }
+
+        StateType at(SizeType x, SizeType y) const
+        {
+            return operator()(x, y);
+        }
+
+        void set(SizeType x, SizeType y, StateType state)
+        {
+            const WordType bit = WordType(1) << bitIndex(y);
+            if (state == StateType::Live) word(x, y) |= bit;
+            else word(x, y) &= ~bit;
+        }
+
+        void fill(StateType state)
+        {
+            for (SizeType x = 0; x < m_width; ++x)
+            {
+                for (SizeType i = 0; i < m_wordsPerColumn; ++i)
+                {
+                    m_words[wordIndex(x, i)] = state == StateType::Live ? validBits(i) : 0;
+                }
+            }
+        }
+
+        //fill function must take x, y as coordinates and output valid State
+        template <typename FillFunction>
+        void fill(FillFunction fillingFunction)
+        {
+            for (SizeType x = 0; x < m_width; ++x)
+            {
+                for (SizeType y = 0; y < m_height; ++y)
+                {
+                    set(x, y, fillingFunction(x, y));
+                }
+            }
+        }
+
+        void iterate(SizeType numIters = 1)
+        {
+            while (numIters--)
+            {
+                for (SizeType x = 0; x < m_width; ++x)
+                {
+                    const WordType* left = column(x - 1);
+                    const WordType* center = column(x);
+                    const WordType* right = column(x + 1);
+                    WordType* next = m_nextWords.data() + wordIndex(x, 0);
+
+                    for (SizeType i = 0; i < m_wordsPerColumn; ++i)
+                    {
+                        next[i] = nextWord(left, center, right, i);
+                    }
+                }
+
+                m_words.swap(m_nextWords);
+            }
+        }
+
+        SizeType width() const
+        {
+            return m_width;
+        }
+
+        SizeType height() const
+        {
+            return m_height;
+        }
+
+        SizeType numLiveCells() const
+        {
+            SizeType quantity = 0;
+            for (WordType w : m_words)
+            {
+                quantity += popcount(w);
+            }
+            return quantity;
+        }
+
+    protected:
+        SizeType m_width;
+        SizeType m_height;
+        SizeType m_wordsPerColumn;
+        std::vector<WordType> m_words; //column major, bit b of word i in a column is cell y = i * cellsPerWord + b
+        std::vector<WordType> m_nextWords;
+        std::vector<WordType> m_emptyColumn; //neighbour of the border columns in finite topology
+
+    private:
+        static SizeType bitIndex(SizeType y)
+        {
+            return y % cellsPerWord;
+        }
+
+        static SizeType popcount(WordType w)
+        {
+            SizeType quantity = 0;
+            for (; w; w &= w - 1) ++quantity;
+            return quantity;
+        }
+
+        SizeType wordIndex(SizeType x, SizeType i) const
+        {
+            return x * m_wordsPerColumn + i;
+        }
+
+        const WordType& word(SizeType x, SizeType y) const
+        {
+            return m_words[wordIndex(x, y / cellsPerWord)];
+        }
+        WordType& word(SizeType x, SizeType y)
+        {
+            return m_words[wordIndex(x, y / cellsPerWord)];
+        }
+
+        //bits of the i-th word of a column that correspond to cells
+        WordType validBits(SizeType i) const
+        {
+            const SizeType numBits = m_height - i * cellsPerWord;
+            return numBits >= cellsPerWord ? ~WordType(0) : (WordType(1) << numBits) - 1;
+        }
+
+        //x may be one outside of the grid
+        const WordType* column(SizeType x) const
+        {
+            if (x < 0 || x >= m_width)
+            {
+                if constexpr (TopologyV == CellularAutomatonTopology::Toroidal)
+                {
+                    x = (x + m_width) % m_width;
+                }
+                else
+                {
+                    return m_emptyColumn.data();
+                }
+            }
+
+            return m_words.data() + wordIndex(x, 0);
+        }
+
+        //cells at y - 1 moved to the bit of y
+        WordType shiftedFromAbove(const WordType* col, SizeType i) const
+        {
+            WordType carry = 0;
+            if (i > 0) carry = col[i - 1] >> (cellsPerWord - 1);
+            else if constexpr (TopologyV == CellularAutomatonTopology::Toroidal)
+            {
+                const SizeType last = m_height - 1;
+                carry = (col[last / cellsPerWord] >> bitIndex(last)) & 1u;
+            }
+
+            return (col[i] << 1) | carry;
+        }
+
+        //cells at y + 1 moved to the bit of y
+        WordType shiftedFromBelow(const WordType* col, SizeType i) const
+        {
+            WordType carry = 0;
+            if (i < m_wordsPerColumn - 1) carry = col[i + 1] << (cellsPerWord - 1);
+            else if constexpr (TopologyV == CellularAutomatonTopology::Toroidal)
+            {
+                carry = (col[0] & 1u) << bitIndex(m_height - 1);
+            }
+
+            return (col[i] >> 1) | carry;
+        }
+
+        //bits that are not cells may hold garbage until the final mask, lanes don't interact
+        WordType nextWord(const WordType* left, const WordType* center, const WordType* right, SizeType i) const
+        {
+            const WordType cells = center[i];
+
+            //full adders over the 8 neighbours, the count ends up in 4 bit planes
+            WordType ones0, twos0, ones1, twos1, ones2, twos2;
+            fullAdd(shiftedFromAbove(left, i), left[i], shiftedFromBelow(left, i), ones0, twos0);
+            fullAdd(shiftedFromAbove(right, i), right[i], shiftedFromBelow(right, i), ones1, twos1);
+            halfAdd(shiftedFromAbove(center, i), shiftedFromBelow(center, i), ones2, twos2);
+
+            WordType count1, carry1;
+            fullAdd(ones0, ones1, ones2, count1, carry1);
+
+            WordType twos, fours0, count2, fours1;
+            fullAdd(twos0, twos1, twos2, twos, fours0);
+            halfAdd(twos, carry1, count2, fours1);
+
+            const WordType count4 = fours0 ^ fours1;
+            const WordType count8 = fours0 & fours1;
+
+            const unsigned birthMask = RuleType::birthMask();
+            const unsigned survivalMask = RuleType::survivalMask();
+
+            WordType result = 0;
+            for (unsigned n = 0; n <= 8; ++n)
+            {
+                if (!(((birthMask | survivalMask) >> n) & 1u)) continue;
+
+                const WordType matches =
+                    (n & 1u ? count1 : ~count1)
+                    & (n & 2u ? count2 : ~count2)
+                    & (n & 4u ? count4 : ~count4)
+                    & (n & 8u ? count8 : ~count8);
+
+                WordType outcome = 0;
+                if ((birthMask >> n) & 1u) outcome |= ~cells;
+                if ((survivalMask >> n) & 1u) outcome |= cells;
+
+                result |= matches & outcome;
+            }
+
+            return result & validBits(i);
+        }
+
+        static void halfAdd(WordType a, WordType b, WordType& sum, WordType& carry)
+        {
+            sum = a ^ b;
+            carry = a & b;
+        }
+
+        static void fullAdd(WordType a, WordType b, WordType c, WordType& sum, WordType& carry)
+        {
+            const WordType ab = a ^ b;
+            sum = ab ^ c;
+            carry = (a & b) | (ab & c);
+        }
+    };
+
+    template <typename RuleT>
+    using FiniteBitPackedCellularAutomaton2 = BitPackedCellularAutomaton2<RuleT, CellularAutomatonTopology::Finite>;
+
+    template <typename RuleT>
+    using ToroidalBitPackedCellularAutomaton2 = BitPackedCellularAutomaton2<RuleT, CellularAutomatonTopology::Toroidal>;
+}
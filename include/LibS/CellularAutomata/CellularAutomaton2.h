@@ -5,19 +5,68 @@
 #include "LibS/Shapes/Box2.h"
 
 #include "LibS/Detail.h"
+#include "LibS/ThreadPool.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace ls
 {
+    namespace detail
+    {
+        template <typename RuleT, typename = void>
+        struct HasCountedStates : std::false_type {};
+
+        template <typename RuleT>
+        struct HasCountedStates<RuleT, std::void_t<decltype(std::declval<const RuleT&>().countedStates())>> : std::true_type {};
+
+        template <typename RuleT, typename = void>
+        struct HasRuleRadius : std::false_type {};
+
+        template <typename RuleT>
+        struct HasRuleRadius<RuleT, std::void_t<decltype(std::declval<const RuleT&>().radius())>> : std::true_type {};
+
+        //chessboard distance of the furthest cell the rule looks at, 1 unless the rule has radius()
+        template <typename RuleT, typename = void>
+        struct RuleRadius
+        {
+            static SizeType get(const RuleT&)
+            {
+                return 1;
+            }
+        };
+
+        template <typename RuleT>
+        struct RuleRadius<RuleT, std::void_t<decltype(std::declval<const RuleT&>().radius())>>
+        {
+            static SizeType get(const RuleT& rule)
+            {
+                return static_cast<SizeType>(rule.radius());
+            }
+        };
+    }
+
     enum struct CellularAutomatonTopology
     {
         Finite,
         Toroidal //for toroidal space it is still required that passed coordinates are inside the bounds
     };
 
+    //if the rule has countedStates() returning a range of states then before each generation
+    //a summed-area table is built for each of them and occurencesIn* queries
+    //for these states take constant time regardless of the size of the region
+    //the grid is divided into tiles and, with change tracking enabled, iterate only evaluates tiles
+    //that are within the rule's radius of a tile that changed in the previous generation,
+    //the rest is known to stay the same
+    //this requires the rule to declare radius() and the next state of a cell to depend only on
+    //the previous states in that radius, so tracking is enabled by default only for rules with radius()
+    //and has to be disabled with setChangeTracking for rules that are stateful or otherwise impure
     template <typename RuleT, CellularAutomatonTopology TopologyV> //class representing a rule
     struct CellularAutomaton2 : protected RuleT
     {
@@ -29,17 +78,25 @@ namespace ls
 
         CellularAutomaton2(SizeType width, SizeType height) :
             RuleType{},
-            m_cells(width, height)
+            m_cells(width, height),
+            m_nextCells(width, height),
+            m_summedAreaTablesValid(false),
+            m_isChangeTrackingEnabled(detail::HasRuleRadius<RuleType>::value),
+            m_compiledRuleBits(0)
         {
-
+            setTileSize(defaultTileSize);
         }
 
         template <typename RuleFwdT>
         CellularAutomaton2(SizeType width, SizeType height, RuleFwdT&& rule) :
             RuleType(std::forward<RuleFwdT>(rule)),
-            m_cells(width, height)
+            m_cells(width, height),
+            m_nextCells(width, height),
+            m_summedAreaTablesValid(false),
+            m_isChangeTrackingEnabled(detail::HasRuleRadius<RuleType>::value),
+            m_compiledRuleBits(0)
         {
-
+            setTileSize(defaultTileSize);
         }
 
         CellularAutomaton2(const CellularAutomaton2&) = default;
@@ -54,6 +111,7 @@ namespace ls
         }
         StateType& operator()(SizeType x, SizeType y)
         {
+            markChanged(x, y);
             return m_cells(x, y);
         }
 
@@ -63,11 +121,13 @@ namespace ls
         }
         StateType& at(SizeType x, SizeType y)
         {
+            markChanged(x, y);
             return m_cells(x, y);
         }
 
         void fill(StateType state)
         {
+            markAllChanged();
             for (auto& cell : m_cells)
             {
                 cell = state;
@@ -81,6 +141,7 @@ namespace ls
             const SizeType w = m_cells.width();
             const SizeType h = m_cells.height();
 
+            markAllChanged();
             for (SizeType x = 0; x < w; ++x)
             {
                 for (SizeType y = 0; y < h; ++y)
@@ -92,22 +153,140 @@ namespace ls
 
         void iterate(SizeType numIters = 1)
         {
-            const SizeType w = m_cells.width();
-            const SizeType h = m_cells.height();
+            while (numIters--)
+            {
+                updateSummedAreaTables();
+                updateActiveTiles();
+                for (SizeType tile : m_activeTiles)
+                {
+                    computeTile(tile);
+                }
+
+                m_cells.swap(m_nextCells);
+                m_summedAreaTablesValid = false;
+            }
+        }
 
-            Array2<StateType> nextGrid(w, h);
+        //active tiles are distributed between the threads
+        //every cell is computed from the previous generation only, so the result
+        //is the same as from the single threaded iterate as long as the rule is a pure function
+        void iterate(SizeType numIters, ThreadPool& pool)
+        {
             while (numIters--)
             {
-                for (SizeType x = 0; x < w; ++x)
+                updateSummedAreaTables();
+                updateActiveTiles();
+                pool.parallelFor(0, static_cast<SizeType>(m_activeTiles.size()), [&](SizeType i) {
+                    computeTile(m_activeTiles[i]);
+                });
+
+                m_cells.swap(m_nextCells);
+                m_summedAreaTablesValid = false;
+            }
+        }
+
+        //precomputes the rule's output for every possible 3x3 neighbourhood, afterwards
+        //cells are computed by a single table lookup, with the table index updated
+        //incrementally when going down a column
+        //states have to be enumerators with values in [0, numStates), numStates <= 4
+        //and the rule can't look further than the 3x3 region
+        //cells on the border of a finite automaton still use the rule directly
+        void compileRule(int numStates)
+        {
+            if (numStates < 1 || numStates > 4)
+            {
+                throw std::runtime_error("Only rules with at most 4 states can be compiled.");
+            }
+            if (detail::RuleRadius<RuleType>::get(*this) > 1)
+            {
+                throw std::runtime_error("Only rules with 3x3 neighbourhood can be compiled.");
+            }
+
+            //each state takes a fixed number of bits so that sliding the window is a shift
+            const int bits = numStates <= 2 ? 1 : 2;
+            const std::size_t tableSize = std::size_t(1) << (bits * 9);
+            const std::size_t digitMask = (std::size_t(1) << bits) - 1;
+
+            CellularAutomaton2<RuleType, CellularAutomatonTopology::Finite> neighbourhood(3, 3, static_cast<const RuleType&>(*this));
+            m_compiledRule.assign(tableSize, StateType{});
+            for (std::size_t index = 0; index < tableSize; ++index)
+            {
+                bool isValid = true;
+                for (int i = 0; i < 9; ++i)
                 {
-                    for (SizeType y = 0; y < h; ++y)
+                    //first digit is the top left cell, rows are x - 1, x, x + 1 from the most significant digit
+                    const std::size_t digit = (index >> ((8 - i) * bits)) & digitMask;
+                    if (digit >= static_cast<std::size_t>(numStates))
                     {
-                        nextGrid(x, y) = RuleType::operator()(*this, x, y);
+                        isValid = false;
+                        break;
                     }
+
+                    neighbourhood(i % 3, i / 3) = static_cast<StateType>(digit);
                 }
 
-                m_cells.swap(nextGrid);
+                if (isValid) m_compiledRule[index] = RuleType::operator()(neighbourhood, 1, 1);
+            }
+
+            m_compiledRuleBits = bits;
+        }
+
+        bool isRuleCompiled() const
+        {
+            return !m_compiledRule.empty();
+        }
+
+        //changing the tile size makes the next generation evaluate the whole grid
+        void setTileSize(SizeType newTileSize)
+        {
+            if (newTileSize <= 0)
+            {
+                throw std::runtime_error("Tile size must be positive.");
+            }
+
+            m_tileSize = newTileSize;
+            m_numTilesX = (m_cells.width() + m_tileSize - 1) / m_tileSize;
+            m_numTilesY = (m_cells.height() + m_tileSize - 1) / m_tileSize;
+            m_tileChanged.assign(static_cast<std::size_t>(m_numTilesX * m_numTilesY), 0);
+            m_tileActive.assign(m_tileChanged.size(), 0);
+            m_activeTiles.clear();
+            m_numActiveCells = 0;
+            markAllChanged();
+        }
+
+        SizeType tileSize() const
+        {
+            return m_tileSize;
+        }
+
+        //when disabled every generation evaluates the whole grid
+        void setChangeTracking(bool enabled)
+        {
+            if (enabled && !detail::HasRuleRadius<RuleType>::value)
+            {
+                throw std::runtime_error("Change tracking requires the rule to declare radius().");
             }
+
+            //tiles were not tracked while disabled
+            if (enabled && !m_isChangeTrackingEnabled) markAllChanged();
+            m_isChangeTrackingEnabled = enabled;
+        }
+
+        bool isChangeTrackingEnabled() const
+        {
+            return m_isChangeTrackingEnabled;
+        }
+
+        //number of tiles evaluated by the last generation
+        SizeType activeTileCount() const
+        {
+            return static_cast<SizeType>(m_activeTiles.size());
+        }
+
+        //number of cells evaluated by the last generation
+        SizeType activeCellCount() const
+        {
+            return m_numActiveCells;
         }
 
         //x,y determine center of the 3x3 region
@@ -135,6 +314,14 @@ namespace ls
             const SizeType width = m_cells.width();
             const SizeType height = m_cells.height();
 
+            if (m_summedAreaTablesValid)
+            {
+                for (std::size_t i = 0; i < m_countedStates.size(); ++i)
+                {
+                    if (m_countedStates[i] == state) return occurencesInRect(m_summedAreaTables[i], rect);
+                }
+            }
+
             SizeType quantity = 0;
 
             if constexpr (TopologyV == CellularAutomatonTopology::Finite)
@@ -207,7 +394,267 @@ namespace ls
         }
 
     protected:
+        static constexpr SizeType defaultTileSize = 32;
+
         Array2<StateType> m_cells;
+        Array2<StateType> m_nextCells; //back buffer, reused between iterations
+
+        //m_summedAreaTables[i](x, y) is the number of m_countedStates[i] in [0, x) x [0, y)
+        std::vector<StateType> m_countedStates;
+        std::vector<Array2<std::uint32_t>> m_summedAreaTables;
+        bool m_summedAreaTablesValid;
+
+        //tiles are column major, m_tileChanged is set for tiles that changed in the last generation
+        //unsigned char and not bool because flags are written from many threads
+        SizeType m_tileSize;
+        SizeType m_numTilesX;
+        SizeType m_numTilesY;
+        std::vector<unsigned char> m_tileChanged;
+        std::vector<unsigned char> m_tileActive;
+        std::vector<SizeType> m_activeTiles;
+        SizeType m_numActiveCells;
+        bool m_isChangeTrackingEnabled;
+
+        //indexed by packed states of a 3x3 region, m_compiledRuleBits per state
+        std::vector<StateType> m_compiledRule;
+        int m_compiledRuleBits;
+
+        //computes the next generation of cells in [beginX, endX) x [beginY, endY) into m_nextCells
+        //returns whether any of them is different from the current generation
+        bool computeRegion(SizeType beginX, SizeType beginY, SizeType endX, SizeType endY)
+        {
+            bool changed = false;
+            for (SizeType x = beginX; x < endX; ++x)
+            {
+                if (!m_compiledRule.empty())
+                {
+                    changed |= computeCompiledColumn(x, beginY, endY);
+                    continue;
+                }
+
+                for (SizeType y = beginY; y < endY; ++y)
+                {
+                    changed |= computeCell(x, y);
+                }
+            }
+            return changed;
+        }
+
+        bool computeCell(SizeType x, SizeType y)
+        {
+            const StateType next = RuleType::operator()(*this, x, y);
+            m_nextCells(x, y) = next;
+            return !(next == m_cells(x, y));
+        }
+
+        bool computeCompiledColumn(SizeType x, SizeType beginY, SizeType endY)
+        {
+            const SizeType w = m_cells.width();
+            const SizeType h = m_cells.height();
+
+            bool changed = false;
+            if constexpr (TopologyV == CellularAutomatonTopology::Finite)
+            {
+                if (x == 0 || x == w - 1)
+                {
+                    for (SizeType y = beginY; y < endY; ++y)
+                    {
+                        changed |= computeCell(x, y);
+                    }
+                    return changed;
+                }
+
+                if (beginY == 0)
+                {
+                    changed |= computeCell(x, 0);
+                    ++beginY;
+                }
+                if (endY == h && beginY < endY)
+                {
+                    --endY;
+                    changed |= computeCell(x, endY);
+                }
+            }
+
+            if (beginY >= endY) return changed;
+
+            //columns are contiguous
+            const StateType* left = &m_cells(x > 0 ? x - 1 : w - 1, 0);
+            const StateType* center = &m_cells(x, 0);
+            const StateType* right = &m_cells(x + 1 < w ? x + 1 : 0, 0);
+            StateType* next = &m_nextCells(x, 0);
+
+            const int bits = m_compiledRuleBits;
+            const std::size_t mask = (std::size_t(1) << (bits * 9)) - 1;
+            auto row = [&](SizeType y) {
+                return (static_cast<std::size_t>(left[y]) << (bits * 2))
+                    | (static_cast<std::size_t>(center[y]) << bits)
+                    | static_cast<std::size_t>(right[y]);
+            };
+
+            std::size_t index = (row(beginY > 0 ? beginY - 1 : h - 1) << (bits * 3)) | row(beginY);
+            for (SizeType y = beginY; y < endY; ++y)
+            {
+                index = ((index << (bits * 3)) | row(y + 1 < h ? y + 1 : 0)) & mask;
+                next[y] = m_compiledRule[index];
+                changed |= !(next[y] == center[y]);
+            }
+
+            return changed;
+        }
+
+        void computeTile(SizeType tile)
+        {
+            const SizeType beginX = (tile / m_numTilesY) * m_tileSize;
+            const SizeType beginY = (tile % m_numTilesY) * m_tileSize;
+            const SizeType endX = std::min(beginX + m_tileSize, m_cells.width());
+            const SizeType endY = std::min(beginY + m_tileSize, m_cells.height());
+
+            m_tileChanged[tile] = computeRegion(beginX, beginY, endX, endY);
+        }
+
+        //inactive tiles of the back buffer already hold the current generation,
+        //because they didn't change when it was computed
+        void updateActiveTiles()
+        {
+            const SizeType radius = detail::RuleRadius<RuleType>::get(*this);
+            const SizeType ringX = std::min(tileRing(radius, m_cells.width()), m_numTilesX);
+            const SizeType ringY = std::min(tileRing(radius, m_cells.height()), m_numTilesY);
+
+            std::fill(m_tileActive.begin(), m_tileActive.end(), m_isChangeTrackingEnabled ? 0 : 1);
+            for (SizeType tx = 0; tx < m_numTilesX && m_isChangeTrackingEnabled; ++tx)
+            {
+                for (SizeType ty = 0; ty < m_numTilesY; ++ty)
+                {
+                    if (!m_tileChanged[tx * m_numTilesY + ty]) continue;
+
+                    for (SizeType nx = tx - ringX; nx <= tx + ringX; ++nx)
+                    {
+                        for (SizeType ny = ty - ringY; ny <= ty + ringY; ++ny)
+                        {
+                            SizeType ax = nx;
+                            SizeType ay = ny;
+                            if constexpr (TopologyV == CellularAutomatonTopology::Toroidal)
+                            {
+                                ax = (ax + m_numTilesX) % m_numTilesX;
+                                ay = (ay + m_numTilesY) % m_numTilesY;
+                            }
+                            else if (ax < 0 || ay < 0 || ax >= m_numTilesX || ay >= m_numTilesY)
+                            {
+                                continue;
+                            }
+
+                            m_tileActive[ax * m_numTilesY + ay] = 1;
+                        }
+                    }
+                }
+            }
+
+            m_activeTiles.clear();
+            m_numActiveCells = 0;
+            for (SizeType tile = 0; tile < m_numTilesX * m_numTilesY; ++tile)
+            {
+                m_tileChanged[tile] = 0;
+                if (!m_tileActive[tile]) continue;
+
+                const SizeType tileWidth = std::min(m_tileSize, m_cells.width() - (tile / m_numTilesY) * m_tileSize);
+                const SizeType tileHeight = std::min(m_tileSize, m_cells.height() - (tile % m_numTilesY) * m_tileSize);
+                m_activeTiles.push_back(tile);
+                m_numActiveCells += tileWidth * tileHeight;
+            }
+        }
+
+        //how many tiles away a change can have an effect
+        //wrapping around through a smaller last tile can reach one tile further
+        SizeType tileRing(SizeType radius, SizeType size) const
+        {
+            const SizeType ring = (radius + m_tileSize - 1) / m_tileSize;
+            if (TopologyV == CellularAutomatonTopology::Toroidal && size % m_tileSize != 0) return ring + 1;
+            return ring;
+        }
+
+        void markChanged(SizeType x, SizeType y)
+        {
+            m_summedAreaTablesValid = false;
+            m_tileChanged[(x / m_tileSize) * m_numTilesY + y / m_tileSize] = 1;
+        }
+
+        void markAllChanged()
+        {
+            m_summedAreaTablesValid = false;
+            std::fill(m_tileChanged.begin(), m_tileChanged.end(), 1);
+        }
+
+        void updateSummedAreaTables()
+        {
+            if constexpr (detail::HasCountedStates<RuleType>::value)
+            {
+                if (m_summedAreaTablesValid) return;
+
+                const SizeType w = m_cells.width();
+                const SizeType h = m_cells.height();
+
+                const auto& countedStates = RuleType::countedStates();
+                m_countedStates.assign(std::begin(countedStates), std::end(countedStates));
+                m_summedAreaTables.resize(m_countedStates.size(), Array2<std::uint32_t>(w + 1, h + 1, 0));
+
+                for (std::size_t i = 0; i < m_countedStates.size(); ++i)
+                {
+                    const StateType state = m_countedStates[i];
+                    Array2<std::uint32_t>& table = m_summedAreaTables[i];
+
+                    for (SizeType x = 0; x < w; ++x)
+                    {
+                        std::uint32_t columnSum = 0;
+                        for (SizeType y = 0; y < h; ++y)
+                        {
+                            columnSum += (m_cells(x, y) == state);
+                            table(x + 1, y + 1) = table(x, y + 1) + columnSum;
+                        }
+                    }
+                }
+
+                m_summedAreaTablesValid = true;
+            }
+        }
+
+    private:
+        SizeType occurencesInRect(const Array2<std::uint32_t>& table, const Box2<SizeType>& rect) const
+        {
+            if constexpr (TopologyV == CellularAutomatonTopology::Finite)
+            {
+                const SizeType xmin = std::max(rect.min.x, static_cast<SizeType>(0));
+                const SizeType ymin = std::max(rect.min.y, static_cast<SizeType>(0));
+                const SizeType xmax = std::min(rect.max.x, m_cells.width() - 1);
+                const SizeType ymax = std::min(rect.max.y, m_cells.height() - 1);
+                if (xmin > xmax || ymin > ymax) return 0;
+
+                return static_cast<SizeType>(table(xmax + 1, ymax + 1)) - table(xmin, ymax + 1) - table(xmax + 1, ymin) + table(xmin, ymin);
+            }
+            else
+            {
+                if (rect.min.x > rect.max.x || rect.min.y > rect.max.y) return 0;
+
+                return
+                    periodicPrefixSum(table, rect.max.x + 1, rect.max.y + 1)
+                    - periodicPrefixSum(table, rect.min.x, rect.max.y + 1)
+                    - periodicPrefixSum(table, rect.max.x + 1, rect.min.y)
+                    + periodicPrefixSum(table, rect.min.x, rect.min.y);
+            }
+        }
+
+        //number of counted cells in [0, x) x [0, y) of the grid repeated infinitely, x and y can be negative
+        SizeType periodicPrefixSum(const Array2<std::uint32_t>& table, SizeType x, SizeType y) const
+        {
+            const SizeType w = m_cells.width();
+            const SizeType h = m_cells.height();
+            const SizeType qx = (x >= 0 ? x : x - w + 1) / w;
+            const SizeType qy = (y >= 0 ? y : y - h + 1) / h;
+            const SizeType rx = x - qx * w;
+            const SizeType ry = y - qy * h;
+
+            return qx * qy * table(w, h) + qx * table(w, ry) + qy * table(rx, h) + table(rx, ry);
+        }
     };
 
     template <typename RuleT>
@@ -238,11 +685,26 @@ namespace ls
             return m_outputs[automaton.occurencesIn3x3(m_countedState, x, y)];
         }
 
+        static constexpr SizeType radius()
+        {
+            return 1;
+        }
+
         void setOutputForQuantity(StateType outputState, SizeType quantity)
         {
             m_outputs[quantity] = outputState;
         }
 
+        const StateType& countedState() const
+        {
+            return m_countedState;
+        }
+
+        const StateType& outputForQuantity(SizeType quantity) const
+        {
+            return m_outputs[quantity];
+        }
+
     protected:
         StateType m_countedState;
         std::array<StateType, 10u> m_outputs; //the quantity of state in 3x3 region is the index
@@ -250,6 +712,56 @@ namespace ls
 
 
 
+    //like QuantityRule3x3 but counts in a (2*radius+1)^2 region, which takes constant time per cell
+    template <typename StateT> //enum representing all possible states
+    struct RadiusQuantityRule
+    {
+    public:
+        using StateType = StateT;
+        using SizeType = detail::SizeType;
+
+        //outputs[i] is the next state when there are i counted states in the region
+        RadiusQuantityRule(StateType countedState, SizeType radius, std::vector<StateType> outputs) :
+            m_countedState(countedState),
+            m_radius(radius),
+            m_outputs(std::move(outputs))
+        {
+            const SizeType diameter = radius * 2 + 1;
+            if (static_cast<SizeType>(m_outputs.size()) != diameter * diameter + 1)
+            {
+                throw std::runtime_error("There has to be an output for every possible quantity.");
+            }
+        }
+
+        template <CellularAutomatonTopology TopologyV>
+        StateType operator()(const CellularAutomaton2<RadiusQuantityRule, TopologyV>& automaton, SizeType x, SizeType y) const
+        {
+            return m_outputs[automaton.occurencesInRadius(m_countedState, x, y, m_radius)];
+        }
+
+        std::array<StateType, 1u> countedStates() const
+        {
+            return { m_countedState };
+        }
+
+        void setOutputForQuantity(StateType outputState, SizeType quantity)
+        {
+            m_outputs[quantity] = outputState;
+        }
+
+        SizeType radius() const
+        {
+            return m_radius;
+        }
+
+    protected:
+        StateType m_countedState;
+        SizeType m_radius;
+        std::vector<StateType> m_outputs; //the quantity of state in the region is the index
+    };
+
+
+
     struct ConwaysGameOfLifeRule
     {
     public:
@@ -263,6 +775,21 @@ namespace ls
 
         ConwaysGameOfLifeRule() = default;
 
+        //bit n is set when a cell with n living neighbours is born/survives, B3/S23
+        static constexpr std::uint16_t birthMask()
+        {
+            return 1u << 3;
+        }
+        static constexpr std::uint16_t survivalMask()
+        {
+            return (1u << 2) | (1u << 3);
+        }
+
+        static constexpr SizeType radius()
+        {
+            return 1;
+        }
+
         template <CellularAutomatonTopology TopologyV>
         StateType operator()(const CellularAutomaton2<ConwaysGameOfLifeRule, TopologyV>& automaton, SizeType x, SizeType y) const
         {
@@ -283,6 +810,54 @@ namespace ls
         }
     };
 
+    //any outer totalistic two state rule in B/S notation, ie. B36/S23 is LifeLikeRule(0b1001000, 0b1100)
+    struct LifeLikeRule
+    {
+    public:
+        using SizeType = detail::SizeType;
+
+        enum struct StateType
+        {
+            Dead,
+            Live
+        };
+
+        //bit n is set when a cell with n living neighbours is born/survives
+        LifeLikeRule(std::uint16_t birthMask, std::uint16_t survivalMask) :
+            m_birthMask(birthMask),
+            m_survivalMask(survivalMask)
+        {
+
+        }
+
+        template <CellularAutomatonTopology TopologyV>
+        StateType operator()(const CellularAutomaton2<LifeLikeRule, TopologyV>& automaton, SizeType x, SizeType y) const
+        {
+            const SizeType numberOfLivingNeighbours = automaton.occurencesInNeighbourhood(StateType::Live, x, y);
+            const std::uint16_t mask = automaton(x, y) == StateType::Live ? m_survivalMask : m_birthMask;
+
+            return (mask >> numberOfLivingNeighbours) & 1u ? StateType::Live : StateType::Dead;
+        }
+
+        std::uint16_t birthMask() const
+        {
+            return m_birthMask;
+        }
+        std::uint16_t survivalMask() const
+        {
+            return m_survivalMask;
+        }
+
+        static constexpr SizeType radius()
+        {
+            return 1;
+        }
+
+    protected:
+        std::uint16_t m_birthMask;
+        std::uint16_t m_survivalMask;
+    };
+
     struct WireworldRule
     {
     public:
@@ -315,5 +890,10 @@ namespace ls
 
             return currentState;
         }
+
+        static constexpr SizeType radius()
+        {
+            return 1;
+        }
     };
 }
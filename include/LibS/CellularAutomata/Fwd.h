@@ -7,10 +7,24 @@ namespace ls
     template <typename RuleT, CellularAutomatonTopology TopologyV> //class representing a rule
     struct CellularAutomaton2;
 
+    template <typename RuleT, CellularAutomatonTopology TopologyV> //RuleT has to be a two state rule
+    struct BitPackedCellularAutomaton2;
+
+    template <typename RuleT>
+    struct HashLifeRuleTraits;
+
+    template <typename RuleT>
+    struct HashLife;
+
     template <typename StateT> //enum representing all possible states
     struct QuantityRule3x3;
 
+    template <typename StateT> //enum representing all possible states
+    struct RadiusQuantityRule;
+
     struct ConwaysGameOfLifeRule;
 
+    struct LifeLikeRule;
+
     struct WireworldRule;
 }
@@ -0,0 +1,646 @@
+#pragma once
+
+#include "CellularAutomaton2.h"
+
+#include "LibS/Containers/Array2.h"
+
+#include "LibS/Detail.h"
+
+#include "Fwd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+namespace ls
+{
+    //tells HashLife how to evaluate a rule without an automaton
+    //specializations must provide
+    //  static StateType background(const RuleT&) - state that stays the same when surrounded by itself
+    //  static StateType next(const RuleT&, const StateType (&cells)[3][3]) - cells[x][y], the center is cells[1][1]
+    template <typename RuleT>
+    struct HashLifeRuleTraits;
+
+    namespace detail
+    {
+        template <typename RuleT>
+        struct LifeLikeHashLifeRuleTraits
+        {
+            using StateType = typename RuleT::StateType;
+
+            static StateType background(const RuleT& rule)
+            {
+                if (rule.birthMask() & 1u)
+                {
+                    throw std::runtime_error("Rules where cells are born without neighbours have no stable background.");
+                }
+
+                return StateType::Dead;
+            }
+
+            static StateType next(const RuleT& rule, const StateType(&cells)[3][3])
+            {
+                unsigned numberOfLivingNeighbours = 0;
+                for (int x = 0; x < 3; ++x)
+                {
+                    for (int y = 0; y < 3; ++y)
+                    {
+                        numberOfLivingNeighbours += (cells[x][y] == StateType::Live);
+                    }
+                }
+
+                const bool isLive = cells[1][1] == StateType::Live;
+                numberOfLivingNeighbours -= isLive;
+
+                const unsigned mask = isLive ? rule.survivalMask() : rule.birthMask();
+                return (mask >> numberOfLivingNeighbours) & 1u ? StateType::Live : StateType::Dead;
+            }
+        };
+    }
+
+    template <>
+    struct HashLifeRuleTraits<ConwaysGameOfLifeRule> : detail::LifeLikeHashLifeRuleTraits<ConwaysGameOfLifeRule>
+    {
+    };
+
+    template <>
+    struct HashLifeRuleTraits<LifeLikeRule> : detail::LifeLikeHashLifeRuleTraits<LifeLikeRule>
+    {
+    };
+
+    template <typename StateT>
+    struct HashLifeRuleTraits<QuantityRule3x3<StateT>>
+    {
+        using StateType = StateT;
+
+        static StateType background(const QuantityRule3x3<StateT>& rule)
+        {
+            const StateType& counted = rule.countedState();
+            if (!(rule.outputForQuantity(0) == counted)) return rule.outputForQuantity(0);
+            if (rule.outputForQuantity(9) == counted) return counted;
+
+            throw std::runtime_error("Rule has no stable background.");
+        }
+
+        static StateType next(const QuantityRule3x3<StateT>& rule, const StateType(&cells)[3][3])
+        {
+            detail::SizeType quantity = 0;
+            for (int x = 0; x < 3; ++x)
+            {
+                for (int y = 0; y < 3; ++y)
+                {
+                    quantity += (cells[x][y] == rule.countedState());
+                }
+            }
+
+            return rule.outputForQuantity(quantity);
+        }
+    };
+
+    //Gosper's HashLife on an unbounded plane filled with the rule's background state
+    //the plane is a quadtree of hash consed nodes, equal regions are the same node
+    //and the future of every node is memoized, so advancing by many generations
+    //takes time proportional to the number of distinct regions, not to the area or generations
+    //works with every rule that has a HashLifeRuleTraits specialization
+    //nodes and memoized futures that are no longer reachable from the current pattern are released
+    //by collectGarbage(), which advance calls between its steps once the number of nodes
+    //exceeds the garbage collection threshold
+    template <typename RuleT>
+    struct HashLife : protected RuleT
+    {
+    public:
+        using RuleType = RuleT;
+        using StateType = typename RuleT::StateType;
+        using SizeType = detail::SizeType;
+        using CoordinateType = std::int64_t;
+        using TraitsType = HashLifeRuleTraits<RuleT>;
+
+        HashLife() :
+            RuleType{},
+            m_garbageCollectionThreshold(defaultGarbageCollectionThreshold)
+        {
+            clear();
+        }
+
+        template <typename RuleFwdT>
+        explicit HashLife(RuleFwdT&& rule) :
+            RuleType(std::forward<RuleFwdT>(rule)),
+            m_garbageCollectionThreshold(defaultGarbageCollectionThreshold)
+        {
+            clear();
+        }
+
+        //removes all cells and forgets all memoized nodes
+        void clear()
+        {
+            m_background = TraitsType::background(*this);
+            m_nodes.clear();
+            m_nodeIndex.clear();
+            m_successors.clear();
+            m_leaves.clear();
+            m_emptyNodes.clear();
+            m_generation = 0;
+            m_numNodesAfterCollection = 0;
+
+            m_rootLevel = minRootLevel;
+            m_root = emptyNode(m_rootLevel);
+            m_originX = -(CoordinateType(1) << (m_rootLevel - 1));
+            m_originY = m_originX;
+        }
+
+        StateType operator()(CoordinateType x, CoordinateType y) const
+        {
+            if (!contains(x, y)) return m_background;
+
+            NodeIndex node = m_root;
+            for (int level = m_rootLevel; level > 0; --level)
+            {
+                const CoordinateType half = CoordinateType(1) << (level - 1);
+                const bool right = ((x - m_originX) & half) != 0;
+                const bool bottom = ((y - m_originY) & half) != 0;
+                node = child(m_nodes[node], right, bottom);
+            }
+
+            return m_nodes[node].state;
+        }
+
+        StateType at(CoordinateType x, CoordinateType y) const
+        {
+            return operator()(x, y);
+        }
+
+        void set(CoordinateType x, CoordinateType y, const StateType& state)
+        {
+            while (!contains(x, y)) expand();
+
+            m_root = setCell(m_root, m_rootLevel, x - m_originX, y - m_originY, state);
+        }
+
+        //copies all cells, cells(i, j) goes to (x + i, y + j)
+        template <SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void insert(const Array2<StateType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& cells, CoordinateType x, CoordinateType y)
+        {
+            const CoordinateType width = cells.width();
+            const CoordinateType height = cells.height();
+            if (width == 0 || height == 0) return;
+
+            while (!contains(x, y) || !contains(x + width - 1, y + height - 1)) expand();
+
+            m_root = insertRegion(m_root, m_rootLevel, m_originX, m_originY, cells, x, y);
+        }
+
+        //out(i, j) becomes the cell at (x + i, y + j)
+        template <SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void extract(Array2<StateType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out, CoordinateType x, CoordinateType y) const
+        {
+            for (auto& cell : out)
+            {
+                cell = m_background;
+            }
+
+            extractRegion(m_root, m_rootLevel, m_originX, m_originY, out, x, y);
+        }
+
+        Array2<StateType> extract(CoordinateType x, CoordinateType y, SizeType width, SizeType height) const
+        {
+            Array2<StateType> out(width, height);
+            extract(out, x, y);
+            return out;
+        }
+
+        //generations are split into powers of two, each advanced in a single memoized step
+        void advance(std::uint64_t generations)
+        {
+            for (int step = 0; generations != 0; ++step, generations >>= 1)
+            {
+                if (generations & 1u)
+                {
+                    //a step holds node indices on the stack, so garbage can only be collected between them
+                    if (numNodes() >= std::max(m_garbageCollectionThreshold, m_numNodesAfterCollection * 2)) collectGarbage();
+                    advanceByPowerOfTwo(step);
+                }
+            }
+        }
+
+        //releases the nodes that are not part of the current pattern, together with memoized futures
+        //of released nodes and memoized futures that are released nodes
+        //the cells and the generation are not affected, only later steps may have to recompute some futures
+        void collectGarbage()
+        {
+            std::vector<unsigned char> isReachable(m_nodes.size(), 0);
+            std::vector<NodeIndex> stack(m_leaves.begin(), m_leaves.end());
+            stack.insert(stack.end(), m_emptyNodes.begin(), m_emptyNodes.end());
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                const NodeIndex node = stack.back();
+                stack.pop_back();
+                if (isReachable[node]) continue;
+
+                isReachable[node] = 1;
+                const Node& n = m_nodes[node];
+                if (n.level == 0) continue;
+
+                stack.push_back(n.nw);
+                stack.push_back(n.ne);
+                stack.push_back(n.sw);
+                stack.push_back(n.se);
+            }
+
+            //children are always created before their parents, so they are remapped first
+            constexpr NodeIndex released = std::numeric_limits<NodeIndex>::max();
+            std::vector<NodeIndex> remap(m_nodes.size(), released);
+            NodeIndex numKept = 0;
+            m_nodeIndex.clear();
+            for (std::size_t node = 0; node < m_nodes.size(); ++node)
+            {
+                if (!isReachable[node]) continue;
+
+                Node n = m_nodes[node];
+                if (n.level > 0)
+                {
+                    n.nw = remap[n.nw];
+                    n.ne = remap[n.ne];
+                    n.sw = remap[n.sw];
+                    n.se = remap[n.se];
+                    m_nodeIndex.emplace(NodeKey{ n.nw, n.ne, n.sw, n.se }, numKept);
+                }
+
+                m_nodes[numKept] = n;
+                remap[node] = numKept++;
+            }
+            m_nodes.resize(numKept);
+
+            std::unordered_map<std::uint64_t, NodeIndex> successors;
+            for (const auto& [key, result] : m_successors)
+            {
+                const NodeIndex node = remap[key >> 8];
+                if (node == released || remap[result] == released) continue;
+
+                successors.emplace((std::uint64_t(node) << 8) | (key & 0xFFu), remap[result]);
+            }
+            m_successors = std::move(successors);
+
+            for (NodeIndex& node : m_leaves) node = remap[node];
+            for (NodeIndex& node : m_emptyNodes) node = remap[node];
+            m_root = remap[m_root];
+
+            m_numNodesAfterCollection = numNodes();
+        }
+
+        //advance collects garbage when there are at least that many nodes,
+        //or twice as many as were left after the last collection if that's more
+        void setGarbageCollectionThreshold(SizeType newGarbageCollectionThreshold)
+        {
+            m_garbageCollectionThreshold = newGarbageCollectionThreshold;
+        }
+
+        SizeType garbageCollectionThreshold() const
+        {
+            return m_garbageCollectionThreshold;
+        }
+
+        std::uint64_t generation() const
+        {
+            return m_generation;
+        }
+
+        //number of cells that are not in the background state
+        std::uint64_t population() const
+        {
+            return m_nodes[m_root].population;
+        }
+
+        const StateType& background() const
+        {
+            return m_background;
+        }
+
+        SizeType numNodes() const
+        {
+            return static_cast<SizeType>(m_nodes.size());
+        }
+
+    private:
+        using NodeIndex = std::uint32_t;
+
+        //the root is never smaller than that
+        static constexpr int minRootLevel = 3;
+        static constexpr int maxRootLevel = 62;
+
+        static constexpr SizeType defaultGarbageCollectionThreshold = 1 << 22;
+
+        //a square of 2^level cells, leaves have level 0
+        struct Node
+        {
+            NodeIndex nw;
+            NodeIndex ne;
+            NodeIndex sw;
+            NodeIndex se;
+            int level;
+            StateType state;
+            std::uint64_t population;
+        };
+
+        struct NodeKey
+        {
+            NodeIndex nw;
+            NodeIndex ne;
+            NodeIndex sw;
+            NodeIndex se;
+
+            friend bool operator==(const NodeKey& lhs, const NodeKey& rhs)
+            {
+                return lhs.nw == rhs.nw && lhs.ne == rhs.ne && lhs.sw == rhs.sw && lhs.se == rhs.se;
+            }
+        };
+
+        struct NodeKeyHash
+        {
+            std::size_t operator()(const NodeKey& key) const
+            {
+                std::uint64_t h = key.nw;
+                h = h * 0x9E3779B97F4A7C15ull + key.ne;
+                h = h * 0x9E3779B97F4A7C15ull + key.sw;
+                h = h * 0x9E3779B97F4A7C15ull + key.se;
+                return static_cast<std::size_t>(h ^ (h >> 29));
+            }
+        };
+
+        StateType m_background;
+        std::vector<Node> m_nodes;
+        std::unordered_map<NodeKey, NodeIndex, NodeKeyHash> m_nodeIndex;
+        std::unordered_map<std::uint64_t, NodeIndex> m_successors; //key is node index and log2 of the number of generations
+        std::vector<NodeIndex> m_leaves; //one for each state that was used
+        std::vector<NodeIndex> m_emptyNodes; //m_emptyNodes[level] is a node filled with background
+        std::uint64_t m_generation;
+        SizeType m_garbageCollectionThreshold;
+        SizeType m_numNodesAfterCollection;
+
+        NodeIndex m_root;
+        int m_rootLevel;
+        CoordinateType m_originX; //position of the top left cell of the root
+        CoordinateType m_originY;
+
+        bool contains(CoordinateType x, CoordinateType y) const
+        {
+            const CoordinateType size = CoordinateType(1) << m_rootLevel;
+            return x >= m_originX && y >= m_originY && x - m_originX < size && y - m_originY < size;
+        }
+
+        static NodeIndex child(const Node& node, bool right, bool bottom)
+        {
+            if (bottom) return right ? node.se : node.sw;
+            return right ? node.ne : node.nw;
+        }
+
+        NodeIndex leaf(const StateType& state)
+        {
+            for (NodeIndex node : m_leaves)
+            {
+                if (m_nodes[node].state == state) return node;
+            }
+
+            const std::uint64_t population = state == m_background ? 0 : 1;
+            m_nodes.push_back(Node{ 0, 0, 0, 0, 0, state, population });
+            m_leaves.push_back(static_cast<NodeIndex>(m_nodes.size() - 1));
+            return m_leaves.back();
+        }
+
+        NodeIndex join(NodeIndex nw, NodeIndex ne, NodeIndex sw, NodeIndex se)
+        {
+            const NodeKey key{ nw, ne, sw, se };
+            auto iter = m_nodeIndex.find(key);
+            if (iter != m_nodeIndex.end()) return iter->second;
+
+            const std::uint64_t population = m_nodes[nw].population + m_nodes[ne].population + m_nodes[sw].population + m_nodes[se].population;
+            m_nodes.push_back(Node{ nw, ne, sw, se, m_nodes[nw].level + 1, m_background, population });
+            const NodeIndex node = static_cast<NodeIndex>(m_nodes.size() - 1);
+            m_nodeIndex.emplace(key, node);
+            return node;
+        }
+
+        NodeIndex emptyNode(int level)
+        {
+            if (m_emptyNodes.empty()) m_emptyNodes.push_back(leaf(m_background));
+
+            while (static_cast<int>(m_emptyNodes.size()) <= level)
+            {
+                const NodeIndex e = m_emptyNodes.back();
+                m_emptyNodes.push_back(join(e, e, e, e));
+            }
+
+            return m_emptyNodes[level];
+        }
+
+        //root becomes the center of a root twice as large
+        void expand()
+        {
+            if (m_rootLevel >= maxRootLevel)
+            {
+                throw std::runtime_error("Pattern is too large.");
+            }
+
+            const Node root = m_nodes[m_root];
+            const NodeIndex e = emptyNode(m_rootLevel - 1);
+            const NodeIndex nw = join(e, e, e, root.nw);
+            const NodeIndex ne = join(e, e, root.ne, e);
+            const NodeIndex sw = join(e, root.sw, e, e);
+            const NodeIndex se = join(root.se, e, e, e);
+
+            m_originX -= CoordinateType(1) << (m_rootLevel - 1);
+            m_originY -= CoordinateType(1) << (m_rootLevel - 1);
+            m_root = join(nw, ne, sw, se);
+            ++m_rootLevel;
+        }
+
+        //whether everything outside of the center half of the root is background
+        bool isPadded() const
+        {
+            const Node& root = m_nodes[m_root];
+            const Node& nw = m_nodes[root.nw];
+            const Node& ne = m_nodes[root.ne];
+            const Node& sw = m_nodes[root.sw];
+            const Node& se = m_nodes[root.se];
+
+            return root.population == m_nodes[nw.se].population + m_nodes[ne.sw].population + m_nodes[sw.ne].population + m_nodes[se.nw].population;
+        }
+
+        NodeIndex setCell(NodeIndex node, int level, CoordinateType x, CoordinateType y, const StateType& state)
+        {
+            if (level == 0) return leaf(state);
+
+            const CoordinateType half = CoordinateType(1) << (level - 1);
+            Node n = m_nodes[node];
+            if (x < half)
+            {
+                if (y < half) n.nw = setCell(n.nw, level - 1, x, y, state);
+                else n.sw = setCell(n.sw, level - 1, x, y - half, state);
+            }
+            else
+            {
+                if (y < half) n.ne = setCell(n.ne, level - 1, x - half, y, state);
+                else n.se = setCell(n.se, level - 1, x - half, y - half, state);
+            }
+
+            return join(n.nw, n.ne, n.sw, n.se);
+        }
+
+        template <SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        NodeIndex insertRegion(NodeIndex node, int level, CoordinateType nodeX, CoordinateType nodeY, const Array2<StateType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& cells, CoordinateType x, CoordinateType y)
+        {
+            const CoordinateType size = CoordinateType(1) << level;
+            if (nodeX >= x + cells.width() || nodeY >= y + cells.height() || nodeX + size <= x || nodeY + size <= y) return node;
+
+            if (level == 0) return leaf(cells(nodeX - x, nodeY - y));
+
+            const CoordinateType half = size / 2;
+            const Node n = m_nodes[node];
+            const NodeIndex nw = insertRegion(n.nw, level - 1, nodeX, nodeY, cells, x, y);
+            const NodeIndex ne = insertRegion(n.ne, level - 1, nodeX + half, nodeY, cells, x, y);
+            const NodeIndex sw = insertRegion(n.sw, level - 1, nodeX, nodeY + half, cells, x, y);
+            const NodeIndex se = insertRegion(n.se, level - 1, nodeX + half, nodeY + half, cells, x, y);
+            return join(nw, ne, sw, se);
+        }
+
+        template <SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void extractRegion(NodeIndex node, int level, CoordinateType nodeX, CoordinateType nodeY, Array2<StateType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out, CoordinateType x, CoordinateType y) const
+        {
+            const Node& n = m_nodes[node];
+            if (n.population == 0) return;
+
+            const CoordinateType size = CoordinateType(1) << level;
+            if (nodeX >= x + out.width() || nodeY >= y + out.height() || nodeX + size <= x || nodeY + size <= y) return;
+
+            if (level == 0)
+            {
+                out(nodeX - x, nodeY - y) = n.state;
+                return;
+            }
+
+            const CoordinateType half = size / 2;
+            extractRegion(n.nw, level - 1, nodeX, nodeY, out, x, y);
+            extractRegion(n.ne, level - 1, nodeX + half, nodeY, out, x, y);
+            extractRegion(n.sw, level - 1, nodeX, nodeY + half, out, x, y);
+            extractRegion(n.se, level - 1, nodeX + half, nodeY + half, out, x, y);
+        }
+
+        void advanceByPowerOfTwo(int step)
+        {
+            //the pattern has to fit in the center half and then the root is expanded once more
+            //so that the pattern can't grow out of the center half in 2^step <= 2^(level - 2) generations
+            while (m_rootLevel < step + 2 || !isPadded()) expand();
+            expand();
+
+            const CoordinateType quarter = CoordinateType(1) << (m_rootLevel - 2);
+            m_root = successor(m_root, step);
+            --m_rootLevel;
+            m_originX += quarter;
+            m_originY += quarter;
+            m_generation += std::uint64_t(1) << step;
+        }
+
+        //center half of the node after 2^step generations, step <= level - 2
+        NodeIndex successor(NodeIndex node, int step)
+        {
+            const Node n = m_nodes[node];
+            if (n.population == 0) return emptyNode(n.level - 1);
+
+            const std::uint64_t key = (std::uint64_t(node) << 8) | static_cast<std::uint64_t>(step);
+            auto iter = m_successors.find(key);
+            if (iter != m_successors.end()) return iter->second;
+
+            const NodeIndex result = n.level == 2 ? nextGeneration(n) : successorOfQuadrants(n, step);
+            m_successors.emplace(key, result);
+            return result;
+        }
+
+        NodeIndex successorOfQuadrants(const Node& n, int step)
+        {
+            const Node nw = m_nodes[n.nw];
+            const Node ne = m_nodes[n.ne];
+            const Node sw = m_nodes[n.sw];
+            const Node se = m_nodes[n.se];
+
+            //9 overlapping nodes of half the size, [row][column]
+            const NodeIndex parts[3][3] = {
+                { n.nw, join(nw.ne, ne.nw, nw.se, ne.sw), n.ne },
+                { join(nw.sw, nw.se, sw.nw, sw.ne), join(nw.se, ne.sw, sw.ne, se.nw), join(ne.sw, ne.se, se.nw, se.ne) },
+                { n.sw, join(sw.ne, se.nw, sw.se, se.sw), n.se }
+            };
+
+            //at full speed both halves of the time are spent in successors, otherwise only the second one
+            const bool fullSpeed = step == n.level - 2;
+            NodeIndex reduced[3][3];
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 3; ++column)
+                {
+                    reduced[row][column] = fullSpeed ? successor(parts[row][column], step - 1) : center(parts[row][column]);
+                }
+            }
+
+            const int innerStep = fullSpeed ? step - 1 : step;
+            return join(
+                successor(join(reduced[0][0], reduced[0][1], reduced[1][0], reduced[1][1]), innerStep),
+                successor(join(reduced[0][1], reduced[0][2], reduced[1][1], reduced[1][2]), innerStep),
+                successor(join(reduced[1][0], reduced[1][1], reduced[2][0], reduced[2][1]), innerStep),
+                successor(join(reduced[1][1], reduced[1][2], reduced[2][1], reduced[2][2]), innerStep)
+            );
+        }
+
+        NodeIndex center(NodeIndex node)
+        {
+            const Node& n = m_nodes[node];
+            const NodeIndex nw = m_nodes[n.nw].se;
+            const NodeIndex ne = m_nodes[n.ne].sw;
+            const NodeIndex sw = m_nodes[n.sw].ne;
+            const NodeIndex se = m_nodes[n.se].nw;
+            return join(nw, ne, sw, se);
+        }
+
+        //center 2x2 cells of a 4x4 node after one generation
+        NodeIndex nextGeneration(const Node& n)
+        {
+            StateType cells[4][4];
+            const NodeIndex quadrants[2][2] = { { n.nw, n.sw }, { n.ne, n.se } }; //[x][y]
+            for (int qx = 0; qx < 2; ++qx)
+            {
+                for (int qy = 0; qy < 2; ++qy)
+                {
+                    const Node& q = m_nodes[quadrants[qx][qy]];
+                    cells[qx * 2][qy * 2] = m_nodes[q.nw].state;
+                    cells[qx * 2 + 1][qy * 2] = m_nodes[q.ne].state;
+                    cells[qx * 2][qy * 2 + 1] = m_nodes[q.sw].state;
+                    cells[qx * 2 + 1][qy * 2 + 1] = m_nodes[q.se].state;
+                }
+            }
+
+            NodeIndex next[2][2];
+            for (int x = 0; x < 2; ++x)
+            {
+                for (int y = 0; y < 2; ++y)
+                {
+                    StateType neighbourhood[3][3];
+                    for (int dx = 0; dx < 3; ++dx)
+                    {
+                        for (int dy = 0; dy < 3; ++dy)
+                        {
+                            neighbourhood[dx][dy] = cells[x + dx][y + dy];
+                        }
+                    }
+
+                    next[x][y] = leaf(TraitsType::next(*this, neighbourhood));
+                }
+            }
+
+            return join(next[0][0], next[1][0], next[0][1], next[1][1]);
+        }
+    };
+}
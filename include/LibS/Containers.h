@@ -1,4 +1,9 @@
 #pragma once
 
+#include "Containers/AlignedAllocator.h"
+#include "Containers/ArrayLayout.h"
 #include "Containers/Array2.h"
 #include "Containers/Array3.h"
+#include "Containers/Array2View.h"
+#include "Containers/Array3View.h"
+#include "Containers/ArrayConnectedComponents.h"
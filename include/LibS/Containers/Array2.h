@@ -2,26 +2,29 @@
 
 #include "LibS/Detail.h"
 
+#include "ArrayLayout.h"
+#include "ArrayBuffer.h"
+#include "ArrayFloodFill.h"
+#include "MappedFile.h"
+
 #include "Fwd.h"
 
+#include <algorithm>
 #include <utility>
 #include <memory>
-#include <stack>
+#include <functional>
+#include <memory_resource>
+#include <string>
 #include <tuple>
 #include <iterator>
+#include <type_traits>
 
 namespace ls
 {
     namespace detail
     {
-        struct Index2
-        {
-            using SizeType = ::ls::detail::SizeType;
-
-            SizeType x, y;
-        };
-
-        template <typename T, SizeType WidthV = dynamicExtent, SizeType HeightV = dynamicExtent>
+        // Cells are visited in the order they are stored in, as given by LayoutT.
+        template <typename T, SizeType WidthV = dynamicExtent, SizeType HeightV = dynamicExtent, typename LayoutT = ColumnMajorLayout>
         struct Array2Enumerate
         {
             static_assert(WidthV > 0 && HeightV > 0);
@@ -29,6 +32,9 @@ namespace ls
         public:
             using SizeType = ::ls::detail::SizeType;
 
+            static constexpr SizeType storageWidth = LayoutT::storageExtent(WidthV, 0, 2);
+            static constexpr SizeType storageHeight = LayoutT::storageExtent(HeightV, 1, 2);
+
             Array2Enumerate(T* data) :
                 m_data(data)
             {
@@ -45,10 +51,10 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                iterator(T* data) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0)
+                iterator(T* data, SizeType index) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0 }
                 {
                 }
                 self_type operator++(int)
@@ -61,23 +67,17 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_y;
-                    if (m_y >= HeightV)
-                    {
-                        ++m_x;
-                        m_y = 0;
-                    }
+                    LayoutT::next(m_index, m_pos, WidthV, HeightV, storageWidth, storageHeight);
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                T * m_ptr;
-                SizeType m_x;
-                SizeType m_y;
+                T * m_data;
+                SizeType m_index;
+                Index2 m_pos;
             };
 
             struct const_iterator
@@ -90,10 +90,10 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                const_iterator(const T* data) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0)
+                const_iterator(const T* data, SizeType index) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0 }
                 {
                 }
                 self_type operator++(int)
@@ -106,60 +106,54 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_y;
-                    if (m_y >= HeightV)
-                    {
-                        ++m_x;
-                        m_y = 0;
-                    }
+                    LayoutT::next(m_index, m_pos, WidthV, HeightV, storageWidth, storageHeight);
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                const T* m_ptr;
-                SizeType m_x;
-                SizeType m_y;
+                const T* m_data;
+                SizeType m_index;
+                Index2 m_pos;
             };
 
             iterator begin()
             {
-                return iterator(m_data);
+                return iterator(m_data, 0);
             }
 
             iterator end()
             {
-                return iterator(m_data + WidthV*HeightV);
+                return iterator(m_data, storageWidth * storageHeight);
             }
 
             const_iterator begin() const
             {
-                return const_iterator(m_data);
+                return const_iterator(m_data, 0);
             }
 
             const_iterator end() const
             {
-                return const_iterator(m_data + WidthV * HeightV);
+                return const_iterator(m_data, storageWidth * storageHeight);
             }
 
             const_iterator cbegin() const
             {
-                return const_iterator(m_data);
+                return const_iterator(m_data, 0);
             }
 
             const_iterator cend() const
             {
-                return const_iterator(m_data + WidthV * HeightV);
+                return const_iterator(m_data, storageWidth * storageHeight);
             }
         private:
             T* m_data;
         };
 
-        template <typename T>
-        struct Array2Enumerate<T, dynamicExtent, dynamicExtent>
+        template <typename T, typename LayoutT>
+        struct Array2Enumerate<T, dynamicExtent, dynamicExtent, LayoutT>
         {
         public:
             using SizeType = ::ls::detail::SizeType;
@@ -182,40 +176,36 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                iterator(T* data, SizeType height) :
-                    m_ptr(data), 
-                    m_x(0), 
-                    m_y(0), 
-                    m_height(height) 
-                { 
+                iterator(T* data, SizeType index, SizeType width, SizeType height) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0 },
+                    m_width(width),
+                    m_height(height)
+                {
                 }
-                self_type operator++(int) 
-                { 
-                    self_type i = *this; 
+                self_type operator++(int)
+                {
+                    self_type i = *this;
 
                     operator++();
 
-                    return i; 
+                    return i;
                 }
-                self_type operator++() 
+                self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_y;
-                    if (m_y >= m_height)
-                    {
-                        ++m_x;
-                        m_y = 0;
-                    }
+                    LayoutT::next(m_index, m_pos, m_width, m_height, LayoutT::storageExtent(m_width, 0, 2), LayoutT::storageExtent(m_height, 1, 2));
 
-                    return *this; 
+                    return *this;
                 }
-                value_type operator*() { return {m_x, m_y, *m_ptr}; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return {m_pos.x, m_pos.y, m_data[m_index]}; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                T* m_ptr;
-                SizeType m_x;
-                SizeType m_y;
+                T* m_data;
+                SizeType m_index;
+                Index2 m_pos;
+                SizeType m_width;
                 SizeType m_height;
             };
 
@@ -229,10 +219,11 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                const_iterator(const T* data, SizeType height) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0),
+                const_iterator(const T* data, SizeType index, SizeType width, SizeType height) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0 },
+                    m_width(width),
                     m_height(height)
                 {
                 }
@@ -246,112 +237,132 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_y;
-                    if (m_y >= m_height)
-                    {
-                        ++m_x;
-                        m_y = 0;
-                    }
+                    LayoutT::next(m_index, m_pos, m_width, m_height, LayoutT::storageExtent(m_width, 0, 2), LayoutT::storageExtent(m_height, 1, 2));
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                const T* m_ptr;
-                SizeType m_x;
-                SizeType m_y;
+                const T* m_data;
+                SizeType m_index;
+                Index2 m_pos;
+                SizeType m_width;
                 SizeType m_height;
             };
 
             iterator begin()
             {
-                return iterator(m_data, m_height);
+                return iterator(m_data, 0, m_width, m_height);
             }
 
             iterator end()
             {
-                return iterator(m_data + m_width * m_height, m_height);
+                return iterator(m_data, storageSize(), m_width, m_height);
             }
 
             const_iterator begin() const
             {
-                return const_iterator(m_data, m_height);
+                return const_iterator(m_data, 0, m_width, m_height);
             }
 
             const_iterator end() const
             {
-                return const_iterator(m_data + m_width * m_height, m_height);
+                return const_iterator(m_data, storageSize(), m_width, m_height);
             }
 
             const_iterator cbegin() const
             {
-                return const_iterator(m_data, m_height);
+                return const_iterator(m_data, 0, m_width, m_height);
             }
 
             const_iterator cend() const
             {
-                return const_iterator(m_data + m_width * m_height, m_height);
+                return const_iterator(m_data, storageSize(), m_width, m_height);
             }
 
         private:
             T * m_data;
             SizeType m_width;
             SizeType m_height;
+
+            SizeType storageSize() const
+            {
+                return LayoutT::storageExtent(m_width, 0, 2) * LayoutT::storageExtent(m_height, 1, 2);
+            }
         };
     }
 
-    template <typename, detail::SizeType = detail::dynamicExtent, detail::SizeType = detail::dynamicExtent, ArrayStorageType = ArrayStorageType::Dynamic>
+    // LayoutT decides how cells are placed in memory, see ArrayLayout.h.
+    // Iterators and enumerate() visit cells in the order they are stored in.
+    // AllocatorT is used only by dynamic storage, for example AlignedAllocator for SIMD kernels.
+    // Mapped storage keeps the cells in a file, it only supports dynamic extents.
+    template <
+        typename T,
+        detail::SizeType = detail::dynamicExtent,
+        detail::SizeType = detail::dynamicExtent,
+        ArrayStorageType = ArrayStorageType::Dynamic,
+        typename = ColumnMajorLayout,
+        typename = std::allocator<T>
+    >
     struct Array2;
 
-    template <typename T>
-    struct Array2<T, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Dynamic>
+    template <typename T, typename LayoutT, typename AllocatorT>
+    struct Array2<T, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Dynamic, LayoutT, AllocatorT>
     {
         using ValueType = T;
         using SizeType = detail::SizeType;
+        using LayoutType = LayoutT;
+        using AllocatorType = AllocatorT;
 
-        using iterator = T * ;
-        using const_iterator = const T*;
+        using iterator = detail::Array2Iterator<T, LayoutT>;
+        using const_iterator = detail::Array2Iterator<const T, LayoutT>;
 
         Array2() noexcept :
-        m_data(nullptr),
+        m_data(),
+            m_width(0),
+            m_height(0)
+        {
+
+        }
+
+        explicit Array2(const AllocatorT& alloc) noexcept :
+            m_data(alloc),
             m_width(0),
             m_height(0)
         {
 
         }
 
-        Array2(SizeType width, SizeType height) :
+        Array2(SizeType width, SizeType height, const AllocatorT& alloc = AllocatorT()) :
+            m_data(alloc),
             m_width(width),
             m_height(height)
         {
-            m_data = std::make_unique<T[]>(size());
+            m_data = BufferType(storageSize(), alloc);
         }
 
-        Array2(SizeType width, SizeType height, const T& initValue) :
+        Array2(SizeType width, SizeType height, const T& initValue, const AllocatorT& alloc = AllocatorT()) :
+            m_data(alloc),
             m_width(width),
             m_height(height)
         {
-            const SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = initValue;
-            }
+            m_data = BufferType(storageSize(), initValue, alloc);
         }
 
         Array2(const Array2& other) :
+            m_data(other.m_data),
+            m_width(other.m_width),
+            m_height(other.m_height)
+        {
+        }
+
+        Array2(const Array2& other, const AllocatorT& alloc) :
+            m_data(other.m_data, alloc),
             m_width(other.m_width),
             m_height(other.m_height)
         {
-            const SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
         }
 
         Array2(Array2&& other) noexcept :
@@ -359,17 +370,14 @@ namespace ls
             m_width(std::move(other.m_width)),
             m_height(std::move(other.m_height))
         {
-            other.m_data = nullptr;
         }
 
-        Array2& operator= (Array2&& other) noexcept
+        Array2& operator= (Array2&& other) noexcept(std::is_nothrow_move_assignable<BufferType>::value)
         {
             m_data = std::move(other.m_data);
             m_width = std::move(other.m_width);
             m_height = std::move(other.m_height);
 
-            other.m_data = nullptr;
-
             return *this;
         }
 
@@ -399,51 +407,60 @@ namespace ls
         {
             return m_data.get();
         }
+        T* data()
+        {
+            return m_data.get();
+        }
 
         bool isEmpty() const
         {
-            return m_data == nullptr;
+            return m_data.get() == nullptr;
+        }
+
+        const AllocatorT& allocator() const
+        {
+            return m_data.allocator();
         }
 
         iterator begin()
         {
-            return m_data.get();
+            return iteratorAt<T>(m_data.get(), 0);
         }
 
         iterator end()
         {
-            return m_data.get() + size();
+            return iteratorAt<T>(m_data.get(), storageSize());
         }
         const_iterator begin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator end() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
         const_iterator cbegin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator cend() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
 
-        detail::Array2Enumerate<T> enumerate()
+        detail::Array2Enumerate<T, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate()
         {
             return { m_data.get(), m_width, m_height };
         }
 
-        detail::Array2Enumerate<const T> cenumerate() const
+        detail::Array2Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, LayoutT> cenumerate() const
         {
             return { m_data.get(), m_width, m_height };
         }
 
-        detail::Array2Enumerate<const T> enumerate() const
+        detail::Array2Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate() const
         {
             return { m_data.get(), m_width, m_height };
         }
@@ -463,9 +480,32 @@ namespace ls
             return m_width * m_height;
         }
 
+        //extents of the storage, larger than the array's when the layout pads it
+        SizeType storageWidth() const
+        {
+            return LayoutT::storageExtent(m_width, 0, 2);
+        }
+
+        SizeType storageHeight() const
+        {
+            return LayoutT::storageExtent(m_height, 1, 2);
+        }
+
+        SizeType storageSize() const
+        {
+            return storageWidth() * storageHeight();
+        }
+
+        //distance in elements between the starts of consecutive columns (rows for row major layouts)
+        template <typename L = LayoutT>
+        auto pitch() const -> decltype(L::pitch(SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight());
+        }
+
         void fill(const T& value)
         {
-            std::fill(begin(), end(), value);
+            std::fill(m_data.get(), m_data.get() + storageSize(), value);
         }
 
         void swap(Array2& other) noexcept
@@ -478,89 +518,84 @@ namespace ls
         template <typename Comp = std::equal_to<T>>
         void floodFill(SizeType x, SizeType y, const T& value, Comp comp = Comp{})
         {
-            SizeType width = m_width;
-            SizeType height = m_height;
-
-            std::stack<detail::Index2> coordsStack;
-            coordsStack.push(detail::Index2{ x, y });
-            const T initialCell = at(x, y);
-
-            while (!coordsStack.empty())
-            {
-                const detail::Index2 ind = coordsStack.top();
-                coordsStack.pop();
-                T& thisCell = at(ind.x, ind.y);
-
-                if (comp(value, thisCell)) continue;
+            FloodFillScratch scratch;
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
+        }
 
-                thisCell = value;
-                if (ind.x > 0 && comp(at(ind.x - 1, ind.y), initialCell)) coordsStack.push(detail::Index2{ ind.x - 1, ind.y });
-                if (ind.y > 0 && comp(at(ind.x, ind.y - 1), initialCell)) coordsStack.push(detail::Index2{ ind.x, ind.y - 1 });
-                if (ind.x < width - 1 && comp(at(ind.x + 1, ind.y), initialCell)) coordsStack.push(detail::Index2{ ind.x + 1, ind.y });
-                if (ind.y < height - 1 && comp(at(ind.x, ind.y + 1), initialCell)) coordsStack.push(detail::Index2{ ind.x, ind.y + 1 });
-            }
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
         }
 
     protected:
-        std::unique_ptr<T[]> m_data;
+        using BufferType = detail::ArrayBuffer<T, AllocatorT>;
+
+        BufferType m_data;
         SizeType m_width;
         SizeType m_height;
 
         SizeType index(SizeType x, SizeType y) const
         {
-            return x * m_height + y;
+            return LayoutT::index(x, y, storageWidth(), storageHeight());
+        }
+
+        template <typename U>
+        detail::Array2Iterator<U, LayoutT> iteratorAt(U* data, SizeType i) const
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, m_width, m_height, storageWidth(), storageHeight() };
         }
     };
 
 
-    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV>
-    struct Array2<T, WidthV, HeightV, ArrayStorageType::Dynamic>
+    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, typename LayoutT, typename AllocatorT>
+    struct Array2<T, WidthV, HeightV, ArrayStorageType::Dynamic, LayoutT, AllocatorT>
     {
         static_assert(WidthV > 0 && HeightV > 0);
 
         using ValueType = T;
         using SizeType = detail::SizeType;
+        using LayoutType = LayoutT;
+        using AllocatorType = AllocatorT;
 
-        using iterator = T * ;
-        using const_iterator = const T*;
+        using iterator = detail::Array2Iterator<T, LayoutT>;
+        using const_iterator = detail::Array2Iterator<const T, LayoutT>;
 
-        Array2()
+        Array2() :
+            m_data(storageSize(), AllocatorT())
         {
-            m_data = std::make_unique<T[]>(size());
         }
 
-        Array2(const T& initValue)
+        explicit Array2(const AllocatorT& alloc) :
+            m_data(storageSize(), alloc)
         {
-            const SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = initValue;
-            }
         }
 
-        Array2(const Array2& other)
+        Array2(const T& initValue, const AllocatorT& alloc = AllocatorT()) :
+            m_data(storageSize(), initValue, alloc)
+        {
+        }
+
+        Array2(const Array2& other) :
+            m_data(other.m_data)
+        {
+        }
+
+        Array2(const Array2& other, const AllocatorT& alloc) :
+            m_data(other.m_data, alloc)
         {
-            constexpr SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
         }
 
         Array2(Array2&& other) noexcept :
         m_data(std::move(other.m_data))
         {
-            other.m_data = nullptr;
         }
 
-        Array2& operator= (Array2&& other) noexcept
+        Array2& operator= (Array2&& other) noexcept(std::is_nothrow_move_assignable<BufferType>::value)
         {
             m_data = std::move(other.m_data);
 
-            other.m_data = nullptr;
-
             return *this;
         }
 
@@ -590,51 +625,60 @@ namespace ls
         {
             return m_data.get();
         }
+        T* data()
+        {
+            return m_data.get();
+        }
 
         bool isEmpty() const
         {
-            return m_data == nullptr;
+            return m_data.get() == nullptr;
+        }
+
+        const AllocatorT& allocator() const
+        {
+            return m_data.allocator();
         }
 
         iterator begin()
         {
-            return m_data.get();
+            return iteratorAt<T>(m_data.get(), 0);
         }
 
         iterator end()
         {
-            return m_data.get() + size();
+            return iteratorAt<T>(m_data.get(), storageSize());
         }
         const_iterator begin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator end() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
         const_iterator cbegin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator cend() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
 
-        detail::Array2Enumerate<T, WidthV, HeightV> enumerate()
+        detail::Array2Enumerate<T, WidthV, HeightV, LayoutT> enumerate()
         {
             return { m_data.get() };
         }
 
-        detail::Array2Enumerate<const T, WidthV, HeightV> cenumerate() const
+        detail::Array2Enumerate<const T, WidthV, HeightV, LayoutT> cenumerate() const
         {
             return { m_data.get() };
         }
 
-        detail::Array2Enumerate<const T, WidthV, HeightV> enumerate() const
+        detail::Array2Enumerate<const T, WidthV, HeightV, LayoutT> enumerate() const
         {
             return { m_data.get() };
         }
@@ -654,9 +698,30 @@ namespace ls
             return WidthV * HeightV;
         }
 
+        static constexpr SizeType storageWidth()
+        {
+            return LayoutT::storageExtent(WidthV, 0, 2);
+        }
+
+        static constexpr SizeType storageHeight()
+        {
+            return LayoutT::storageExtent(HeightV, 1, 2);
+        }
+
+        static constexpr SizeType storageSize()
+        {
+            return storageWidth() * storageHeight();
+        }
+
+        template <typename L = LayoutT>
+        static constexpr auto pitch() -> decltype(L::pitch(SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight());
+        }
+
         void fill(const T& value)
         {
-            std::fill(begin(), end(), value);
+            std::fill(m_data.get(), m_data.get() + storageSize(), value);
         }
 
         void swap(Array2& other) noexcept
@@ -669,45 +734,45 @@ namespace ls
         template <typename Comp = std::equal_to<T>>
         void floodFill(SizeType x, SizeType y, const T& value, Comp comp = Comp{})
         {
-            std::stack<detail::Index2> coordsStack;
-            coordsStack.push(detail::Index2{ x, y });
-            const T initialCell = at(x, y);
-
-            while (!coordsStack.empty())
-            {
-                const detail::Index2 ind = coordsStack.top();
-                coordsStack.pop();
-                T& thisCell = at(ind.x, ind.y);
-
-                if (comp(value, thisCell)) continue;
+            FloodFillScratch scratch;
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
+        }
 
-                thisCell = value;
-                if (ind.x > 0 && comp(at(ind.x - 1, ind.y), initialCell)) coordsStack.push(detail::Index2{ ind.x - 1, ind.y });
-                if (ind.y > 0 && comp(at(ind.x, ind.y - 1), initialCell)) coordsStack.push(detail::Index2{ ind.x, ind.y - 1 });
-                if (ind.x < WidthV - 1 && comp(at(ind.x + 1, ind.y), initialCell)) coordsStack.push(detail::Index2{ ind.x + 1, ind.y });
-                if (ind.y < HeightV - 1 && comp(at(ind.x, ind.y + 1), initialCell)) coordsStack.push(detail::Index2{ ind.x, ind.y + 1 });
-            }
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
         }
 
     protected:
-        std::unique_ptr<T[]> m_data;
+        using BufferType = detail::ArrayBuffer<T, AllocatorT>;
+
+        BufferType m_data;
 
         SizeType index(SizeType x, SizeType y) const
         {
-            return x * HeightV + y;
+            return LayoutT::index(x, y, storageWidth(), storageHeight());
+        }
+
+        template <typename U>
+        static detail::Array2Iterator<U, LayoutT> iteratorAt(U* data, SizeType i)
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, WidthV, HeightV, storageWidth(), storageHeight() };
         }
     };
 
 
-    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV>
-    struct Array2<T, WidthV, HeightV, ArrayStorageType::Automatic>
+    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, typename LayoutT, typename AllocatorT>
+    struct Array2<T, WidthV, HeightV, ArrayStorageType::Automatic, LayoutT, AllocatorT>
     {
         static_assert(WidthV > 0 && HeightV > 0);
 
         using ValueType = T;
         using SizeType = detail::SizeType;
-        using iterator = T * ;
-        using const_iterator = const T*;
+        using LayoutType = LayoutT;
+        using iterator = detail::Array2Iterator<T, LayoutT>;
+        using const_iterator = detail::Array2Iterator<const T, LayoutT>;
 
         constexpr Array2() noexcept :
         m_data{}
@@ -717,7 +782,7 @@ namespace ls
         constexpr Array2(const T& initValue) :
             Array2()
         {
-            const SizeType totalSize = size();
+            const SizeType totalSize = storageSize();
             for (SizeType i = 0; i < totalSize; ++i)
             {
                 m_data[i] = initValue;
@@ -731,24 +796,28 @@ namespace ls
 
         constexpr const T& operator() (SizeType x, SizeType y) const
         {
-            return m_data[x][y];
+            return m_data[index(x, y)];
         }
         constexpr T& operator() (SizeType x, SizeType y)
         {
-            return m_data[x][y];
+            return m_data[index(x, y)];
         }
         constexpr const T& at(SizeType x, SizeType y) const
         {
-            return m_data[x][y];
+            return m_data[index(x, y)];
         }
         constexpr T& at(SizeType x, SizeType y)
         {
-            return m_data[x][y];
+            return m_data[index(x, y)];
         }
 
         constexpr const T* data() const
         {
-            return &(m_data[0][0]);
+            return m_data;
+        }
+        constexpr T* data()
+        {
+            return m_data;
         }
 
         constexpr bool isEmpty() const
@@ -758,43 +827,43 @@ namespace ls
 
         constexpr iterator begin()
         {
-            return data();
+            return iteratorAt<T>(data(), 0);
         }
 
         constexpr iterator end()
         {
-            return data() + size();
+            return iteratorAt<T>(data(), storageSize());
         }
         constexpr const_iterator begin() const
         {
-            return data();
+            return iteratorAt<const T>(data(), 0);
         }
 
         constexpr const_iterator end() const
         {
-            return data() + size();
+            return iteratorAt<const T>(data(), storageSize());
         }
         constexpr const_iterator cbegin() const
         {
-            return data();
+            return iteratorAt<const T>(data(), 0);
         }
 
         constexpr const_iterator cend() const
         {
-            return data() + size();
+            return iteratorAt<const T>(data(), storageSize());
         }
 
-        detail::Array2Enumerate<T, WidthV, HeightV> enumerate()
+        detail::Array2Enumerate<T, WidthV, HeightV, LayoutT> enumerate()
         {
             return { data() };
         }
 
-        detail::Array2Enumerate<const T, WidthV, HeightV> cenumerate() const
+        detail::Array2Enumerate<const T, WidthV, HeightV, LayoutT> cenumerate() const
         {
             return { data() };
         }
 
-        detail::Array2Enumerate<const T, WidthV, HeightV> enumerate() const
+        detail::Array2Enumerate<const T, WidthV, HeightV, LayoutT> enumerate() const
         {
             return { data() };
         }
@@ -814,9 +883,30 @@ namespace ls
             return WidthV * HeightV;
         }
 
+        static constexpr SizeType storageWidth()
+        {
+            return LayoutT::storageExtent(WidthV, 0, 2);
+        }
+
+        static constexpr SizeType storageHeight()
+        {
+            return LayoutT::storageExtent(HeightV, 1, 2);
+        }
+
+        static constexpr SizeType storageSize()
+        {
+            return storageWidth() * storageHeight();
+        }
+
+        template <typename L = LayoutT>
+        static constexpr auto pitch() -> decltype(L::pitch(SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight());
+        }
+
         constexpr void fill(const T& value)
         {
-            std::fill(begin(), end(), value);
+            std::fill(data(), data() + storageSize(), value);
         }
 
         constexpr void swap(Array2& other) noexcept
@@ -829,43 +919,287 @@ namespace ls
         template <typename Comp = std::equal_to<T>>
         void floodFill(SizeType x, SizeType y, const T& value, Comp comp = Comp{})
         {
-            std::stack<detail::Index2> coordsStack;
-            coordsStack.push(detail::Index2{ x, y });
-            const T initialCell = at(x, y);
+            FloodFillScratch scratch;
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
+        }
 
-            while (!coordsStack.empty())
-            {
-                const detail::Index2 ind = coordsStack.top();
-                coordsStack.pop();
-                T& thisCell = at(ind.x, ind.y);
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
+        }
 
-                if (comp(value, thisCell)) continue;
+    protected:
+        T m_data[LayoutT::storageExtent(WidthV, 0, 2) * LayoutT::storageExtent(HeightV, 1, 2)];
 
-                thisCell = value;
-                if (ind.x > 0 && comp(at(ind.x - 1, ind.y), initialCell)) coordsStack.push(detail::Index2{ ind.x - 1, ind.y });
-                if (ind.y > 0 && comp(at(ind.x, ind.y - 1), initialCell)) coordsStack.push(detail::Index2{ ind.x, ind.y - 1 });
-                if (ind.x < WidthV - 1 && comp(at(ind.x + 1, ind.y), initialCell)) coordsStack.push(detail::Index2{ ind.x + 1, ind.y });
-                if (ind.y < HeightV - 1 && comp(at(ind.x, ind.y + 1), initialCell)) coordsStack.push(detail::Index2{ ind.x, ind.y + 1 });
-            }
+        static constexpr SizeType index(SizeType x, SizeType y)
+        {
+            return LayoutT::index(x, y, storageWidth(), storageHeight());
+        }
+
+        template <typename U>
+        static constexpr detail::Array2Iterator<U, LayoutT> iteratorAt(U* data, SizeType i)
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, WidthV, HeightV, storageWidth(), storageHeight() };
+        }
+    };
+
+    // Storage in a memory mapped file, the OS loads pages when they are first accessed and writes them back on its own.
+    // The file starts with a header recording the extents, the element type and the layout (see detail::MappedArrayHeader),
+    // the elements follow in LayoutT order. T must be trivially copyable. AllocatorT is not used.
+    template <typename T, typename LayoutT, typename AllocatorT>
+    struct Array2<T, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Mapped, LayoutT, AllocatorT>
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be stored in a mapped file.");
+
+        using ValueType = T;
+        using SizeType = detail::SizeType;
+        using LayoutType = LayoutT;
+        using AllocatorType = AllocatorT;
+
+        using iterator = detail::Array2Iterator<T, LayoutT>;
+        using const_iterator = detail::Array2Iterator<const T, LayoutT>;
+
+        Array2() noexcept :
+            m_file(),
+            m_data(nullptr),
+            m_width(0),
+            m_height(0)
+        {
+
+        }
+
+        // Creates (or overwrites) the file and maps it, all bytes of the elements are zero.
+        static Array2 createFile(const std::string& path, SizeType width, SizeType height)
+        {
+            const SizeType extents[3] = { width, height, 1 };
+            detail::MappedFile file = detail::createMappedArrayFile<T, LayoutT>(path, 2, extents);
+            T* data = reinterpret_cast<T*>(file.data() + detail::mappedArrayDataOffset<T>());
+            return Array2(std::move(file), data, width, height);
+        }
+
+        // Maps an existing file, throws std::runtime_error if its header doesn't match T, LayoutT or the number of dimensions,
+        // or if the file is too small for the extents in the header.
+        static Array2 fromFile(const std::string& path, MappedFileAccess access = MappedFileAccess::ReadWrite)
+        {
+            detail::MappedFile file = detail::MappedFile::open(path, access);
+            const detail::MappedArrayHeader header = detail::readMappedArrayHeader<T, LayoutT>(file, 2, path);
+            const SizeType width = static_cast<SizeType>(header.extents[0]);
+            const SizeType height = static_cast<SizeType>(header.extents[1]);
+            T* data = detail::mappedArrayData<T>(file, header);
+            return Array2(std::move(file), data, width, height);
+        }
+
+        Array2(const Array2&) = delete;
+        Array2& operator= (const Array2&) = delete;
+
+        Array2(Array2&& other) noexcept :
+            m_file(std::move(other.m_file)),
+            m_data(std::exchange(other.m_data, nullptr)),
+            m_width(std::exchange(other.m_width, 0)),
+            m_height(std::exchange(other.m_height, 0))
+        {
+        }
+
+        Array2& operator= (Array2&& other) noexcept
+        {
+            m_file = std::move(other.m_file);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_width = std::exchange(other.m_width, 0);
+            m_height = std::exchange(other.m_height, 0);
+
+            return *this;
+        }
+
+        const T& operator() (SizeType x, SizeType y) const
+        {
+            return m_data[index(x, y)];
+        }
+        T& operator() (SizeType x, SizeType y)
+        {
+            return m_data[index(x, y)];
+        }
+        const T& at(SizeType x, SizeType y) const
+        {
+            return m_data[index(x, y)];
+        }
+        T& at(SizeType x, SizeType y)
+        {
+            return m_data[index(x, y)];
+        }
+
+        const T* data() const
+        {
+            return m_data;
+        }
+        T* data()
+        {
+            return m_data;
+        }
+
+        bool isEmpty() const
+        {
+            return m_data == nullptr;
+        }
+
+        iterator begin()
+        {
+            return iteratorAt<T>(m_data, 0);
+        }
+
+        iterator end()
+        {
+            return iteratorAt<T>(m_data, storageSize());
+        }
+        const_iterator begin() const
+        {
+            return iteratorAt<const T>(m_data, 0);
+        }
+
+        const_iterator end() const
+        {
+            return iteratorAt<const T>(m_data, storageSize());
+        }
+        const_iterator cbegin() const
+        {
+            return iteratorAt<const T>(m_data, 0);
+        }
+
+        const_iterator cend() const
+        {
+            return iteratorAt<const T>(m_data, storageSize());
+        }
+
+        detail::Array2Enumerate<T, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate()
+        {
+            return { m_data, m_width, m_height };
+        }
+
+        detail::Array2Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, LayoutT> cenumerate() const
+        {
+            return { m_data, m_width, m_height };
+        }
+
+        detail::Array2Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate() const
+        {
+            return { m_data, m_width, m_height };
+        }
+
+        SizeType width() const
+        {
+            return m_width;
+        }
+
+        SizeType height() const
+        {
+            return m_height;
+        }
+
+        SizeType size() const
+        {
+            return m_width * m_height;
+        }
+
+        //extents of the storage, larger than the array's when the layout pads it
+        SizeType storageWidth() const
+        {
+            return LayoutT::storageExtent(m_width, 0, 2);
+        }
+
+        SizeType storageHeight() const
+        {
+            return LayoutT::storageExtent(m_height, 1, 2);
+        }
+
+        SizeType storageSize() const
+        {
+            return storageWidth() * storageHeight();
+        }
+
+        //distance in elements between the starts of consecutive columns (rows for row major layouts)
+        template <typename L = LayoutT>
+        auto pitch() const -> decltype(L::pitch(SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight());
+        }
+
+        void fill(const T& value)
+        {
+            std::fill(m_data, m_data + storageSize(), value);
+        }
+
+        // Blocks until the changes are written to the file. Otherwise the OS writes them back at some later point.
+        void flush()
+        {
+            m_file.flush();
+        }
+
+        void swap(Array2& other) noexcept
+        {
+            Array2 temp(std::move(*this));
+            *this = std::move(other);
+            other = std::move(temp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, const T& value, Comp comp = Comp{})
+        {
+            FloodFillScratch scratch;
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray2(*this, x, y, value, scratch, comp);
         }
 
     protected:
-        T m_data[WidthV][HeightV];
+        detail::MappedFile m_file;
+        T* m_data;
+        SizeType m_width;
+        SizeType m_height;
 
-        constexpr T* data()
+        Array2(detail::MappedFile&& file, T* data, SizeType width, SizeType height) noexcept :
+            m_file(std::move(file)),
+            m_data(data),
+            m_width(width),
+            m_height(height)
         {
-            return &(m_data[0][0]);
+        }
+
+        SizeType index(SizeType x, SizeType y) const
+        {
+            return LayoutT::index(x, y, storageWidth(), storageHeight());
+        }
+
+        template <typename U>
+        detail::Array2Iterator<U, LayoutT> iteratorAt(U* data, SizeType i) const
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, m_width, m_height, storageWidth(), storageHeight() };
         }
     };
 
-    template <typename T, detail::SizeType W, detail::SizeType H, ArrayStorageType S>
-    void swap(Array2<T, W, H, S>& lhs, Array2<T, W, H, S>& rhs) noexcept
+    template <typename T, detail::SizeType W, detail::SizeType H, ArrayStorageType S, typename L, typename A>
+    void swap(Array2<T, W, H, S, L, A>& lhs, Array2<T, W, H, S, L, A>& rhs) noexcept
     {
         lhs.swap(rhs);
     }
 
-    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV>
-    using AutoArray2 = Array2<T, WidthV, HeightV, ArrayStorageType::Automatic>;
+    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, typename LayoutT = ColumnMajorLayout>
+    using AutoArray2 = Array2<T, WidthV, HeightV, ArrayStorageType::Automatic, LayoutT>;
+
+    template <typename T, typename LayoutT = ColumnMajorLayout>
+    using MappedArray2 = Array2<T, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Mapped, LayoutT>;
+
+    namespace pmr
+    {
+        // Dynamic arrays with storage from a std::pmr::memory_resource, like an arena reset every frame.
+        template <typename T, detail::SizeType WidthV = detail::dynamicExtent, detail::SizeType HeightV = detail::dynamicExtent, typename LayoutT = ColumnMajorLayout>
+        using Array2 = ls::Array2<T, WidthV, HeightV, ArrayStorageType::Dynamic, LayoutT, std::pmr::polymorphic_allocator<T>>;
+    }
 
     /*
         template <class T>
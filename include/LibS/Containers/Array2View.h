@@ -0,0 +1,362 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include "Array2.h"
+
+#include "Fwd.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+namespace ls
+{
+    namespace detail
+    {
+        // Walks a view line by line along the axis with the smaller stride, so in storage order for arrays.
+        template <typename T>
+        struct Array2ViewIterator
+        {
+        public:
+            using SizeType = ::ls::detail::SizeType;
+            using self_type = Array2ViewIterator;
+            using value_type = std::remove_const_t<T>;
+            using reference = T&;
+            using pointer = T*;
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+
+            Array2ViewIterator() = default;
+
+            Array2ViewIterator(T* data, SizeType outer, SizeType innerSize, SizeType outerStride, SizeType innerStride, bool innerIsY) :
+                m_data(data),
+                m_outer(outer),
+                m_inner(0),
+                m_innerSize(innerSize),
+                m_outerStride(outerStride),
+                m_innerStride(innerStride),
+                m_innerIsY(innerIsY)
+            {
+            }
+
+            //mutable to const conversion
+            template <typename U, typename EnableT = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+            Array2ViewIterator(const Array2ViewIterator<U>& other) :
+                m_data(other.m_data),
+                m_outer(other.m_outer),
+                m_inner(other.m_inner),
+                m_innerSize(other.m_innerSize),
+                m_outerStride(other.m_outerStride),
+                m_innerStride(other.m_innerStride),
+                m_innerIsY(other.m_innerIsY)
+            {
+            }
+
+            self_type operator++(int)
+            {
+                self_type i = *this;
+
+                operator++();
+
+                return i;
+            }
+            self_type& operator++()
+            {
+                if (++m_inner >= m_innerSize)
+                {
+                    m_inner = 0;
+                    ++m_outer;
+                }
+
+                return *this;
+            }
+            reference operator*() const { return m_data[m_outer * m_outerStride + m_inner * m_innerStride]; }
+            pointer operator->() const { return m_data + (m_outer * m_outerStride + m_inner * m_innerStride); }
+            bool operator==(const self_type& rhs) const { return m_outer == rhs.m_outer && m_inner == rhs.m_inner; }
+            bool operator!=(const self_type& rhs) const { return !operator==(rhs); }
+
+            Index2 position() const
+            {
+                return m_innerIsY ? Index2{ m_outer, m_inner } : Index2{ m_inner, m_outer };
+            }
+
+        private:
+            template <typename>
+            friend struct Array2ViewIterator;
+
+            T* m_data;
+            SizeType m_outer;
+            SizeType m_inner;
+            SizeType m_innerSize;
+            SizeType m_outerStride;
+            SizeType m_innerStride;
+            bool m_innerIsY;
+        };
+
+        template <typename T>
+        struct Array2ViewEnumerate
+        {
+        public:
+            using SizeType = ::ls::detail::SizeType;
+
+            struct iterator
+            {
+            public:
+                using self_type = iterator;
+                using value_type = std::tuple<SizeType, SizeType, T&>;
+                using reference = value_type & ;
+                using pointer = value_type * ;
+                using iterator_category = std::input_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+
+                iterator(Array2ViewIterator<T> iter) :
+                    m_iter(iter)
+                {
+                }
+                self_type operator++(int)
+                {
+                    self_type i = *this;
+
+                    operator++();
+
+                    return i;
+                }
+                self_type operator++()
+                {
+                    ++m_iter;
+
+                    return *this;
+                }
+                value_type operator*()
+                {
+                    const Index2 pos = m_iter.position();
+                    return { pos.x, pos.y, *m_iter };
+                }
+                bool operator==(const self_type& rhs) { return m_iter == rhs.m_iter; }
+                bool operator!=(const self_type& rhs) { return m_iter != rhs.m_iter; }
+            private:
+                Array2ViewIterator<T> m_iter;
+            };
+
+            Array2ViewEnumerate(Array2ViewIterator<T> begin, Array2ViewIterator<T> end) :
+                m_begin(begin),
+                m_end(end)
+            {
+
+            }
+
+            iterator begin() const
+            {
+                return iterator(m_begin);
+            }
+
+            iterator end() const
+            {
+                return iterator(m_end);
+            }
+
+        private:
+            Array2ViewIterator<T> m_begin;
+            Array2ViewIterator<T> m_end;
+        };
+    }
+
+    // Non owning reference to a rectangle of cells in an Array2 or in an external buffer.
+    // Cell (x, y) of the view is at data[x * strideX + y * strideY], strides are in elements
+    // and may be larger than the distance between cells to view every n-th cell.
+    // T is const for read only views. The viewed storage must outlive the view.
+    template <typename T>
+    struct Array2View
+    {
+    public:
+        using ValueType = std::remove_const_t<T>;
+        using SizeType = detail::SizeType;
+
+        using iterator = detail::Array2ViewIterator<T>;
+        using const_iterator = detail::Array2ViewIterator<const T>;
+
+        Array2View() noexcept :
+            m_data(nullptr),
+            m_width(0),
+            m_height(0),
+            m_strideX(0),
+            m_strideY(0)
+        {
+
+        }
+
+        Array2View(T* data, SizeType width, SizeType height, SizeType strideX, SizeType strideY) noexcept :
+            m_data(data),
+            m_width(width),
+            m_height(height),
+            m_strideX(strideX),
+            m_strideY(strideY)
+        {
+
+        }
+
+        // Contiguous column major buffer, the same layout as a default Array2.
+        Array2View(T* data, SizeType width, SizeType height) noexcept :
+            Array2View(data, width, height, height, 1)
+        {
+
+        }
+
+        // Views the whole array. Only layouts made of lines can be viewed.
+        template <
+            typename ArrayT,
+            typename EnableT = std::enable_if_t<std::is_convertible<decltype(std::declval<ArrayT&>().data()), T*>::value>,
+            typename PitchT = decltype(std::declval<ArrayT&>().pitch()),
+            typename CellT = decltype(std::declval<ArrayT&>()(SizeType{}, SizeType{}))
+        >
+        Array2View(ArrayT& arr) noexcept :
+            m_data(arr.data()),
+            m_width(arr.width()),
+            m_height(arr.height())
+        {
+            using LayoutType = typename std::remove_const_t<ArrayT>::LayoutType;
+            const SizeType storageWidth = arr.storageWidth();
+            const SizeType storageHeight = arr.storageHeight();
+            const SizeType origin = LayoutType::index(0, 0, storageWidth, storageHeight);
+            m_strideX = LayoutType::index(1, 0, storageWidth, storageHeight) - origin;
+            m_strideY = LayoutType::index(0, 1, storageWidth, storageHeight) - origin;
+        }
+
+        //mutable to const conversion
+        template <typename U, typename EnableT = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+        Array2View(const Array2View<U>& other) noexcept :
+            m_data(other.data()),
+            m_width(other.width()),
+            m_height(other.height()),
+            m_strideX(other.strideX()),
+            m_strideY(other.strideY())
+        {
+
+        }
+
+        Array2View(const Array2View&) noexcept = default;
+        Array2View& operator= (const Array2View&) noexcept = default;
+
+        T& operator() (SizeType x, SizeType y) const
+        {
+            return m_data[x * m_strideX + y * m_strideY];
+        }
+        T& at(SizeType x, SizeType y) const
+        {
+            return m_data[x * m_strideX + y * m_strideY];
+        }
+
+        // [x, x + width) x [y, y + height) of this view.
+        Array2View subview(SizeType x, SizeType y, SizeType width, SizeType height) const
+        {
+            return Array2View(&at(x, y), width, height, m_strideX, m_strideY);
+        }
+
+        // Every stepX-th column and stepY-th row of [x, x + width * stepX) x [y, y + height * stepY).
+        Array2View subview(SizeType x, SizeType y, SizeType width, SizeType height, SizeType stepX, SizeType stepY) const
+        {
+            return Array2View(&at(x, y), width, height, m_strideX * stepX, m_strideY * stepY);
+        }
+
+        T* data() const
+        {
+            return m_data;
+        }
+
+        bool isEmpty() const
+        {
+            return m_width <= 0 || m_height <= 0;
+        }
+
+        iterator begin() const
+        {
+            return isEmpty() ? end() : (innerIsY() ? iterator(m_data, 0, m_height, m_strideX, m_strideY, true) : iterator(m_data, 0, m_width, m_strideY, m_strideX, false));
+        }
+
+        iterator end() const
+        {
+            return innerIsY() ? iterator(m_data, std::max<SizeType>(m_width, 0), m_height, m_strideX, m_strideY, true) : iterator(m_data, std::max<SizeType>(m_height, 0), m_width, m_strideY, m_strideX, false);
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        detail::Array2ViewEnumerate<T> enumerate() const
+        {
+            return { begin(), end() };
+        }
+
+        detail::Array2ViewEnumerate<const T> cenumerate() const
+        {
+            return { begin(), end() };
+        }
+
+        SizeType width() const
+        {
+            return m_width;
+        }
+
+        SizeType height() const
+        {
+            return m_height;
+        }
+
+        SizeType size() const
+        {
+            return m_width * m_height;
+        }
+
+        SizeType strideX() const
+        {
+            return m_strideX;
+        }
+
+        SizeType strideY() const
+        {
+            return m_strideY;
+        }
+
+        void fill(const T& value) const
+        {
+            for (T& cell : *this)
+            {
+                cell = value;
+            }
+        }
+
+        //fill function must take x, y as coordinates and output a value
+        template <typename FillFunction>
+        void fill(FillFunction fillingFunction) const
+        {
+            for (auto&& [x, y, cell] : enumerate())
+            {
+                cell = fillingFunction(x, y);
+            }
+        }
+
+    private:
+        T* m_data;
+        SizeType m_width;
+        SizeType m_height;
+        SizeType m_strideX;
+        SizeType m_strideY;
+
+        bool innerIsY() const
+        {
+            return std::abs(m_strideY) <= std::abs(m_strideX);
+        }
+    };
+
+    template <typename ArrayT>
+    Array2View(ArrayT&) -> Array2View<std::conditional_t<std::is_const<ArrayT>::value, const typename ArrayT::ValueType, typename ArrayT::ValueType>>;
+}
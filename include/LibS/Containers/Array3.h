@@ -2,18 +2,29 @@
 
 #include "LibS/Detail.h"
 
+#include "ArrayLayout.h"
+#include "ArrayBuffer.h"
+#include "ArrayFloodFill.h"
+#include "MappedFile.h"
+
 #include "Fwd.h"
 
+#include <algorithm>
+#include <functional>
 #include <utility>
 #include <memory>
+#include <memory_resource>
+#include <string>
 #include <tuple>
 #include <iterator>
+#include <type_traits>
 
 namespace ls
 {
     namespace detail
     {
-        template <typename T, SizeType WidthV = dynamicExtent, SizeType HeightV = dynamicExtent, SizeType DepthV = dynamicExtent>
+        // Cells are visited in the order they are stored in, as given by LayoutT.
+        template <typename T, SizeType WidthV = dynamicExtent, SizeType HeightV = dynamicExtent, SizeType DepthV = dynamicExtent, typename LayoutT = ColumnMajorLayout>
         struct Array3Enumerate
         {
             static_assert(WidthV > 0 && HeightV > 0 && DepthV > 0);
@@ -21,6 +32,10 @@ namespace ls
         public:
             using SizeType = ::ls::detail::SizeType;
 
+            static constexpr SizeType storageWidth = LayoutT::storageExtent(WidthV, 0, 3);
+            static constexpr SizeType storageHeight = LayoutT::storageExtent(HeightV, 1, 3);
+            static constexpr SizeType storageDepth = LayoutT::storageExtent(DepthV, 2, 3);
+
             Array3Enumerate(T* data) :
                 m_data(data)
             {
@@ -37,11 +52,10 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                iterator(T* data) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0),
-                    m_z(0)
+                iterator(T* data, SizeType index) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0, 0 }
                 {
                 }
                 self_type operator++(int)
@@ -54,29 +68,17 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_z;
-                    if (m_z >= DepthV)
-                    {
-                        ++m_y;
-                        m_z = 0;
-                        if (m_y >= HeightV)
-                        {
-                            ++m_x;
-                            m_y = 0;
-                        }
-                    }
+                    LayoutT::next(m_index, m_pos, WidthV, HeightV, DepthV, storageWidth, storageHeight, storageDepth);
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, m_z, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_pos.z, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                T * m_ptr;
-                SizeType m_x;
-                SizeType m_y;
-                SizeType m_z;
+                T * m_data;
+                SizeType m_index;
+                Index3 m_pos;
             };
 
             struct const_iterator
@@ -89,11 +91,10 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                const_iterator(const T* data) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0),
-                    m_z(0)
+                const_iterator(const T* data, SizeType index) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0, 0 }
                 {
                 }
                 self_type operator++(int)
@@ -106,66 +107,54 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_z;
-                    if (m_z >= DepthV)
-                    {
-                        ++m_y;
-                        m_z = 0;
-                        if (m_y >= HeightV)
-                        {
-                            ++m_x;
-                            m_y = 0;
-                        }
-                    }
+                    LayoutT::next(m_index, m_pos, WidthV, HeightV, DepthV, storageWidth, storageHeight, storageDepth);
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, m_z, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_pos.z, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                const T * m_ptr;
-                SizeType m_x;
-                SizeType m_y;
-                SizeType m_z;
+                const T * m_data;
+                SizeType m_index;
+                Index3 m_pos;
             };
 
             iterator begin()
             {
-                return iterator(m_data);
+                return iterator(m_data, 0);
             }
 
             iterator end()
             {
-                return iterator(m_data + WidthV * HeightV * DepthV);
+                return iterator(m_data, storageWidth * storageHeight * storageDepth);
             }
 
             const_iterator begin() const
             {
-                return const_iterator(m_data);
+                return const_iterator(m_data, 0);
             }
 
             const_iterator end() const
             {
-                return const_iterator(m_data + WidthV * HeightV * DepthV);
+                return const_iterator(m_data, storageWidth * storageHeight * storageDepth);
             }
 
             const_iterator cbegin() const
             {
-                return const_iterator(m_data);
+                return const_iterator(m_data, 0);
             }
 
             const_iterator cend() const
             {
-                return const_iterator(m_data + WidthV * HeightV * DepthV);
+                return const_iterator(m_data, storageWidth * storageHeight * storageDepth);
             }
         private:
             T * m_data;
         };
 
-        template <typename T>
-        struct Array3Enumerate<T, dynamicExtent, dynamicExtent, dynamicExtent>
+        template <typename T, typename LayoutT>
+        struct Array3Enumerate<T, dynamicExtent, dynamicExtent, dynamicExtent, LayoutT>
         {
         public:
             using SizeType = ::ls::detail::SizeType;
@@ -189,11 +178,11 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                iterator(T* data, SizeType height, SizeType depth) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0),
-                    m_z(0),
+                iterator(T* data, SizeType index, SizeType width, SizeType height, SizeType depth) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0, 0 },
+                    m_width(width),
                     m_height(height),
                     m_depth(depth)
                 {
@@ -208,29 +197,21 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_z;
-                    if (m_z >= m_depth)
-                    {
-                        ++m_y;
-                        m_z = 0;
-                        if (m_y >= m_height)
-                        {
-                            ++m_x;
-                            m_y = 0;
-                        }
-                    }
+                    LayoutT::next(
+                        m_index, m_pos, m_width, m_height, m_depth,
+                        LayoutT::storageExtent(m_width, 0, 3), LayoutT::storageExtent(m_height, 1, 3), LayoutT::storageExtent(m_depth, 2, 3)
+                    );
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, m_z, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_pos.z, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                T * m_ptr;
-                SizeType m_x;
-                SizeType m_y;
-                SizeType m_z;
+                T * m_data;
+                SizeType m_index;
+                Index3 m_pos;
+                SizeType m_width;
                 SizeType m_height;
                 SizeType m_depth;
             };
@@ -245,11 +226,11 @@ namespace ls
                 using iterator_category = std::input_iterator_tag;
                 using difference_type = std::ptrdiff_t;
 
-                const_iterator(const T* data, SizeType height, SizeType depth) :
-                    m_ptr(data),
-                    m_x(0),
-                    m_y(0),
-                    m_z(0),
+                const_iterator(const T* data, SizeType index, SizeType width, SizeType height, SizeType depth) :
+                    m_data(data),
+                    m_index(index),
+                    m_pos{ 0, 0, 0 },
+                    m_width(width),
                     m_height(height),
                     m_depth(depth)
                 {
@@ -264,89 +245,94 @@ namespace ls
                 }
                 self_type operator++()
                 {
-                    ++m_ptr;
-                    ++m_z;
-                    if (m_z >= m_depth)
-                    {
-                        ++m_y;
-                        m_z = 0;
-                        if (m_y >= m_height)
-                        {
-                            ++m_x;
-                            m_y = 0;
-                        }
-                    }
+                    LayoutT::next(
+                        m_index, m_pos, m_width, m_height, m_depth,
+                        LayoutT::storageExtent(m_width, 0, 3), LayoutT::storageExtent(m_height, 1, 3), LayoutT::storageExtent(m_depth, 2, 3)
+                    );
 
                     return *this;
                 }
-                value_type operator*() { return { m_x, m_y, m_z, *m_ptr }; }
-                bool operator==(const self_type& rhs) { return m_ptr == rhs.m_ptr; }
-                bool operator!=(const self_type& rhs) { return m_ptr != rhs.m_ptr; }
+                value_type operator*() { return { m_pos.x, m_pos.y, m_pos.z, m_data[m_index] }; }
+                bool operator==(const self_type& rhs) { return m_index == rhs.m_index; }
+                bool operator!=(const self_type& rhs) { return m_index != rhs.m_index; }
             private:
-                T * m_ptr;
-                SizeType m_x;
-                SizeType m_y;
-                SizeType m_z;
+                const T * m_data;
+                SizeType m_index;
+                Index3 m_pos;
+                SizeType m_width;
                 SizeType m_height;
                 SizeType m_depth;
             };
 
             iterator begin()
             {
-                return iterator(m_data, m_height, m_depth);
+                return iterator(m_data, 0, m_width, m_height, m_depth);
             }
 
             iterator end()
             {
-                return iterator(m_data + m_width * m_height * m_depth, m_height, m_depth);
+                return iterator(m_data, storageSize(), m_width, m_height, m_depth);
             }
 
             const_iterator begin() const
             {
-                return const_iterator(m_data, m_height, m_depth);
+                return const_iterator(m_data, 0, m_width, m_height, m_depth);
             }
 
             const_iterator end() const
             {
-                return const_iterator(m_data + m_width * m_height * m_depth, m_height, m_depth);
+                return const_iterator(m_data, storageSize(), m_width, m_height, m_depth);
             }
 
             const_iterator cbegin() const
             {
-                return const_iterator(m_data, m_height, m_depth);
+                return const_iterator(m_data, 0, m_width, m_height, m_depth);
             }
 
             const_iterator cend() const
             {
-                return const_iterator(m_data + m_width * m_height * m_depth, m_height, m_depth);
+                return const_iterator(m_data, storageSize(), m_width, m_height, m_depth);
             }
         private:
             T * m_data;
             SizeType m_width;
             SizeType m_height;
             SizeType m_depth;
+
+            SizeType storageSize() const
+            {
+                return LayoutT::storageExtent(m_width, 0, 3) * LayoutT::storageExtent(m_height, 1, 3) * LayoutT::storageExtent(m_depth, 2, 3);
+            }
         };
     }
 
+    // LayoutT decides how cells are placed in memory, see ArrayLayout.h.
+    // Iterators and enumerate() visit cells in the order they are stored in.
+    // AllocatorT is used only by dynamic storage, for example AlignedAllocator for SIMD kernels.
+    // Mapped storage keeps the cells in a file, it only supports dynamic extents.
     template <
-        typename, 
-        detail::SizeType = detail::dynamicExtent, 
-        detail::SizeType = detail::dynamicExtent, 
-        detail::SizeType = detail::dynamicExtent, 
-        ArrayStorageType = ArrayStorageType::Dynamic
+        typename T,
+        detail::SizeType = detail::dynamicExtent,
+        detail::SizeType = detail::dynamicExtent,
+        detail::SizeType = detail::dynamicExtent,
+        ArrayStorageType = ArrayStorageType::Dynamic,
+        typename = ColumnMajorLayout,
+        typename = std::allocator<T>
     >
     struct Array3;
 
-    template <typename T>
-    struct Array3<T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Dynamic>
+    template <typename T, typename LayoutT, typename AllocatorT>
+    struct Array3<T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Dynamic, LayoutT, AllocatorT>
     {
         using ValueType = T;
         using SizeType = detail::SizeType;
-        using iterator = T * ;
-        using const_iterator = const T*;
+        using LayoutType = LayoutT;
+        using AllocatorType = AllocatorT;
+        using iterator = detail::Array3Iterator<T, LayoutT>;
+        using const_iterator = detail::Array3Iterator<const T, LayoutT>;
 
         Array3() noexcept :
-        m_data(nullptr),
+        m_data(),
             m_width(0),
             m_height(0),
             m_depth(0)
@@ -354,38 +340,47 @@ namespace ls
 
         }
 
-        Array3(SizeType width, SizeType height, SizeType depth) :
+        explicit Array3(const AllocatorT& alloc) noexcept :
+            m_data(alloc),
+            m_width(0),
+            m_height(0),
+            m_depth(0)
+        {
+
+        }
+
+        Array3(SizeType width, SizeType height, SizeType depth, const AllocatorT& alloc = AllocatorT()) :
+            m_data(alloc),
             m_width(width),
             m_height(height),
             m_depth(depth)
         {
-            m_data = std::make_unique<T[]>(size());
+            m_data = BufferType(storageSize(), alloc);
         }
 
-        Array3(SizeType width, SizeType height, SizeType depth, const T& initValue) :
+        Array3(SizeType width, SizeType height, SizeType depth, const T& initValue, const AllocatorT& alloc = AllocatorT()) :
+            m_data(alloc),
             m_width(width),
             m_height(height),
             m_depth(depth)
         {
-            const SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = initValue;
-            }
+            m_data = BufferType(storageSize(), initValue, alloc);
         }
 
         Array3(const Array3& other) :
+            m_data(other.m_data),
+            m_width(other.m_width),
+            m_height(other.m_height),
+            m_depth(other.m_depth)
+        {
+        }
+
+        Array3(const Array3& other, const AllocatorT& alloc) :
+            m_data(other.m_data, alloc),
             m_width(other.m_width),
             m_height(other.m_height),
             m_depth(other.m_depth)
         {
-            const SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
         }
 
         Array3(Array3&& other) noexcept :
@@ -394,18 +389,15 @@ namespace ls
             m_height(std::move(other.m_height)),
             m_depth(std::move(other.m_depth))
         {
-            other.m_data = nullptr;
         }
 
-        Array3& operator= (Array3&& other) noexcept
+        Array3& operator= (Array3&& other) noexcept(std::is_nothrow_move_assignable<BufferType>::value)
         {
             m_data = std::move(other.m_data);
             m_width = std::move(other.m_width);
             m_height = std::move(other.m_height);
             m_depth = std::move(other.m_depth);
 
-            other.m_data = nullptr;
-
             return *this;
         }
 
@@ -435,51 +427,60 @@ namespace ls
         {
             return m_data.get();
         }
+        T* data()
+        {
+            return m_data.get();
+        }
 
         bool isEmpty() const
         {
-            return m_data == nullptr;
+            return m_data.get() == nullptr;
+        }
+
+        const AllocatorT& allocator() const
+        {
+            return m_data.allocator();
         }
 
         iterator begin()
         {
-            return m_data.get();
+            return iteratorAt<T>(m_data.get(), 0);
         }
 
         iterator end()
         {
-            return m_data.get() + size();
+            return iteratorAt<T>(m_data.get(), storageSize());
         }
         const_iterator begin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator end() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
         const_iterator cbegin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator cend() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
 
-        detail::Array3Enumerate<T> enumerate()
+        detail::Array3Enumerate<T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate()
         {
             return { m_data.get(), m_width, m_height, m_depth };
         }
 
-        detail::Array3Enumerate<const T> cenumerate() const
+        detail::Array3Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, LayoutT> cenumerate() const
         {
             return { m_data.get(), m_width, m_height, m_depth };
         }
 
-        detail::Array3Enumerate<const T> enumerate() const
+        detail::Array3Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate() const
         {
             return { m_data.get(), m_width, m_height, m_depth };
         }
@@ -504,9 +505,44 @@ namespace ls
             return m_width * m_height * m_depth;
         }
 
+        //extents of the storage, larger than the array's when the layout pads it
+        SizeType storageWidth() const
+        {
+            return LayoutT::storageExtent(m_width, 0, 3);
+        }
+
+        SizeType storageHeight() const
+        {
+            return LayoutT::storageExtent(m_height, 1, 3);
+        }
+
+        SizeType storageDepth() const
+        {
+            return LayoutT::storageExtent(m_depth, 2, 3);
+        }
+
+        SizeType storageSize() const
+        {
+            return storageWidth() * storageHeight() * storageDepth();
+        }
+
+        //distance in elements between the starts of consecutive lines along the fastest changing axis
+        template <typename L = LayoutT>
+        auto pitch() const -> decltype(L::pitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
+        //distance in elements between the starts of consecutive slices along the slowest changing axis
+        template <typename L = LayoutT>
+        auto slicePitch() const -> decltype(L::slicePitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::slicePitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
         void fill(const T& value)
         {
-            std::fill(begin(), end(), value);
+            std::fill(m_data.get(), m_data.get() + storageSize(), value);
         }
 
         void swap(Array3& other) noexcept
@@ -516,64 +552,86 @@ namespace ls
             other = std::move(temp);
         }
 
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, Comp comp = Comp{})
+        {
+            FloodFillScratch scratch;
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
     protected:
-        std::unique_ptr<T[]> m_data;
+        using BufferType = detail::ArrayBuffer<T, AllocatorT>;
+
+        BufferType m_data;
         SizeType m_width;
         SizeType m_height;
         SizeType m_depth;
 
         SizeType index(SizeType x, SizeType y, SizeType z) const
         {
-            return (x * m_height + y) * m_depth + z;
+            return LayoutT::index(x, y, z, storageWidth(), storageHeight(), storageDepth());
+        }
+
+        template <typename U>
+        detail::Array3Iterator<U, LayoutT> iteratorAt(U* data, SizeType i) const
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, m_width, m_height, m_depth, storageWidth(), storageHeight(), storageDepth() };
         }
     };
 
-    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV>
-    struct Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Dynamic>
+    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV, typename LayoutT, typename AllocatorT>
+    struct Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Dynamic, LayoutT, AllocatorT>
     {
         static_assert(WidthV > 0 && HeightV > 0 && DepthV > 0);
 
         using ValueType = T;
         using SizeType = detail::SizeType;
-        using iterator = T * ;
-        using const_iterator = const T*;
+        using LayoutType = LayoutT;
+        using AllocatorType = AllocatorT;
+        using iterator = detail::Array3Iterator<T, LayoutT>;
+        using const_iterator = detail::Array3Iterator<const T, LayoutT>;
 
-        Array3()
+        Array3() :
+            m_data(storageSize(), AllocatorT())
         {
-            m_data = std::make_unique<T[]>(size());
         }
 
-        Array3(const T& initValue) :
-            Array3()
+        explicit Array3(const AllocatorT& alloc) :
+            m_data(storageSize(), alloc)
         {
-            for (SizeType i = 0; i < size(); ++i)
-            {
-                m_data[i] = initValue;
-            }
         }
 
-        Array3(const Array3& other)
+        Array3(const T& initValue, const AllocatorT& alloc = AllocatorT()) :
+            m_data(storageSize(), initValue, alloc)
+        {
+        }
+
+        Array3(const Array3& other) :
+            m_data(other.m_data)
+        {
+        }
+
+        Array3(const Array3& other, const AllocatorT& alloc) :
+            m_data(other.m_data, alloc)
         {
-            constexpr SizeType totalSize = size();
-            m_data = std::make_unique<T[]>(totalSize);
-            for (SizeType i = 0; i < totalSize; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
         }
 
         Array3(Array3&& other) noexcept :
         m_data(std::move(other.m_data))
         {
-            other.m_data = nullptr;
         }
 
-        Array3& operator= (Array3&& other) noexcept
+        Array3& operator= (Array3&& other) noexcept(std::is_nothrow_move_assignable<BufferType>::value)
         {
             m_data = std::move(other.m_data);
 
-            other.m_data = nullptr;
-
             return *this;
         }
 
@@ -619,62 +677,103 @@ namespace ls
             return WidthV * HeightV * DepthV;
         }
 
+        static constexpr SizeType storageWidth()
+        {
+            return LayoutT::storageExtent(WidthV, 0, 3);
+        }
+
+        static constexpr SizeType storageHeight()
+        {
+            return LayoutT::storageExtent(HeightV, 1, 3);
+        }
+
+        static constexpr SizeType storageDepth()
+        {
+            return LayoutT::storageExtent(DepthV, 2, 3);
+        }
+
+        static constexpr SizeType storageSize()
+        {
+            return storageWidth() * storageHeight() * storageDepth();
+        }
+
+        template <typename L = LayoutT>
+        static constexpr auto pitch() -> decltype(L::pitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
+        template <typename L = LayoutT>
+        static constexpr auto slicePitch() -> decltype(L::slicePitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::slicePitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
         const T* data() const
         {
             return m_data.get();
         }
+        T* data()
+        {
+            return m_data.get();
+        }
 
         bool isEmpty() const
         {
-            return m_data == nullptr;
+            return m_data.get() == nullptr;
+        }
+
+        const AllocatorT& allocator() const
+        {
+            return m_data.allocator();
         }
 
         iterator begin()
         {
-            return m_data.get();
+            return iteratorAt<T>(m_data.get(), 0);
         }
 
         iterator end()
         {
-            return m_data.get() + size();
+            return iteratorAt<T>(m_data.get(), storageSize());
         }
         const_iterator begin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
         const_iterator end() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
         const_iterator cbegin() const
         {
-            return m_data.get();
+            return iteratorAt<const T>(m_data.get(), 0);
         }
 
-        detail::Array3Enumerate<T, WidthV, HeightV, DepthV> enumerate()
+        detail::Array3Enumerate<T, WidthV, HeightV, DepthV, LayoutT> enumerate()
         {
             return { m_data.get() };
         }
 
-        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV> cenumerate() const
+        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV, LayoutT> cenumerate() const
         {
             return { m_data.get() };
         }
 
-        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV> enumerate() const
+        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV, LayoutT> enumerate() const
         {
             return { m_data.get() };
         }
 
         const_iterator cend() const
         {
-            return m_data.get() + size();
+            return iteratorAt<const T>(m_data.get(), storageSize());
         }
 
         void fill(const T& value)
         {
-            std::fill(begin(), end(), value);
+            std::fill(m_data.get(), m_data.get() + storageSize(), value);
         }
 
         void swap(Array3& other) noexcept
@@ -684,24 +783,47 @@ namespace ls
             other = std::move(temp);
         }
 
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, Comp comp = Comp{})
+        {
+            FloodFillScratch scratch;
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
     protected:
-        std::unique_ptr<T[]> m_data;
+        using BufferType = detail::ArrayBuffer<T, AllocatorT>;
+
+        BufferType m_data;
 
         SizeType index(SizeType x, SizeType y, SizeType z) const
         {
-            return (x * HeightV + y) * DepthV + z;
+            return LayoutT::index(x, y, z, storageWidth(), storageHeight(), storageDepth());
+        }
+
+        template <typename U>
+        static detail::Array3Iterator<U, LayoutT> iteratorAt(U* data, SizeType i)
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, WidthV, HeightV, DepthV, storageWidth(), storageHeight(), storageDepth() };
         }
     };
 
-    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV>
-    struct Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Automatic>
+    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV, typename LayoutT, typename AllocatorT>
+    struct Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Automatic, LayoutT, AllocatorT>
     {
         static_assert(WidthV > 0 && HeightV > 0 && DepthV > 0);
 
         using ValueType = T;
         using SizeType = detail::SizeType;
-        using iterator = T * ;
-        using const_iterator = const T*;
+        using LayoutType = LayoutT;
+        using iterator = detail::Array3Iterator<T, LayoutT>;
+        using const_iterator = detail::Array3Iterator<const T, LayoutT>;
 
         constexpr Array3() noexcept :
         m_data{}
@@ -710,7 +832,7 @@ namespace ls
         constexpr Array3(const T& initValue) :
             Array3()
         {
-            constexpr SizeType totalSize = size();
+            constexpr SizeType totalSize = storageSize();
             for (SizeType i = 0; i < totalSize; ++i)
             {
                 m_data[i] = initValue;
@@ -723,19 +845,19 @@ namespace ls
 
         constexpr const T& operator() (SizeType x, SizeType y, SizeType z) const
         {
-            return m_data[x][y][z];
+            return m_data[index(x, y, z)];
         }
         constexpr T& operator() (SizeType x, SizeType y, SizeType z)
         {
-            return m_data[x][y][z];
+            return m_data[index(x, y, z)];
         }
         constexpr const T& at(SizeType x, SizeType y, SizeType z) const
         {
-            return m_data[x][y][z];
+            return m_data[index(x, y, z)];
         }
         constexpr T& at(SizeType x, SizeType y, SizeType z)
         {
-            return m_data[x][y][z];
+            return m_data[index(x, y, z)];
         }
 
         constexpr SizeType width() const
@@ -758,9 +880,45 @@ namespace ls
             return WidthV * HeightV * DepthV;
         }
 
+        static constexpr SizeType storageWidth()
+        {
+            return LayoutT::storageExtent(WidthV, 0, 3);
+        }
+
+        static constexpr SizeType storageHeight()
+        {
+            return LayoutT::storageExtent(HeightV, 1, 3);
+        }
+
+        static constexpr SizeType storageDepth()
+        {
+            return LayoutT::storageExtent(DepthV, 2, 3);
+        }
+
+        static constexpr SizeType storageSize()
+        {
+            return storageWidth() * storageHeight() * storageDepth();
+        }
+
+        template <typename L = LayoutT>
+        static constexpr auto pitch() -> decltype(L::pitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
+        template <typename L = LayoutT>
+        static constexpr auto slicePitch() -> decltype(L::slicePitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::slicePitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
         constexpr const T* data() const
         {
-            return &(m_data[0][0][0]);
+            return m_data;
+        }
+        constexpr T* data()
+        {
+            return m_data;
         }
 
         constexpr bool isEmpty() const
@@ -770,50 +928,50 @@ namespace ls
 
         constexpr iterator begin()
         {
-            return data();
+            return iteratorAt<T>(data(), 0);
         }
 
         constexpr iterator end()
         {
-            return data() + size();
+            return iteratorAt<T>(data(), storageSize());
         }
         constexpr const_iterator begin() const
         {
-            return data();
+            return iteratorAt<const T>(data(), 0);
         }
 
         constexpr const_iterator end() const
         {
-            return data() + size();
+            return iteratorAt<const T>(data(), storageSize());
         }
         constexpr const_iterator cbegin() const
         {
-            return data();
+            return iteratorAt<const T>(data(), 0);
         }
 
         constexpr const_iterator cend() const
         {
-            return data() + size();
+            return iteratorAt<const T>(data(), storageSize());
         }
 
-        detail::Array3Enumerate<T, WidthV, HeightV, DepthV> enumerate()
+        detail::Array3Enumerate<T, WidthV, HeightV, DepthV, LayoutT> enumerate()
         {
             return { data() };
         }
 
-        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV> cenumerate() const
+        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV, LayoutT> cenumerate() const
         {
             return { data() };
         }
 
-        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV> enumerate() const
+        detail::Array3Enumerate<const T, WidthV, HeightV, DepthV, LayoutT> enumerate() const
         {
             return { data() };
         }
 
         constexpr void fill(const T& value)
         {
-            std::fill(begin(), end(), value);
+            std::fill(data(), data() + storageSize(), value);
         }
 
         constexpr void swap(Array3& other) noexcept
@@ -823,22 +981,315 @@ namespace ls
             other = std::move(temp);
         }
 
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, Comp comp = Comp{})
+        {
+            FloodFillScratch scratch;
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
     protected:
-        T m_data[WidthV][HeightV][DepthV];
+        T m_data[LayoutT::storageExtent(WidthV, 0, 3) * LayoutT::storageExtent(HeightV, 1, 3) * LayoutT::storageExtent(DepthV, 2, 3)];
 
-        constexpr T* data()
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType z)
+        {
+            return LayoutT::index(x, y, z, storageWidth(), storageHeight(), storageDepth());
+        }
+
+        template <typename U>
+        static constexpr detail::Array3Iterator<U, LayoutT> iteratorAt(U* data, SizeType i)
         {
-            return &(m_data[0][0][0]);
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, WidthV, HeightV, DepthV, storageWidth(), storageHeight(), storageDepth() };
         }
     };
 
-    template <typename T, detail::SizeType W, detail::SizeType H, detail::SizeType D, ArrayStorageType S>
-    void swap(Array3<T, W, H, D, S>& lhs, Array3<T, W, H, D, S>& rhs) noexcept
+    // Storage in a memory mapped file, the OS loads pages when they are first accessed and writes them back on its own.
+    // The file starts with a header recording the extents, the element type and the layout (see detail::MappedArrayHeader),
+    // the elements follow in LayoutT order. T must be trivially copyable. AllocatorT is not used.
+    template <typename T, typename LayoutT, typename AllocatorT>
+    struct Array3<T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Mapped, LayoutT, AllocatorT>
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be stored in a mapped file.");
+
+        using ValueType = T;
+        using SizeType = detail::SizeType;
+        using LayoutType = LayoutT;
+        using AllocatorType = AllocatorT;
+        using iterator = detail::Array3Iterator<T, LayoutT>;
+        using const_iterator = detail::Array3Iterator<const T, LayoutT>;
+
+        Array3() noexcept :
+            m_file(),
+            m_data(nullptr),
+            m_width(0),
+            m_height(0),
+            m_depth(0)
+        {
+
+        }
+
+        // Creates (or overwrites) the file and maps it, all bytes of the elements are zero.
+        static Array3 createFile(const std::string& path, SizeType width, SizeType height, SizeType depth)
+        {
+            const SizeType extents[3] = { width, height, depth };
+            detail::MappedFile file = detail::createMappedArrayFile<T, LayoutT>(path, 3, extents);
+            T* data = reinterpret_cast<T*>(file.data() + detail::mappedArrayDataOffset<T>());
+            return Array3(std::move(file), data, width, height, depth);
+        }
+
+        // Maps an existing file, throws std::runtime_error if its header doesn't match T, LayoutT or the number of dimensions,
+        // or if the file is too small for the extents in the header.
+        static Array3 fromFile(const std::string& path, MappedFileAccess access = MappedFileAccess::ReadWrite)
+        {
+            detail::MappedFile file = detail::MappedFile::open(path, access);
+            const detail::MappedArrayHeader header = detail::readMappedArrayHeader<T, LayoutT>(file, 3, path);
+            const SizeType width = static_cast<SizeType>(header.extents[0]);
+            const SizeType height = static_cast<SizeType>(header.extents[1]);
+            const SizeType depth = static_cast<SizeType>(header.extents[2]);
+            T* data = detail::mappedArrayData<T>(file, header);
+            return Array3(std::move(file), data, width, height, depth);
+        }
+
+        Array3(const Array3&) = delete;
+        Array3& operator= (const Array3&) = delete;
+
+        Array3(Array3&& other) noexcept :
+            m_file(std::move(other.m_file)),
+            m_data(std::exchange(other.m_data, nullptr)),
+            m_width(std::exchange(other.m_width, 0)),
+            m_height(std::exchange(other.m_height, 0)),
+            m_depth(std::exchange(other.m_depth, 0))
+        {
+        }
+
+        Array3& operator= (Array3&& other) noexcept
+        {
+            m_file = std::move(other.m_file);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_width = std::exchange(other.m_width, 0);
+            m_height = std::exchange(other.m_height, 0);
+            m_depth = std::exchange(other.m_depth, 0);
+
+            return *this;
+        }
+
+        const T& operator() (SizeType x, SizeType y, SizeType z) const
+        {
+            return m_data[index(x, y, z)];
+        }
+        T& operator() (SizeType x, SizeType y, SizeType z)
+        {
+            return m_data[index(x, y, z)];
+        }
+        const T& at(SizeType x, SizeType y, SizeType z) const
+        {
+            return m_data[index(x, y, z)];
+        }
+        T& at(SizeType x, SizeType y, SizeType z)
+        {
+            return m_data[index(x, y, z)];
+        }
+
+        const T* data() const
+        {
+            return m_data;
+        }
+        T* data()
+        {
+            return m_data;
+        }
+
+        bool isEmpty() const
+        {
+            return m_data == nullptr;
+        }
+
+        iterator begin()
+        {
+            return iteratorAt<T>(m_data, 0);
+        }
+
+        iterator end()
+        {
+            return iteratorAt<T>(m_data, storageSize());
+        }
+        const_iterator begin() const
+        {
+            return iteratorAt<const T>(m_data, 0);
+        }
+
+        const_iterator end() const
+        {
+            return iteratorAt<const T>(m_data, storageSize());
+        }
+        const_iterator cbegin() const
+        {
+            return iteratorAt<const T>(m_data, 0);
+        }
+
+        const_iterator cend() const
+        {
+            return iteratorAt<const T>(m_data, storageSize());
+        }
+
+        detail::Array3Enumerate<T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate()
+        {
+            return { m_data, m_width, m_height, m_depth };
+        }
+
+        detail::Array3Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, LayoutT> cenumerate() const
+        {
+            return { m_data, m_width, m_height, m_depth };
+        }
+
+        detail::Array3Enumerate<const T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, LayoutT> enumerate() const
+        {
+            return { m_data, m_width, m_height, m_depth };
+        }
+
+        SizeType width() const
+        {
+            return m_width;
+        }
+
+        SizeType height() const
+        {
+            return m_height;
+        }
+
+        SizeType depth() const
+        {
+            return m_depth;
+        }
+
+        SizeType size() const
+        {
+            return m_width * m_height * m_depth;
+        }
+
+        //extents of the storage, larger than the array's when the layout pads it
+        SizeType storageWidth() const
+        {
+            return LayoutT::storageExtent(m_width, 0, 3);
+        }
+
+        SizeType storageHeight() const
+        {
+            return LayoutT::storageExtent(m_height, 1, 3);
+        }
+
+        SizeType storageDepth() const
+        {
+            return LayoutT::storageExtent(m_depth, 2, 3);
+        }
+
+        SizeType storageSize() const
+        {
+            return storageWidth() * storageHeight() * storageDepth();
+        }
+
+        //distance in elements between the starts of consecutive lines along the fastest changing axis
+        template <typename L = LayoutT>
+        auto pitch() const -> decltype(L::pitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::pitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
+        //distance in elements between the starts of consecutive slices along the slowest changing axis
+        template <typename L = LayoutT>
+        auto slicePitch() const -> decltype(L::slicePitch(SizeType{}, SizeType{}, SizeType{}))
+        {
+            return LayoutT::slicePitch(storageWidth(), storageHeight(), storageDepth());
+        }
+
+        void fill(const T& value)
+        {
+            std::fill(m_data, m_data + storageSize(), value);
+        }
+
+        // Blocks until the changes are written to the file. Otherwise the OS writes them back at some later point.
+        void flush()
+        {
+            m_file.flush();
+        }
+
+        void swap(Array3& other) noexcept
+        {
+            Array3 temp(std::move(*this));
+            *this = std::move(other);
+            other = std::move(temp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, Comp comp = Comp{})
+        {
+            FloodFillScratch scratch;
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
+        template <typename Comp = std::equal_to<T>>
+        void floodFill(SizeType x, SizeType y, SizeType z, const T& value, FloodFillScratch& scratch, Comp comp = Comp{})
+        {
+            detail::floodFillArray3(*this, x, y, z, value, scratch, comp);
+        }
+
+    protected:
+        detail::MappedFile m_file;
+        T* m_data;
+        SizeType m_width;
+        SizeType m_height;
+        SizeType m_depth;
+
+        Array3(detail::MappedFile&& file, T* data, SizeType width, SizeType height, SizeType depth) noexcept :
+            m_file(std::move(file)),
+            m_data(data),
+            m_width(width),
+            m_height(height),
+            m_depth(depth)
+        {
+        }
+
+        SizeType index(SizeType x, SizeType y, SizeType z) const
+        {
+            return LayoutT::index(x, y, z, storageWidth(), storageHeight(), storageDepth());
+        }
+
+        template <typename U>
+        detail::Array3Iterator<U, LayoutT> iteratorAt(U* data, SizeType i) const
+        {
+            if constexpr (LayoutT::isDense) return data + i;
+            else return { data, i, m_width, m_height, m_depth, storageWidth(), storageHeight(), storageDepth() };
+        }
+    };
+
+    template <typename T, detail::SizeType W, detail::SizeType H, detail::SizeType D, ArrayStorageType S, typename L, typename A>
+    void swap(Array3<T, W, H, D, S, L, A>& lhs, Array3<T, W, H, D, S, L, A>& rhs) noexcept
     {
         lhs.swap(rhs);
     }
 
-    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV>
-    using AutoArray3 = Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Automatic>;
-}
+    template <typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV, typename LayoutT = ColumnMajorLayout>
+    using AutoArray3 = Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Automatic, LayoutT>;
+
+    template <typename T, typename LayoutT = ColumnMajorLayout>
+    using MappedArray3 = Array3<T, detail::dynamicExtent, detail::dynamicExtent, detail::dynamicExtent, ArrayStorageType::Mapped, LayoutT>;
 
+    namespace pmr
+    {
+        template <
+            typename T,
+            detail::SizeType WidthV = detail::dynamicExtent,
+            detail::SizeType HeightV = detail::dynamicExtent,
+            detail::SizeType DepthV = detail::dynamicExtent,
+            typename LayoutT = ColumnMajorLayout
+        >
+        using Array3 = ls::Array3<T, WidthV, HeightV, DepthV, ArrayStorageType::Dynamic, LayoutT, std::pmr::polymorphic_allocator<T>>;
+    }
+}
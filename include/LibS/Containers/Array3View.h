@@ -0,0 +1,428 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include "Array2View.h"
+#include "Array3.h"
+
+#include "Fwd.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+namespace ls
+{
+    namespace detail
+    {
+        // Walks a view line by line, axes ordered from the largest to the smallest stride.
+        // m_axes[i] is the axis (0 - x, 1 - y, 2 - z) walked by the i-th counter.
+        template <typename T>
+        struct Array3ViewIterator
+        {
+        public:
+            using SizeType = ::ls::detail::SizeType;
+            using self_type = Array3ViewIterator;
+            using value_type = std::remove_const_t<T>;
+            using reference = T&;
+            using pointer = T*;
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+
+            Array3ViewIterator() = default;
+
+            Array3ViewIterator(T* data, SizeType outer, const SizeType(&sizes)[3], const SizeType(&strides)[3], const int(&axes)[3]) :
+                m_data(data),
+                m_counters{ outer, 0, 0 },
+                m_middleSize(sizes[axes[1]]),
+                m_innerSize(sizes[axes[2]]),
+                m_strides{ strides[axes[0]], strides[axes[1]], strides[axes[2]] },
+                m_axes{ axes[0], axes[1], axes[2] }
+            {
+            }
+
+            //mutable to const conversion
+            template <typename U, typename EnableT = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+            Array3ViewIterator(const Array3ViewIterator<U>& other) :
+                m_data(other.m_data),
+                m_counters{ other.m_counters[0], other.m_counters[1], other.m_counters[2] },
+                m_middleSize(other.m_middleSize),
+                m_innerSize(other.m_innerSize),
+                m_strides{ other.m_strides[0], other.m_strides[1], other.m_strides[2] },
+                m_axes{ other.m_axes[0], other.m_axes[1], other.m_axes[2] }
+            {
+            }
+
+            self_type operator++(int)
+            {
+                self_type i = *this;
+
+                operator++();
+
+                return i;
+            }
+            self_type& operator++()
+            {
+                if (++m_counters[2] >= m_innerSize)
+                {
+                    m_counters[2] = 0;
+                    if (++m_counters[1] >= m_middleSize)
+                    {
+                        m_counters[1] = 0;
+                        ++m_counters[0];
+                    }
+                }
+
+                return *this;
+            }
+            reference operator*() const { return m_data[offset()]; }
+            pointer operator->() const { return m_data + offset(); }
+            bool operator==(const self_type& rhs) const
+            {
+                return m_counters[0] == rhs.m_counters[0]
+                    && m_counters[1] == rhs.m_counters[1]
+                    && m_counters[2] == rhs.m_counters[2];
+            }
+            bool operator!=(const self_type& rhs) const { return !operator==(rhs); }
+
+            Index3 position() const
+            {
+                SizeType pos[3];
+                pos[m_axes[0]] = m_counters[0];
+                pos[m_axes[1]] = m_counters[1];
+                pos[m_axes[2]] = m_counters[2];
+                return { pos[0], pos[1], pos[2] };
+            }
+
+        private:
+            template <typename>
+            friend struct Array3ViewIterator;
+
+            T* m_data;
+            SizeType m_counters[3];
+            SizeType m_middleSize;
+            SizeType m_innerSize;
+            SizeType m_strides[3];
+            int m_axes[3];
+
+            SizeType offset() const
+            {
+                return m_counters[0] * m_strides[0] + m_counters[1] * m_strides[1] + m_counters[2] * m_strides[2];
+            }
+        };
+
+        template <typename T>
+        struct Array3ViewEnumerate
+        {
+        public:
+            using SizeType = ::ls::detail::SizeType;
+
+            struct iterator
+            {
+            public:
+                using self_type = iterator;
+                using value_type = std::tuple<SizeType, SizeType, SizeType, T&>;
+                using reference = value_type & ;
+                using pointer = value_type * ;
+                using iterator_category = std::input_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+
+                iterator(Array3ViewIterator<T> iter) :
+                    m_iter(iter)
+                {
+                }
+                self_type operator++(int)
+                {
+                    self_type i = *this;
+
+                    operator++();
+
+                    return i;
+                }
+                self_type operator++()
+                {
+                    ++m_iter;
+
+                    return *this;
+                }
+                value_type operator*()
+                {
+                    const Index3 pos = m_iter.position();
+                    return { pos.x, pos.y, pos.z, *m_iter };
+                }
+                bool operator==(const self_type& rhs) { return m_iter == rhs.m_iter; }
+                bool operator!=(const self_type& rhs) { return m_iter != rhs.m_iter; }
+            private:
+                Array3ViewIterator<T> m_iter;
+            };
+
+            Array3ViewEnumerate(Array3ViewIterator<T> begin, Array3ViewIterator<T> end) :
+                m_begin(begin),
+                m_end(end)
+            {
+
+            }
+
+            iterator begin() const
+            {
+                return iterator(m_begin);
+            }
+
+            iterator end() const
+            {
+                return iterator(m_end);
+            }
+
+        private:
+            Array3ViewIterator<T> m_begin;
+            Array3ViewIterator<T> m_end;
+        };
+    }
+
+    // Non owning reference to a box of cells in an Array3 or in an external buffer.
+    // Cell (x, y, z) of the view is at data[x * strideX + y * strideY + z * strideZ], strides are in elements
+    // and may be larger than the distance between cells to view every n-th cell.
+    // T is const for read only views. The viewed storage must outlive the view.
+    template <typename T>
+    struct Array3View
+    {
+    public:
+        using ValueType = std::remove_const_t<T>;
+        using SizeType = detail::SizeType;
+
+        using iterator = detail::Array3ViewIterator<T>;
+        using const_iterator = detail::Array3ViewIterator<const T>;
+
+        Array3View() noexcept :
+            m_data(nullptr),
+            m_width(0),
+            m_height(0),
+            m_depth(0),
+            m_strideX(0),
+            m_strideY(0),
+            m_strideZ(0)
+        {
+
+        }
+
+        Array3View(T* data, SizeType width, SizeType height, SizeType depth, SizeType strideX, SizeType strideY, SizeType strideZ) noexcept :
+            m_data(data),
+            m_width(width),
+            m_height(height),
+            m_depth(depth),
+            m_strideX(strideX),
+            m_strideY(strideY),
+            m_strideZ(strideZ)
+        {
+
+        }
+
+        // Contiguous column major buffer, the same layout as a default Array3.
+        Array3View(T* data, SizeType width, SizeType height, SizeType depth) noexcept :
+            Array3View(data, width, height, depth, height * depth, depth, 1)
+        {
+
+        }
+
+        // Views the whole array. Only layouts made of lines can be viewed.
+        template <
+            typename ArrayT,
+            typename EnableT = std::enable_if_t<std::is_convertible<decltype(std::declval<ArrayT&>().data()), T*>::value>,
+            typename PitchT = decltype(std::declval<ArrayT&>().pitch()),
+            typename CellT = decltype(std::declval<ArrayT&>()(SizeType{}, SizeType{}, SizeType{}))
+        >
+        Array3View(ArrayT& arr) noexcept :
+            m_data(arr.data()),
+            m_width(arr.width()),
+            m_height(arr.height()),
+            m_depth(arr.depth())
+        {
+            using LayoutType = typename std::remove_const_t<ArrayT>::LayoutType;
+            const SizeType storageWidth = arr.storageWidth();
+            const SizeType storageHeight = arr.storageHeight();
+            const SizeType storageDepth = arr.storageDepth();
+            const SizeType origin = LayoutType::index(0, 0, 0, storageWidth, storageHeight, storageDepth);
+            m_strideX = LayoutType::index(1, 0, 0, storageWidth, storageHeight, storageDepth) - origin;
+            m_strideY = LayoutType::index(0, 1, 0, storageWidth, storageHeight, storageDepth) - origin;
+            m_strideZ = LayoutType::index(0, 0, 1, storageWidth, storageHeight, storageDepth) - origin;
+        }
+
+        //mutable to const conversion
+        template <typename U, typename EnableT = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+        Array3View(const Array3View<U>& other) noexcept :
+            m_data(other.data()),
+            m_width(other.width()),
+            m_height(other.height()),
+            m_depth(other.depth()),
+            m_strideX(other.strideX()),
+            m_strideY(other.strideY()),
+            m_strideZ(other.strideZ())
+        {
+
+        }
+
+        Array3View(const Array3View&) noexcept = default;
+        Array3View& operator= (const Array3View&) noexcept = default;
+
+        T& operator() (SizeType x, SizeType y, SizeType z) const
+        {
+            return m_data[x * m_strideX + y * m_strideY + z * m_strideZ];
+        }
+        T& at(SizeType x, SizeType y, SizeType z) const
+        {
+            return m_data[x * m_strideX + y * m_strideY + z * m_strideZ];
+        }
+
+        // [x, x + width) x [y, y + height) x [z, z + depth) of this view.
+        Array3View subview(SizeType x, SizeType y, SizeType z, SizeType width, SizeType height, SizeType depth) const
+        {
+            return Array3View(&at(x, y, z), width, height, depth, m_strideX, m_strideY, m_strideZ);
+        }
+
+        // Every stepX-th, stepY-th and stepZ-th cell along each axis starting at (x, y, z).
+        Array3View subview(SizeType x, SizeType y, SizeType z, SizeType width, SizeType height, SizeType depth, SizeType stepX, SizeType stepY, SizeType stepZ) const
+        {
+            return Array3View(&at(x, y, z), width, height, depth, m_strideX * stepX, m_strideY * stepY, m_strideZ * stepZ);
+        }
+
+        // 2D view of the plane z = const.
+        Array2View<T> sliceZ(SizeType z) const
+        {
+            return Array2View<T>(m_data + z * m_strideZ, m_width, m_height, m_strideX, m_strideY);
+        }
+
+        T* data() const
+        {
+            return m_data;
+        }
+
+        bool isEmpty() const
+        {
+            return m_width <= 0 || m_height <= 0 || m_depth <= 0;
+        }
+
+        iterator begin() const
+        {
+            return isEmpty() ? end() : iteratorAt(0);
+        }
+
+        iterator end() const
+        {
+            const SizeType sizes[3] = { m_width, m_height, m_depth };
+            return iteratorAt(std::max<SizeType>(sizes[iterationOrder()[0]], 0));
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        detail::Array3ViewEnumerate<T> enumerate() const
+        {
+            return { begin(), end() };
+        }
+
+        detail::Array3ViewEnumerate<const T> cenumerate() const
+        {
+            return { begin(), end() };
+        }
+
+        SizeType width() const
+        {
+            return m_width;
+        }
+
+        SizeType height() const
+        {
+            return m_height;
+        }
+
+        SizeType depth() const
+        {
+            return m_depth;
+        }
+
+        SizeType size() const
+        {
+            return m_width * m_height * m_depth;
+        }
+
+        SizeType strideX() const
+        {
+            return m_strideX;
+        }
+
+        SizeType strideY() const
+        {
+            return m_strideY;
+        }
+
+        SizeType strideZ() const
+        {
+            return m_strideZ;
+        }
+
+        void fill(const T& value) const
+        {
+            for (T& cell : *this)
+            {
+                cell = value;
+            }
+        }
+
+        //fill function must take x, y, z as coordinates and output a value
+        template <typename FillFunction>
+        void fill(FillFunction fillingFunction) const
+        {
+            for (auto&& [x, y, z, cell] : enumerate())
+            {
+                cell = fillingFunction(x, y, z);
+            }
+        }
+
+    private:
+        T* m_data;
+        SizeType m_width;
+        SizeType m_height;
+        SizeType m_depth;
+        SizeType m_strideX;
+        SizeType m_strideY;
+        SizeType m_strideZ;
+
+        struct IterationOrder
+        {
+            int axes[3];
+
+            const int& operator[](int i) const
+            {
+                return axes[i];
+            }
+        };
+
+        //axes from the outermost to the innermost, ties are walked in column major order
+        IterationOrder iterationOrder() const
+        {
+            const SizeType strides[3] = { std::abs(m_strideX), std::abs(m_strideY), std::abs(m_strideZ) };
+            IterationOrder order{ { 0, 1, 2 } };
+            std::stable_sort(std::begin(order.axes), std::end(order.axes), [&strides](int lhs, int rhs) { return strides[lhs] > strides[rhs]; });
+            return order;
+        }
+
+        iterator iteratorAt(SizeType outer) const
+        {
+            const SizeType sizes[3] = { m_width, m_height, m_depth };
+            const SizeType strides[3] = { m_strideX, m_strideY, m_strideZ };
+            return iterator(m_data, outer, sizes, strides, iterationOrder().axes);
+        }
+    };
+
+    template <typename ArrayT>
+    Array3View(ArrayT&) -> Array3View<std::conditional_t<std::is_const<ArrayT>::value, const typename ArrayT::ValueType, typename ArrayT::ValueType>>;
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ls
+{
+    namespace detail
+    {
+        // Owning, fixed size buffer of value initialized elements allocated with AllocatorT.
+        // Storage of dynamic Array2/Array3, behaves like std::unique_ptr<T[]> that remembers its size.
+        template <typename T, typename AllocatorT>
+        struct ArrayBuffer : private AllocatorT
+        {
+        public:
+            using AllocatorType = AllocatorT;
+            using SizeType = ::ls::detail::SizeType;
+
+        private:
+            using AllocatorTraits = std::allocator_traits<AllocatorT>;
+
+            static_assert(std::is_same<typename AllocatorTraits::value_type, T>::value, "Allocator value type must match the element type.");
+
+        public:
+            ArrayBuffer() noexcept(noexcept(AllocatorT())) :
+                AllocatorT(),
+                m_ptr(nullptr),
+                m_size(0)
+            {
+
+            }
+
+            explicit ArrayBuffer(const AllocatorT& alloc) noexcept :
+                AllocatorT(alloc),
+                m_ptr(nullptr),
+                m_size(0)
+            {
+
+            }
+
+            ArrayBuffer(SizeType size, const AllocatorT& alloc) :
+                AllocatorT(alloc),
+                m_ptr(nullptr),
+                m_size(0)
+            {
+                if constexpr (std::is_trivial<T>::value)
+                {
+                    //there is nothing for the allocator to construct, zeroing the whole block is much faster
+                    allocateUninitialized(size);
+                    if (m_ptr != nullptr) std::memset(static_cast<void*>(m_ptr), 0, static_cast<std::size_t>(size) * sizeof(T));
+                }
+                else
+                {
+                    allocateAndConstruct(size, [](T* ptr, AllocatorT& a) { AllocatorTraits::construct(a, ptr); });
+                }
+            }
+
+            ArrayBuffer(SizeType size, const T& value, const AllocatorT& alloc) :
+                AllocatorT(alloc),
+                m_ptr(nullptr),
+                m_size(0)
+            {
+                allocateAndConstruct(size, [&value](T* ptr, AllocatorT& a) { AllocatorTraits::construct(a, ptr, value); });
+            }
+
+            ArrayBuffer(const ArrayBuffer& other) :
+                AllocatorT(AllocatorTraits::select_on_container_copy_construction(other.allocator())),
+                m_ptr(nullptr),
+                m_size(0)
+            {
+                copyFrom(other);
+            }
+
+            ArrayBuffer(const ArrayBuffer& other, const AllocatorT& alloc) :
+                AllocatorT(alloc),
+                m_ptr(nullptr),
+                m_size(0)
+            {
+                copyFrom(other);
+            }
+
+            ArrayBuffer(ArrayBuffer&& other) noexcept :
+                AllocatorT(std::move(other.allocator())),
+                m_ptr(std::exchange(other.m_ptr, nullptr)),
+                m_size(std::exchange(other.m_size, 0))
+            {
+
+            }
+
+            ~ArrayBuffer()
+            {
+                release();
+            }
+
+            // Elements are only moved one by one when the allocators differ and don't propagate.
+            ArrayBuffer& operator=(ArrayBuffer&& other) noexcept(
+                AllocatorTraits::propagate_on_container_move_assignment::value
+                || AllocatorTraits::is_always_equal::value)
+            {
+                if (this == &other) return *this;
+
+                release();
+
+                if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+                {
+                    allocator() = std::move(other.allocator());
+                }
+                else if (!(allocator() == other.allocator()))
+                {
+                    T* src = other.m_ptr;
+                    allocateAndConstruct(other.m_size, [&src](T* ptr, AllocatorT& a) { AllocatorTraits::construct(a, ptr, std::move(*src++)); });
+                    other.release();
+                    return *this;
+                }
+
+                m_ptr = std::exchange(other.m_ptr, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+
+                return *this;
+            }
+
+            ArrayBuffer& operator=(const ArrayBuffer& other)
+            {
+                if (this == &other) return *this;
+
+                if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value)
+                {
+                    release();
+                    allocator() = other.allocator();
+                }
+
+                ArrayBuffer copy(allocator());
+                copy.copyFrom(other);
+                release();
+                m_ptr = std::exchange(copy.m_ptr, nullptr);
+                m_size = std::exchange(copy.m_size, 0);
+
+                return *this;
+            }
+
+            const T& operator[](SizeType i) const
+            {
+                return m_ptr[i];
+            }
+            T& operator[](SizeType i)
+            {
+                return m_ptr[i];
+            }
+
+            const T* get() const
+            {
+                return m_ptr;
+            }
+            T* get()
+            {
+                return m_ptr;
+            }
+
+            SizeType size() const
+            {
+                return m_size;
+            }
+
+            const AllocatorT& allocator() const
+            {
+                return *this;
+            }
+            AllocatorT& allocator()
+            {
+                return *this;
+            }
+
+        private:
+            T* m_ptr;
+            SizeType m_size;
+
+            void allocateUninitialized(SizeType size)
+            {
+                if (size == 0) return;
+
+                m_ptr = AllocatorTraits::allocate(allocator(), static_cast<std::size_t>(size));
+                m_size = size;
+            }
+
+            void copyFrom(const ArrayBuffer& other)
+            {
+                if constexpr (std::is_trivially_copyable<T>::value && std::is_trivially_default_constructible<T>::value)
+                {
+                    allocateUninitialized(other.m_size);
+                    if (m_ptr != nullptr) std::memcpy(static_cast<void*>(m_ptr), other.m_ptr, static_cast<std::size_t>(other.m_size) * sizeof(T));
+                }
+                else
+                {
+                    const T* src = other.m_ptr;
+                    allocateAndConstruct(other.m_size, [&src](T* ptr, AllocatorT& a) { AllocatorTraits::construct(a, ptr, *src++); });
+                }
+            }
+
+            template <typename ConstructFuncT>
+            void allocateAndConstruct(SizeType size, ConstructFuncT&& construct)
+            {
+                if (size == 0) return;
+
+                AllocatorT& alloc = allocator();
+                T* ptr = AllocatorTraits::allocate(alloc, static_cast<std::size_t>(size));
+                SizeType numConstructed = 0;
+                try
+                {
+                    for (; numConstructed < size; ++numConstructed)
+                    {
+                        construct(ptr + numConstructed, alloc);
+                    }
+                }
+                catch (...)
+                {
+                    destroy(ptr, numConstructed);
+                    AllocatorTraits::deallocate(alloc, ptr, static_cast<std::size_t>(size));
+                    throw;
+                }
+
+                m_ptr = ptr;
+                m_size = size;
+            }
+
+            void destroy(T* ptr, SizeType count)
+            {
+                if constexpr (!std::is_trivially_destructible<T>::value)
+                {
+                    for (SizeType i = 0; i < count; ++i)
+                    {
+                        AllocatorTraits::destroy(allocator(), ptr + i);
+                    }
+                }
+            }
+
+            void release() noexcept
+            {
+                if (m_ptr == nullptr) return;
+
+                destroy(m_ptr, m_size);
+                AllocatorTraits::deallocate(allocator(), m_ptr, static_cast<std::size_t>(m_size));
+                m_ptr = nullptr;
+                m_size = 0;
+            }
+        };
+    }
+}
@@ -0,0 +1,323 @@
+#pragma once
+
+#include "LibS/Detail.h"
+#include "LibS/ThreadPool.h"
+
+#include "Array2.h"
+#include "Array3.h"
+
+#include "Fwd.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace ls
+{
+    // Union-find forest and component ids used by labelConnectedComponents.
+    // Both hold one entry per cell, reusing one scratch between calls avoids reallocating them.
+    struct ConnectedComponentsScratch
+    {
+    public:
+        using SizeType = detail::SizeType;
+
+        ConnectedComponentsScratch() = default;
+
+        void clear()
+        {
+            m_parents.clear();
+            m_componentIds.clear();
+        }
+
+        void shrinkToFit()
+        {
+            m_parents.shrink_to_fit();
+            m_componentIds.shrink_to_fit();
+        }
+
+        std::vector<SizeType>& parents()
+        {
+            return m_parents;
+        }
+
+        std::vector<SizeType>& componentIds()
+        {
+            return m_componentIds;
+        }
+
+    private:
+        std::vector<SizeType> m_parents;
+        std::vector<SizeType> m_componentIds;
+    };
+
+    namespace detail
+    {
+        //roots are always the smallest index in their set, so parents[i] <= i
+        inline SizeType findComponentRoot(std::vector<SizeType>& parents, SizeType i)
+        {
+            while (parents[i] != i)
+            {
+                parents[i] = parents[parents[i]];
+                i = parents[i];
+            }
+            return i;
+        }
+
+        //no path compression, safe to call concurrently as long as nothing modifies parents
+        inline SizeType findComponentRootConst(const std::vector<SizeType>& parents, SizeType i)
+        {
+            while (parents[i] != i)
+            {
+                i = parents[i];
+            }
+            return i;
+        }
+
+        inline void uniteComponents(std::vector<SizeType>& parents, SizeType a, SizeType b)
+        {
+            a = findComponentRoot(parents, a);
+            b = findComponentRoot(parents, b);
+            if (a < b) parents[b] = a;
+            else if (b < a) parents[a] = b;
+        }
+
+        // Labels face connected components of cells equal under comp.
+        // Cells are grouped into lines along the last axis, the same spans the flood fill works on.
+        // Cell (line, s) has index lineIndex * spanExtent + s where lineIndex = line[0] * lineExtents[1] + line[1].
+        // The array is split into slabs along the first axis. Each slab is labeled by a separate task,
+        // linking runs of equal cells with runs on the preceding lines. Then the slab boundaries are merged
+        // and every cell gets the consecutive id of its root.
+        // cellAt(line, s) returns the cell, setLabel(line, s, id) stores the component id. Returns the number of components.
+        template <typename CellFuncT, typename LabelFuncT, typename Comp>
+        SizeType labelConnectedComponentRuns(
+            ThreadPool& pool,
+            ConnectedComponentsScratch& scratch,
+            int numLineAxes,
+            const SizeType(&lineExtents)[2],
+            SizeType spanExtent,
+            CellFuncT&& cellAt,
+            LabelFuncT&& setLabel,
+            Comp& comp)
+        {
+            const SizeType numLines = lineExtents[0] * lineExtents[1];
+            const SizeType numCells = numLines * spanExtent;
+            if (numCells <= 0) return 0;
+
+            std::vector<SizeType>& parents = scratch.parents();
+            std::vector<SizeType>& componentIds = scratch.componentIds();
+            parents.resize(numCells);
+            componentIds.resize(numCells);
+
+            const SizeType lineStrides[2] = { lineExtents[1], 1 };
+            const SizeType numSlabs = std::min<SizeType>(lineExtents[0], static_cast<SizeType>(pool.numThreads()) * 4);
+            auto slabBegin = [&lineExtents, numSlabs](SizeType slab) { return lineExtents[0] * slab / numSlabs; };
+
+            //unites cells of two lines that are equal and start a run on either line
+            auto uniteLines = [&](const SizeType(&lineA)[2], SizeType lineIndexA, const SizeType(&lineB)[2], SizeType lineIndexB) {
+                bool wasUnited = false;
+                for (SizeType s = 0; s < spanExtent; ++s)
+                {
+                    const bool continuesRuns = s > 0 && comp(cellAt(lineA, s - 1), cellAt(lineA, s)) && comp(cellAt(lineB, s - 1), cellAt(lineB, s));
+                    if (!comp(cellAt(lineA, s), cellAt(lineB, s)))
+                    {
+                        wasUnited = false;
+                        continue;
+                    }
+                    if (!(wasUnited && continuesRuns))
+                    {
+                        uniteComponents(parents, lineIndexA * spanExtent + s, lineIndexB * spanExtent + s);
+                    }
+                    wasUnited = true;
+                }
+            };
+
+            pool.parallelFor(0, numSlabs, [&](SizeType slab) {
+                const SizeType first = slabBegin(slab);
+                const SizeType last = slabBegin(slab + 1);
+                for (SizeType line0 = first; line0 < last; ++line0)
+                {
+                    for (SizeType line1 = 0; line1 < lineExtents[1]; ++line1)
+                    {
+                        const SizeType line[2] = { line0, line1 };
+                        const SizeType lineIndex = line0 * lineStrides[0] + line1;
+                        const SizeType lineStart = lineIndex * spanExtent;
+
+                        SizeType runStart = lineStart;
+                        for (SizeType s = 0; s < spanExtent; ++s)
+                        {
+                            if (s > 0 && !comp(cellAt(line, s - 1), cellAt(line, s))) runStart = lineStart + s;
+                            parents[lineStart + s] = runStart;
+                        }
+
+                        for (int axis = 0; axis < numLineAxes; ++axis)
+                        {
+                            if (line[axis] == (axis == 0 ? first : 0)) continue;
+
+                            SizeType prevLine[2] = { line0, line1 };
+                            --prevLine[axis];
+                            uniteLines(line, lineIndex, prevLine, lineIndex - lineStrides[axis]);
+                        }
+                    }
+                }
+            });
+
+            for (SizeType slab = 1; slab < numSlabs; ++slab)
+            {
+                const SizeType line0 = slabBegin(slab);
+                for (SizeType line1 = 0; line1 < lineExtents[1]; ++line1)
+                {
+                    const SizeType line[2] = { line0, line1 };
+                    const SizeType prevLine[2] = { line0 - 1, line1 };
+                    const SizeType lineIndex = line0 * lineStrides[0] + line1;
+                    uniteLines(line, lineIndex, prevLine, lineIndex - lineStrides[0]);
+                }
+            }
+
+            std::vector<SizeType> slabComponentOffsets(numSlabs + 1, 0);
+            auto forEachSlabCell = [&](SizeType slab, auto&& func) {
+                const SizeType cellsBegin = slabBegin(slab) * lineStrides[0] * spanExtent;
+                const SizeType cellsEnd = slabBegin(slab + 1) * lineStrides[0] * spanExtent;
+                for (SizeType i = cellsBegin; i < cellsEnd; ++i)
+                {
+                    func(i);
+                }
+            };
+            pool.parallelFor(0, numSlabs, [&](SizeType slab) {
+                SizeType numRoots = 0;
+                forEachSlabCell(slab, [&](SizeType i) {
+                    if (parents[i] == i) ++numRoots;
+                });
+                slabComponentOffsets[slab + 1] = numRoots;
+            });
+            for (SizeType slab = 0; slab < numSlabs; ++slab)
+            {
+                slabComponentOffsets[slab + 1] += slabComponentOffsets[slab];
+            }
+
+            pool.parallelFor(0, numSlabs, [&](SizeType slab) {
+                SizeType id = slabComponentOffsets[slab];
+                forEachSlabCell(slab, [&](SizeType i) {
+                    if (parents[i] == i) componentIds[i] = id++;
+                });
+            });
+
+            pool.parallelFor(0, numSlabs, [&](SizeType slab) {
+                const SizeType first = slabBegin(slab);
+                const SizeType last = slabBegin(slab + 1);
+                for (SizeType line0 = first; line0 < last; ++line0)
+                {
+                    for (SizeType line1 = 0; line1 < lineExtents[1]; ++line1)
+                    {
+                        const SizeType line[2] = { line0, line1 };
+                        const SizeType lineStart = (line0 * lineStrides[0] + line1) * spanExtent;
+                        for (SizeType s = 0; s < spanExtent; ++s)
+                        {
+                            setLabel(line, s, componentIds[findComponentRootConst(parents, lineStart + s)]);
+                        }
+                    }
+                }
+            });
+
+            return slabComponentOffsets[numSlabs];
+        }
+    }
+
+    // Assigns every cell the id of its face connected component of cells equal under comp (4 neighbours).
+    // Ids are consecutive, starting from 0, in the order of the components' first cells in column major order.
+    // labels must have the size of arr. Returns the number of components.
+    template <
+        typename T, detail::SizeType WidthV, detail::SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT,
+        typename LabelT, ArrayStorageType LabelStorageV, typename LabelLayoutT, typename LabelAllocatorT,
+        typename Comp = std::equal_to<T>
+    >
+    detail::SizeType labelConnectedComponents(
+        const Array2<T, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& arr,
+        Array2<LabelT, WidthV, HeightV, LabelStorageV, LabelLayoutT, LabelAllocatorT>& labels,
+        ThreadPool& pool,
+        ConnectedComponentsScratch& scratch,
+        Comp comp = Comp{})
+    {
+        using SizeType = detail::SizeType;
+
+        if (labels.width() != arr.width() || labels.height() != arr.height())
+        {
+            throw std::runtime_error("Label array must have the same size as the labeled array.");
+        }
+
+        const SizeType lineExtents[2] = { arr.width(), 1 };
+        return detail::labelConnectedComponentRuns(
+            pool,
+            scratch,
+            1,
+            lineExtents,
+            arr.height(),
+            [&arr](const SizeType(&line)[2], SizeType s) -> const T& { return arr.at(line[0], s); },
+            [&labels](const SizeType(&line)[2], SizeType s, SizeType id) { labels.at(line[0], s) = static_cast<LabelT>(id); },
+            comp
+        );
+    }
+
+    template <
+        typename T, detail::SizeType WidthV, detail::SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT,
+        typename LabelT, ArrayStorageType LabelStorageV, typename LabelLayoutT, typename LabelAllocatorT,
+        typename Comp = std::equal_to<T>
+    >
+    detail::SizeType labelConnectedComponents(
+        const Array2<T, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& arr,
+        Array2<LabelT, WidthV, HeightV, LabelStorageV, LabelLayoutT, LabelAllocatorT>& labels,
+        ThreadPool& pool,
+        Comp comp = Comp{})
+    {
+        ConnectedComponentsScratch scratch;
+        return labelConnectedComponents(arr, labels, pool, scratch, comp);
+    }
+
+    // 3D version, 6 neighbours.
+    template <
+        typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT,
+        typename LabelT, ArrayStorageType LabelStorageV, typename LabelLayoutT, typename LabelAllocatorT,
+        typename Comp = std::equal_to<T>
+    >
+    detail::SizeType labelConnectedComponents(
+        const Array3<T, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& arr,
+        Array3<LabelT, WidthV, HeightV, DepthV, LabelStorageV, LabelLayoutT, LabelAllocatorT>& labels,
+        ThreadPool& pool,
+        ConnectedComponentsScratch& scratch,
+        Comp comp = Comp{})
+    {
+        using SizeType = detail::SizeType;
+
+        if (labels.width() != arr.width() || labels.height() != arr.height() || labels.depth() != arr.depth())
+        {
+            throw std::runtime_error("Label array must have the same size as the labeled array.");
+        }
+
+        const SizeType lineExtents[2] = { arr.width(), arr.height() };
+        return detail::labelConnectedComponentRuns(
+            pool,
+            scratch,
+            2,
+            lineExtents,
+            arr.depth(),
+            [&arr](const SizeType(&line)[2], SizeType s) -> const T& { return arr.at(line[0], line[1], s); },
+            [&labels](const SizeType(&line)[2], SizeType s, SizeType id) { labels.at(line[0], line[1], s) = static_cast<LabelT>(id); },
+            comp
+        );
+    }
+
+    template <
+        typename T, detail::SizeType WidthV, detail::SizeType HeightV, detail::SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT,
+        typename LabelT, ArrayStorageType LabelStorageV, typename LabelLayoutT, typename LabelAllocatorT,
+        typename Comp = std::equal_to<T>
+    >
+    detail::SizeType labelConnectedComponents(
+        const Array3<T, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& arr,
+        Array3<LabelT, WidthV, HeightV, DepthV, LabelStorageV, LabelLayoutT, LabelAllocatorT>& labels,
+        ThreadPool& pool,
+        Comp comp = Comp{})
+    {
+        ConnectedComponentsScratch scratch;
+        return labelConnectedComponents(arr, labels, pool, scratch, comp);
+    }
+}
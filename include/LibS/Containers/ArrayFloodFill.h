@@ -0,0 +1,165 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include <vector>
+
+namespace ls
+{
+    namespace detail
+    {
+        //cells [begin, end) of the line at line[0] (2D) or at (line[0], line[1]) (3D),
+        //lines run along the last axis, which is contiguous in the default layout
+        struct FloodFillSpan
+        {
+            SizeType line[2];
+            SizeType begin;
+            SizeType end;
+        };
+    }
+
+    // Span stack of the scanline flood fill.
+    // Reusing one scratch between fills avoids reallocating the stack every call.
+    struct FloodFillScratch
+    {
+    public:
+        using SizeType = detail::SizeType;
+
+        FloodFillScratch() = default;
+
+        void reserve(SizeType numSpans)
+        {
+            m_spans.reserve(numSpans);
+        }
+
+        void clear()
+        {
+            m_spans.clear();
+        }
+
+        void shrinkToFit()
+        {
+            m_spans.shrink_to_fit();
+        }
+
+        std::vector<detail::FloodFillSpan>& spans()
+        {
+            return m_spans;
+        }
+
+    private:
+        std::vector<detail::FloodFillSpan> m_spans;
+    };
+
+    namespace detail
+    {
+        // Scanline fill of the region connected (through faces) to seed.
+        // Each popped span is scanned for runs of cells that are inside; every run is extended to its full length,
+        // filled at once and the ranges it covers on the neighbouring lines are pushed.
+        // isInside(line, s) must return false for already filled cells.
+        template <typename InsideFuncT, typename FillFuncT>
+        void floodFillSpans(
+            std::vector<FloodFillSpan>& spans,
+            int numLineAxes,
+            const SizeType(&lineExtents)[2],
+            SizeType spanExtent,
+            const FloodFillSpan& seed,
+            InsideFuncT&& isInside,
+            FillFuncT&& fillSpan)
+        {
+            spans.clear();
+            spans.push_back(seed);
+
+            while (!spans.empty())
+            {
+                const FloodFillSpan span = spans.back();
+                spans.pop_back();
+
+                SizeType s = span.begin;
+                while (s < span.end)
+                {
+                    if (!isInside(span.line, s))
+                    {
+                        ++s;
+                        continue;
+                    }
+
+                    SizeType runBegin = s;
+                    if (s == span.begin)
+                    {
+                        while (runBegin > 0 && isInside(span.line, runBegin - 1)) --runBegin;
+                    }
+                    SizeType runEnd = s + 1;
+                    while (runEnd < spanExtent && isInside(span.line, runEnd)) ++runEnd;
+
+                    fillSpan(span.line, runBegin, runEnd);
+
+                    for (int axis = 0; axis < numLineAxes; ++axis)
+                    {
+                        if (span.line[axis] > 0)
+                        {
+                            FloodFillSpan next{ { span.line[0], span.line[1] }, runBegin, runEnd };
+                            --next.line[axis];
+                            spans.push_back(next);
+                        }
+                        if (span.line[axis] < lineExtents[axis] - 1)
+                        {
+                            FloodFillSpan next{ { span.line[0], span.line[1] }, runBegin, runEnd };
+                            ++next.line[axis];
+                            spans.push_back(next);
+                        }
+                    }
+
+                    //cell at runEnd is either outside or past the line
+                    s = runEnd + 1;
+                }
+            }
+        }
+
+        template <typename ArrayT, typename T, typename Comp>
+        void floodFillArray2(ArrayT& arr, SizeType x, SizeType y, const T& value, FloodFillScratch& scratch, Comp& comp)
+        {
+            const T initialCell = arr.at(x, y);
+            if (comp(value, initialCell)) return;
+
+            const SizeType lineExtents[2] = { arr.width(), 1 };
+            floodFillSpans(
+                scratch.spans(),
+                1,
+                lineExtents,
+                arr.height(),
+                FloodFillSpan{ { x, 0 }, y, y + 1 },
+                [&arr, &value, &initialCell, &comp](const SizeType(&line)[2], SizeType s) {
+                    const T& cell = arr.at(line[0], s);
+                    return comp(cell, initialCell) && !comp(value, cell);
+                },
+                [&arr, &value](const SizeType(&line)[2], SizeType begin, SizeType end) {
+                    for (SizeType s = begin; s < end; ++s) arr.at(line[0], s) = value;
+                }
+            );
+        }
+
+        template <typename ArrayT, typename T, typename Comp>
+        void floodFillArray3(ArrayT& arr, SizeType x, SizeType y, SizeType z, const T& value, FloodFillScratch& scratch, Comp& comp)
+        {
+            const T initialCell = arr.at(x, y, z);
+            if (comp(value, initialCell)) return;
+
+            const SizeType lineExtents[2] = { arr.width(), arr.height() };
+            floodFillSpans(
+                scratch.spans(),
+                2,
+                lineExtents,
+                arr.depth(),
+                FloodFillSpan{ { x, y }, z, z + 1 },
+                [&arr, &value, &initialCell, &comp](const SizeType(&line)[2], SizeType s) {
+                    const T& cell = arr.at(line[0], line[1], s);
+                    return comp(cell, initialCell) && !comp(value, cell);
+                },
+                [&arr, &value](const SizeType(&line)[2], SizeType begin, SizeType end) {
+                    for (SizeType s = begin; s < end; ++s) arr.at(line[0], line[1], s) = value;
+                }
+            );
+        }
+    }
+}
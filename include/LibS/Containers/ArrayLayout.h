@@ -0,0 +1,460 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace ls
+{
+    namespace detail
+    {
+        struct Index2
+        {
+            using SizeType = ::ls::detail::SizeType;
+
+            SizeType x, y;
+        };
+
+        struct Index3
+        {
+            using SizeType = ::ls::detail::SizeType;
+
+            SizeType x, y, z;
+        };
+
+        // spreads the lower 16 bits so that there is one zero bit between each of them
+        constexpr std::uint32_t mortonSpread2(std::uint32_t v)
+        {
+            v &= 0x0000FFFFu;
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        }
+
+        constexpr std::uint32_t mortonCompact2(std::uint32_t v)
+        {
+            v &= 0x55555555u;
+            v = (v | (v >> 1)) & 0x33333333u;
+            v = (v | (v >> 2)) & 0x0F0F0F0Fu;
+            v = (v | (v >> 4)) & 0x00FF00FFu;
+            v = (v | (v >> 8)) & 0x0000FFFFu;
+            return v;
+        }
+
+        // spreads the lower 10 bits so that there are two zero bits between each of them
+        constexpr std::uint32_t mortonSpread3(std::uint32_t v)
+        {
+            v &= 0x000003FFu;
+            v = (v | (v << 16)) & 0xFF0000FFu;
+            v = (v | (v << 8)) & 0x0300F00Fu;
+            v = (v | (v << 4)) & 0x030C30C3u;
+            v = (v | (v << 2)) & 0x09249249u;
+            return v;
+        }
+
+        constexpr std::uint32_t mortonCompact3(std::uint32_t v)
+        {
+            v &= 0x09249249u;
+            v = (v | (v >> 2)) & 0x030C30C3u;
+            v = (v | (v >> 4)) & 0x0300F00Fu;
+            v = (v | (v >> 8)) & 0xFF0000FFu;
+            v = (v | (v >> 16)) & 0x000003FFu;
+            return v;
+        }
+    }
+
+    // Layouts decide where in the storage each cell of an Array2/Array3 lives.
+    // storageExtent - extent of the storage along an axis (0 - x, 1 - y, 2 - z), larger than the array's when the layout needs padding
+    // index - offset of a cell in the storage, given the storage extents
+    // next - advances an offset and position to the next cell in storage order, skipping padding
+    // isDense - whether the storage holds only cells, then plain pointers are used as iterators
+    // isRowMajor - whether x is the fastest changing coordinate, so loops over cells should have x innermost
+    // Layouts made of contiguous lines also provide pitch (and slicePitch in 3D),
+    // the distance in elements between the starts of consecutive lines (and slices).
+
+    // x is the slowest changing coordinate, consecutive cells of a column (or of a z-column in 3D) are adjacent.
+    // Columns are padded to a multiple of PitchMultipleV elements, so with an aligned allocator and
+    // PitchMultipleV * sizeof(T) being a multiple of the alignment every column starts aligned.
+    template <detail::SizeType PitchMultipleV>
+    struct PaddedColumnMajorLayout
+    {
+        static_assert(PitchMultipleV > 0, "Pitch multiple must be positive.");
+
+        using SizeType = detail::SizeType;
+
+        static constexpr bool isDense = PitchMultipleV == 1;
+        static constexpr bool isRowMajor = false;
+
+        static constexpr SizeType storageExtent(SizeType extent, int axis, int numAxes)
+        {
+            return axis == numAxes - 1 ? (extent + PitchMultipleV - 1) / PitchMultipleV * PitchMultipleV : extent;
+        }
+
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType /* storageWidth */, SizeType storageHeight)
+        {
+            return x * storageHeight + y;
+        }
+
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType z, SizeType /* storageWidth */, SizeType storageHeight, SizeType storageDepth)
+        {
+            return (x * storageHeight + y) * storageDepth + z;
+        }
+
+        static constexpr SizeType pitch(SizeType /* storageWidth */, SizeType storageHeight)
+        {
+            return storageHeight;
+        }
+
+        static constexpr SizeType pitch(SizeType /* storageWidth */, SizeType /* storageHeight */, SizeType storageDepth)
+        {
+            return storageDepth;
+        }
+
+        static constexpr SizeType slicePitch(SizeType /* storageWidth */, SizeType storageHeight, SizeType storageDepth)
+        {
+            return storageHeight * storageDepth;
+        }
+
+        static constexpr void next(SizeType& index, detail::Index2& pos, SizeType /* width */, SizeType height, SizeType /* storageWidth */, SizeType storageHeight)
+        {
+            ++index;
+            if (++pos.y >= height)
+            {
+                index += storageHeight - height;
+                pos.y = 0;
+                ++pos.x;
+            }
+        }
+
+        static constexpr void next(SizeType& index, detail::Index3& pos, SizeType /* width */, SizeType height, SizeType depth, SizeType /* storageWidth */, SizeType /* storageHeight */, SizeType storageDepth)
+        {
+            ++index;
+            if (++pos.z >= depth)
+            {
+                index += storageDepth - depth;
+                pos.z = 0;
+                if (++pos.y >= height)
+                {
+                    pos.y = 0;
+                    ++pos.x;
+                }
+            }
+        }
+    };
+
+    // x is the fastest changing coordinate, rows are contiguous like in most image formats.
+    // Rows are padded to a multiple of PitchMultipleV elements.
+    template <detail::SizeType PitchMultipleV>
+    struct PaddedRowMajorLayout
+    {
+        static_assert(PitchMultipleV > 0, "Pitch multiple must be positive.");
+
+        using SizeType = detail::SizeType;
+
+        static constexpr bool isDense = PitchMultipleV == 1;
+        static constexpr bool isRowMajor = true;
+
+        static constexpr SizeType storageExtent(SizeType extent, int axis, int /* numAxes */)
+        {
+            return axis == 0 ? (extent + PitchMultipleV - 1) / PitchMultipleV * PitchMultipleV : extent;
+        }
+
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType storageWidth, SizeType /* storageHeight */)
+        {
+            return y * storageWidth + x;
+        }
+
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType z, SizeType storageWidth, SizeType storageHeight, SizeType /* storageDepth */)
+        {
+            return (z * storageHeight + y) * storageWidth + x;
+        }
+
+        static constexpr SizeType pitch(SizeType storageWidth, SizeType /* storageHeight */)
+        {
+            return storageWidth;
+        }
+
+        static constexpr SizeType pitch(SizeType storageWidth, SizeType /* storageHeight */, SizeType /* storageDepth */)
+        {
+            return storageWidth;
+        }
+
+        static constexpr SizeType slicePitch(SizeType storageWidth, SizeType storageHeight, SizeType /* storageDepth */)
+        {
+            return storageWidth * storageHeight;
+        }
+
+        static constexpr void next(SizeType& index, detail::Index2& pos, SizeType width, SizeType /* height */, SizeType storageWidth, SizeType /* storageHeight */)
+        {
+            ++index;
+            if (++pos.x >= width)
+            {
+                index += storageWidth - width;
+                pos.x = 0;
+                ++pos.y;
+            }
+        }
+
+        static constexpr void next(SizeType& index, detail::Index3& pos, SizeType width, SizeType height, SizeType /* depth */, SizeType storageWidth, SizeType /* storageHeight */, SizeType /* storageDepth */)
+        {
+            ++index;
+            if (++pos.x >= width)
+            {
+                index += storageWidth - width;
+                pos.x = 0;
+                if (++pos.y >= height)
+                {
+                    pos.y = 0;
+                    ++pos.z;
+                }
+            }
+        }
+    };
+
+    using ColumnMajorLayout = PaddedColumnMajorLayout<1>;
+    using RowMajorLayout = PaddedRowMajorLayout<1>;
+
+    // Cells are grouped in square (cubic) tiles of TileSizeV cells along each axis,
+    // tiles are stored in column major order and cells inside a tile in Morton (Z) order.
+    // Neighbours along any axis are usually close in memory, which helps
+    // algorithms that don't scan in one direction. Extents are padded to whole tiles.
+    template <detail::SizeType TileSizeV = 8>
+    struct MortonTiledLayout
+    {
+        static_assert(TileSizeV > 0 && (TileSizeV & (TileSizeV - 1)) == 0, "Tile size must be a power of two.");
+        static_assert(TileSizeV <= 1024, "Tile size must be at most 1024.");
+
+        using SizeType = detail::SizeType;
+
+        static constexpr bool isDense = false;
+        static constexpr bool isRowMajor = false;
+        static constexpr SizeType tileSize = TileSizeV;
+
+        static constexpr SizeType storageExtent(SizeType extent, int /* axis */, int /* numAxes */)
+        {
+            return (extent + TileSizeV - 1) / TileSizeV * TileSizeV;
+        }
+
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType /* storageWidth */, SizeType storageHeight)
+        {
+            const SizeType tile = (x / TileSizeV) * (storageHeight / TileSizeV) + y / TileSizeV;
+            const SizeType inner = detail::mortonSpread2(static_cast<std::uint32_t>(x % TileSizeV)) | (detail::mortonSpread2(static_cast<std::uint32_t>(y % TileSizeV)) << 1);
+            return tile * (TileSizeV * TileSizeV) + inner;
+        }
+
+        static constexpr SizeType index(SizeType x, SizeType y, SizeType z, SizeType /* storageWidth */, SizeType storageHeight, SizeType storageDepth)
+        {
+            const SizeType tile = ((x / TileSizeV) * (storageHeight / TileSizeV) + y / TileSizeV) * (storageDepth / TileSizeV) + z / TileSizeV;
+            const SizeType inner =
+                detail::mortonSpread3(static_cast<std::uint32_t>(x % TileSizeV))
+                | (detail::mortonSpread3(static_cast<std::uint32_t>(y % TileSizeV)) << 1)
+                | (detail::mortonSpread3(static_cast<std::uint32_t>(z % TileSizeV)) << 2);
+            return tile * (TileSizeV * TileSizeV * TileSizeV) + inner;
+        }
+
+        static constexpr void next(SizeType& index, detail::Index2& pos, SizeType width, SizeType height, SizeType storageWidth, SizeType storageHeight)
+        {
+            constexpr SizeType tileArea = TileSizeV * TileSizeV;
+            const SizeType storageSize = storageWidth * storageHeight;
+            const SizeType tilesY = storageHeight / TileSizeV;
+
+            do
+            {
+                ++index;
+                const SizeType tile = index / tileArea;
+                const std::uint32_t inner = static_cast<std::uint32_t>(index % tileArea);
+                pos.x = (tile / tilesY) * TileSizeV + detail::mortonCompact2(inner);
+                pos.y = (tile % tilesY) * TileSizeV + detail::mortonCompact2(inner >> 1);
+            } while (index < storageSize && (pos.x >= width || pos.y >= height));
+        }
+
+        static constexpr void next(SizeType& index, detail::Index3& pos, SizeType width, SizeType height, SizeType depth, SizeType storageWidth, SizeType storageHeight, SizeType storageDepth)
+        {
+            constexpr SizeType tileVolume = TileSizeV * TileSizeV * TileSizeV;
+            const SizeType storageSize = storageWidth * storageHeight * storageDepth;
+            const SizeType tilesY = storageHeight / TileSizeV;
+            const SizeType tilesZ = storageDepth / TileSizeV;
+
+            do
+            {
+                ++index;
+                const SizeType tile = index / tileVolume;
+                const std::uint32_t inner = static_cast<std::uint32_t>(index % tileVolume);
+                pos.x = (tile / (tilesY * tilesZ)) * TileSizeV + detail::mortonCompact3(inner);
+                pos.y = ((tile / tilesZ) % tilesY) * TileSizeV + detail::mortonCompact3(inner >> 1);
+                pos.z = (tile % tilesZ) * TileSizeV + detail::mortonCompact3(inner >> 2);
+            } while (index < storageSize && (pos.x >= width || pos.y >= height || pos.z >= depth));
+        }
+    };
+
+    namespace detail
+    {
+        // Iterates the cells of an array with a layout that has padding, in storage order.
+        template <typename T, typename LayoutT>
+        struct Array2LayoutIterator
+        {
+        public:
+            using SizeType = ::ls::detail::SizeType;
+            using self_type = Array2LayoutIterator;
+            using value_type = std::remove_const_t<T>;
+            using reference = T&;
+            using pointer = T*;
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+
+            Array2LayoutIterator() = default;
+
+            Array2LayoutIterator(T* data, SizeType index, SizeType width, SizeType height, SizeType storageWidth, SizeType storageHeight) :
+                m_data(data),
+                m_index(index),
+                m_pos{ 0, 0 },
+                m_width(width),
+                m_height(height),
+                m_storageWidth(storageWidth),
+                m_storageHeight(storageHeight)
+            {
+            }
+
+            //mutable to const conversion
+            template <typename U, typename EnableT = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+            Array2LayoutIterator(const Array2LayoutIterator<U, LayoutT>& other) :
+                m_data(other.m_data),
+                m_index(other.m_index),
+                m_pos(other.m_pos),
+                m_width(other.m_width),
+                m_height(other.m_height),
+                m_storageWidth(other.m_storageWidth),
+                m_storageHeight(other.m_storageHeight)
+            {
+            }
+
+            self_type operator++(int)
+            {
+                self_type i = *this;
+
+                operator++();
+
+                return i;
+            }
+            self_type& operator++()
+            {
+                LayoutT::next(m_index, m_pos, m_width, m_height, m_storageWidth, m_storageHeight);
+
+                return *this;
+            }
+            reference operator*() const { return m_data[m_index]; }
+            pointer operator->() const { return m_data + m_index; }
+            bool operator==(const self_type& rhs) const { return m_index == rhs.m_index; }
+            bool operator!=(const self_type& rhs) const { return m_index != rhs.m_index; }
+
+            const Index2& position() const
+            {
+                return m_pos;
+            }
+
+        private:
+            template <typename, typename>
+            friend struct Array2LayoutIterator;
+
+            T* m_data;
+            SizeType m_index;
+            Index2 m_pos;
+            SizeType m_width;
+            SizeType m_height;
+            SizeType m_storageWidth;
+            SizeType m_storageHeight;
+        };
+
+        template <typename T, typename LayoutT>
+        struct Array3LayoutIterator
+        {
+        public:
+            using SizeType = ::ls::detail::SizeType;
+            using self_type = Array3LayoutIterator;
+            using value_type = std::remove_const_t<T>;
+            using reference = T&;
+            using pointer = T*;
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+
+            Array3LayoutIterator() = default;
+
+            Array3LayoutIterator(T* data, SizeType index, SizeType width, SizeType height, SizeType depth, SizeType storageWidth, SizeType storageHeight, SizeType storageDepth) :
+                m_data(data),
+                m_index(index),
+                m_pos{ 0, 0, 0 },
+                m_width(width),
+                m_height(height),
+                m_depth(depth),
+                m_storageWidth(storageWidth),
+                m_storageHeight(storageHeight),
+                m_storageDepth(storageDepth)
+            {
+            }
+
+            //mutable to const conversion
+            template <typename U, typename EnableT = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+            Array3LayoutIterator(const Array3LayoutIterator<U, LayoutT>& other) :
+                m_data(other.m_data),
+                m_index(other.m_index),
+                m_pos(other.m_pos),
+                m_width(other.m_width),
+                m_height(other.m_height),
+                m_depth(other.m_depth),
+                m_storageWidth(other.m_storageWidth),
+                m_storageHeight(other.m_storageHeight),
+                m_storageDepth(other.m_storageDepth)
+            {
+            }
+
+            self_type operator++(int)
+            {
+                self_type i = *this;
+
+                operator++();
+
+                return i;
+            }
+            self_type& operator++()
+            {
+                LayoutT::next(m_index, m_pos, m_width, m_height, m_depth, m_storageWidth, m_storageHeight, m_storageDepth);
+
+                return *this;
+            }
+            reference operator*() const { return m_data[m_index]; }
+            pointer operator->() const { return m_data + m_index; }
+            bool operator==(const self_type& rhs) const { return m_index == rhs.m_index; }
+            bool operator!=(const self_type& rhs) const { return m_index != rhs.m_index; }
+
+            const Index3& position() const
+            {
+                return m_pos;
+            }
+
+        private:
+            template <typename, typename>
+            friend struct Array3LayoutIterator;
+
+            T* m_data;
+            SizeType m_index;
+            Index3 m_pos;
+            SizeType m_width;
+            SizeType m_height;
+            SizeType m_depth;
+            SizeType m_storageWidth;
+            SizeType m_storageHeight;
+            SizeType m_storageDepth;
+        };
+
+        // plain pointers for dense layouts
+        template <typename T, typename LayoutT>
+        using Array2Iterator = std::conditional_t<LayoutT::isDense, T*, Array2LayoutIterator<T, LayoutT>>;
+
+        template <typename T, typename LayoutT>
+        using Array3Iterator = std::conditional_t<LayoutT::isDense, T*, Array3LayoutIterator<T, LayoutT>>;
+    }
+}
@@ -5,6 +5,7 @@ namespace ls
     enum struct ArrayStorageType
     {
         Automatic,
-        Dynamic
+        Dynamic,
+        Mapped
     };
 }
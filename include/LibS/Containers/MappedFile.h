@@ -0,0 +1,401 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include "ArrayLayout.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32)
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+namespace ls
+{
+    enum struct MappedFileAccess
+    {
+        //changes are written back to the file
+        ReadWrite,
+
+        //the file is only read, changes stay in private copies of the touched pages
+        CopyOnWrite
+    };
+
+    // Identifies the element type of a mapped array file.
+    // Arithmetic types get a tag from their kind and size, other types have 0 and are only checked by size.
+    // Specialize for user types to have them checked too.
+    template <typename T>
+    struct MappedElementTypeTag
+    {
+        static constexpr std::uint32_t value =
+            std::is_same<T, bool>::value ? 0x100u :
+            std::is_floating_point<T>::value ? 0x200u | static_cast<std::uint32_t>(sizeof(T)) :
+            std::is_integral<T>::value && std::is_signed<T>::value ? 0x300u | static_cast<std::uint32_t>(sizeof(T)) :
+            std::is_integral<T>::value ? 0x400u | static_cast<std::uint32_t>(sizeof(T)) :
+            0u;
+    };
+
+    // Identifies the layout of a mapped array file, the kind of the layout is in the upper 32 bits
+    // and its parameter in the lower ones. Other layouts have 0 and are not checked.
+    // Specialize for user layouts to have them checked too.
+    template <typename LayoutT>
+    struct MappedLayoutTag
+    {
+        static constexpr std::uint64_t value = 0u;
+    };
+
+    template <detail::SizeType PitchMultipleV>
+    struct MappedLayoutTag<PaddedColumnMajorLayout<PitchMultipleV>>
+    {
+        static constexpr std::uint64_t value = (std::uint64_t(1) << 32) | static_cast<std::uint64_t>(PitchMultipleV);
+    };
+
+    template <detail::SizeType PitchMultipleV>
+    struct MappedLayoutTag<PaddedRowMajorLayout<PitchMultipleV>>
+    {
+        static constexpr std::uint64_t value = (std::uint64_t(2) << 32) | static_cast<std::uint64_t>(PitchMultipleV);
+    };
+
+    template <detail::SizeType TileSizeV>
+    struct MappedLayoutTag<MortonTiledLayout<TileSizeV>>
+    {
+        static constexpr std::uint64_t value = (std::uint64_t(3) << 32) | static_cast<std::uint64_t>(TileSizeV);
+    };
+
+    namespace detail
+    {
+        // Whole file mapped into memory. Move only, unmaps on destruction.
+        struct MappedFile
+        {
+        public:
+            MappedFile() noexcept :
+                m_data(nullptr),
+                m_size(0)
+            {
+
+            }
+
+            // Creates (or truncates) the file with the given size, the contents are zeroed.
+            static MappedFile create(const std::string& path, std::uint64_t size)
+            {
+                if (size == 0) throw std::runtime_error("Can't map an empty file: " + path);
+
+                MappedFile file;
+#if defined(_WIN32)
+                const FileHandle handle{ CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+                if (handle.handle == INVALID_HANDLE_VALUE) throw std::runtime_error("Can't create file: " + path);
+
+                LARGE_INTEGER end;
+                end.QuadPart = static_cast<LONGLONG>(size);
+                if (!SetFilePointerEx(handle.handle, end, nullptr, FILE_BEGIN) || !SetEndOfFile(handle.handle))
+                {
+                    throw std::runtime_error("Can't resize file: " + path);
+                }
+                file.map(handle.handle, size, MappedFileAccess::ReadWrite, path);
+#else
+                const FileHandle handle{ ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+                if (handle.fd < 0) throw std::runtime_error("Can't create file: " + path);
+
+                if (::ftruncate(handle.fd, static_cast<off_t>(size)) != 0)
+                {
+                    throw std::runtime_error("Can't resize file: " + path);
+                }
+                file.map(handle.fd, size, MappedFileAccess::ReadWrite, path);
+#endif
+                return file;
+            }
+
+            static MappedFile open(const std::string& path, MappedFileAccess access)
+            {
+                MappedFile file;
+                const bool writable = access == MappedFileAccess::ReadWrite;
+#if defined(_WIN32)
+                const FileHandle handle{ CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+                if (handle.handle == INVALID_HANDLE_VALUE) throw std::runtime_error("Can't open file: " + path);
+
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(handle.handle, &size) || size.QuadPart == 0)
+                {
+                    throw std::runtime_error("Can't map an empty file: " + path);
+                }
+                file.map(handle.handle, static_cast<std::uint64_t>(size.QuadPart), access, path);
+#else
+                const FileHandle handle{ ::open(path.c_str(), writable ? O_RDWR : O_RDONLY) };
+                if (handle.fd < 0) throw std::runtime_error("Can't open file: " + path);
+
+                struct stat st;
+                if (::fstat(handle.fd, &st) != 0 || st.st_size == 0)
+                {
+                    throw std::runtime_error("Can't map an empty file: " + path);
+                }
+                file.map(handle.fd, static_cast<std::uint64_t>(st.st_size), access, path);
+#endif
+                return file;
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            MappedFile(MappedFile&& other) noexcept :
+                m_data(std::exchange(other.m_data, nullptr)),
+                m_size(std::exchange(other.m_size, 0))
+            {
+
+            }
+
+            MappedFile& operator=(MappedFile&& other) noexcept
+            {
+                if (this == &other) return *this;
+
+                unmap();
+                m_data = std::exchange(other.m_data, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+
+                return *this;
+            }
+
+            ~MappedFile()
+            {
+                unmap();
+            }
+
+            std::byte* data() const
+            {
+                return m_data;
+            }
+
+            std::uint64_t size() const
+            {
+                return m_size;
+            }
+
+            // Blocks until the changes are written to the file.
+            void flush()
+            {
+                if (m_data == nullptr) return;
+
+#if defined(_WIN32)
+                if (!FlushViewOfFile(m_data, 0)) throw std::runtime_error("Can't flush mapped file.");
+#else
+                if (::msync(m_data, static_cast<std::size_t>(m_size), MS_SYNC) != 0) throw std::runtime_error("Can't flush mapped file.");
+#endif
+            }
+
+        private:
+            std::byte* m_data;
+            std::uint64_t m_size;
+
+            // Closes the file when leaving the scope, also when mapping throws.
+            // The mapping stays valid after the file is closed.
+#if defined(_WIN32)
+            struct FileHandle
+            {
+                HANDLE handle;
+
+                explicit FileHandle(HANDLE h) noexcept :
+                    handle(h)
+                {
+
+                }
+
+                FileHandle(const FileHandle&) = delete;
+                FileHandle& operator=(const FileHandle&) = delete;
+
+                ~FileHandle()
+                {
+                    if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+                }
+            };
+#else
+            struct FileHandle
+            {
+                int fd;
+
+                explicit FileHandle(int f) noexcept :
+                    fd(f)
+                {
+
+                }
+
+                FileHandle(const FileHandle&) = delete;
+                FileHandle& operator=(const FileHandle&) = delete;
+
+                ~FileHandle()
+                {
+                    if (fd >= 0) ::close(fd);
+                }
+            };
+#endif
+
+#if defined(_WIN32)
+            void map(HANDLE handle, std::uint64_t size, MappedFileAccess access, const std::string& path)
+            {
+                const bool writable = access == MappedFileAccess::ReadWrite;
+                HANDLE mapping = CreateFileMappingA(handle, nullptr, writable ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, nullptr);
+                if (mapping == nullptr) throw std::runtime_error("Can't map file: " + path);
+
+                void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, 0);
+                //the view keeps the mapping alive
+                CloseHandle(mapping);
+                if (view == nullptr) throw std::runtime_error("Can't map file: " + path);
+
+                m_data = static_cast<std::byte*>(view);
+                m_size = size;
+            }
+#else
+            void map(int fd, std::uint64_t size, MappedFileAccess access, const std::string& path)
+            {
+                const int flags = access == MappedFileAccess::ReadWrite ? MAP_SHARED : MAP_PRIVATE;
+                void* view = ::mmap(nullptr, static_cast<std::size_t>(size), PROT_READ | PROT_WRITE, flags, fd, 0);
+                if (view == MAP_FAILED) throw std::runtime_error("Can't map file: " + path);
+
+                m_data = static_cast<std::byte*>(view);
+                m_size = size;
+            }
+#endif
+
+            void unmap() noexcept
+            {
+                if (m_data == nullptr) return;
+
+#if defined(_WIN32)
+                UnmapViewOfFile(m_data);
+#else
+                ::munmap(m_data, static_cast<std::size_t>(m_size));
+#endif
+                m_data = nullptr;
+                m_size = 0;
+            }
+        };
+
+        // Header at the start of a mapped array file, elements follow at dataOffset.
+        // Sizes are stored in the native byte order.
+        struct MappedArrayHeader
+        {
+            static constexpr char magicValue[8] = { 'L', 'S', 'A', 'R', 'R', 'A', 'Y', '\0' };
+            static constexpr std::uint32_t currentVersion = 1;
+
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t numDimensions;
+            std::uint32_t elementSize;
+            std::uint32_t elementTypeTag;
+            std::int64_t extents[3];
+            std::uint64_t dataOffset;
+            std::uint64_t layoutTag;
+        };
+
+        static_assert(sizeof(MappedArrayHeader) == 64);
+
+        template <typename T>
+        constexpr std::uint64_t mappedArrayDataOffset()
+        {
+            constexpr std::uint64_t alignment = alignof(T);
+            return (sizeof(MappedArrayHeader) + alignment - 1) / alignment * alignment;
+        }
+
+        // Number of elements in the storage of a mapped array, checked to be addressable together with the header.
+        template <typename T, typename LayoutT>
+        SizeType mappedArrayStorageSize(int numDimensions, const std::int64_t(&extents)[3], std::uint64_t dataOffset, const std::string& path)
+        {
+            constexpr std::uint64_t maxBytes = std::min<std::uint64_t>(std::numeric_limits<std::size_t>::max(), std::numeric_limits<SizeType>::max());
+            if (dataOffset > maxBytes) throw std::runtime_error("Mapped array is too large: " + path);
+
+            //single extents are limited further so that padding them can't overflow
+            const std::uint64_t maxElements = (maxBytes - dataOffset) / sizeof(T);
+            const std::uint64_t maxExtent = std::min<std::uint64_t>(maxElements, std::numeric_limits<SizeType>::max() / 2);
+
+            std::uint64_t storageSize = 1;
+            for (int i = 0; i < numDimensions; ++i)
+            {
+                if (extents[i] < 0) throw std::runtime_error("Mapped array has invalid extents: " + path);
+                if (static_cast<std::uint64_t>(extents[i]) > maxExtent) throw std::runtime_error("Mapped array is too large: " + path);
+
+                const SizeType storageExtent = LayoutT::storageExtent(static_cast<SizeType>(extents[i]), i, numDimensions);
+                if (storageExtent < extents[i]) throw std::runtime_error("Mapped array is too large: " + path);
+
+                if (storageExtent != 0 && storageSize > maxElements / static_cast<std::uint64_t>(storageExtent)) throw std::runtime_error("Mapped array is too large: " + path);
+                storageSize *= static_cast<std::uint64_t>(storageExtent);
+            }
+
+            return static_cast<SizeType>(storageSize);
+        }
+
+        // Creates the file and writes the header, extents past numDimensions are 1.
+        template <typename T, typename LayoutT>
+        MappedFile createMappedArrayFile(const std::string& path, int numDimensions, const SizeType(&extents)[3])
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be stored in a mapped file.");
+
+            MappedArrayHeader header{};
+            std::memcpy(header.magic, MappedArrayHeader::magicValue, sizeof(header.magic));
+            header.version = MappedArrayHeader::currentVersion;
+            header.numDimensions = static_cast<std::uint32_t>(numDimensions);
+            header.elementSize = static_cast<std::uint32_t>(sizeof(T));
+            header.elementTypeTag = MappedElementTypeTag<T>::value;
+            for (int i = 0; i < 3; ++i) header.extents[i] = extents[i];
+            header.dataOffset = mappedArrayDataOffset<T>();
+            header.layoutTag = MappedLayoutTag<LayoutT>::value;
+
+            const SizeType storageSize = mappedArrayStorageSize<T, LayoutT>(numDimensions, header.extents, header.dataOffset, path);
+            MappedFile file = MappedFile::create(path, header.dataOffset + static_cast<std::uint64_t>(storageSize) * sizeof(T));
+            std::memcpy(file.data(), &header, sizeof(header));
+
+            return file;
+        }
+
+        // Validates the header against T, LayoutT, numDimensions and the size of the file and returns it.
+        template <typename T, typename LayoutT>
+        MappedArrayHeader readMappedArrayHeader(const MappedFile& file, int numDimensions, const std::string& path)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be stored in a mapped file.");
+
+            MappedArrayHeader header;
+            if (file.size() < sizeof(header)) throw std::runtime_error("File is too small to be a mapped array: " + path);
+            std::memcpy(&header, file.data(), sizeof(header));
+
+            if (std::memcmp(header.magic, MappedArrayHeader::magicValue, sizeof(header.magic)) != 0) throw std::runtime_error("Not a mapped array file: " + path);
+            if (header.version != MappedArrayHeader::currentVersion) throw std::runtime_error("Unsupported mapped array version: " + path);
+            if (header.numDimensions != static_cast<std::uint32_t>(numDimensions)) throw std::runtime_error("Mapped array has a different number of dimensions: " + path);
+            if (header.elementSize != sizeof(T) || header.elementTypeTag != MappedElementTypeTag<T>::value) throw std::runtime_error("Mapped array has a different element type: " + path);
+            if (header.layoutTag != MappedLayoutTag<LayoutT>::value) throw std::runtime_error("Mapped array has a different layout: " + path);
+            if (header.dataOffset < sizeof(header) || header.dataOffset % alignof(T) != 0) throw std::runtime_error("Mapped array has an invalid data offset: " + path);
+
+            //the size itself doesn't overflow, but the offset can be anything
+            const SizeType storageSize = mappedArrayStorageSize<T, LayoutT>(numDimensions, header.extents, header.dataOffset, path);
+            if (header.dataOffset > file.size() || static_cast<std::uint64_t>(storageSize) * sizeof(T) > file.size() - header.dataOffset) throw std::runtime_error("Mapped array file is truncated: " + path);
+
+            return header;
+        }
+
+        // Elements of a file validated by readMappedArrayHeader.
+        template <typename T>
+        T* mappedArrayData(const MappedFile& file, const MappedArrayHeader& header)
+        {
+            return reinterpret_cast<T*>(file.data() + header.dataOffset);
+        }
+    }
+}
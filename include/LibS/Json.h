@@ -3,6 +3,7 @@
 #include "Json/Document.h"
 #include "Json/Value.h"
 #include "Json/Parser.h"
+#include "Json/SaxParser.h"
 #include "Json/Writer.h"
 #include "Json/Readers.h"
 #include "Json/BasicShapeReaders.h"
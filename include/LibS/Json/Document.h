@@ -4,7 +4,10 @@
 #include "Value.h"
 #include "Parser.h"
 
+#include <cstddef>
 #include <fstream>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <utility>
 
@@ -12,20 +15,73 @@ namespace ls
 {
     namespace json
     {
-        struct Document : public Value
+        enum struct DocumentAllocation
+        {
+            //every string and container is allocated and freed separately
+            PerValue,
+
+            //everything is allocated from an arena owned by the document and freed at once with it,
+            //memory of removed or replaced values is only reclaimed then
+            Arena
+        };
+
+        namespace detail
+        {
+            // Base of Document so that the arena is created before and destroyed after the values.
+            struct DocumentArena
+            {
+            public:
+                DocumentArena(DocumentAllocation allocation, std::size_t initialSize = 0) :
+                    m_arena(nullptr)
+                {
+                    if (allocation != DocumentAllocation::Arena) return;
+
+                    if (initialSize > 0) m_arena = std::make_unique<std::pmr::monotonic_buffer_resource>(initialSize);
+                    else m_arena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+                }
+
+                DocumentArena(DocumentArena&&) noexcept = default;
+                DocumentArena& operator=(DocumentArena&&) noexcept = default;
+
+                DocumentAllocation allocation() const
+                {
+                    return m_arena != nullptr ? DocumentAllocation::Arena : DocumentAllocation::PerValue;
+                }
+
+                std::pmr::memory_resource* memoryResource() const
+                {
+                    if (m_arena != nullptr) return m_arena.get();
+                    return std::pmr::get_default_resource();
+                }
+
+            protected:
+                std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
+            };
+        }
+
+        struct Document : private detail::DocumentArena, public Value
         {
         public:
             friend struct DocumentParser;
 
-            static Document fromString(const std::string& str)
+            using detail::DocumentArena::allocation;
+
+            static Document fromString(const std::string& str, DocumentAllocation allocation = DocumentAllocation::PerValue)
             {
-                return Document(str);
+                return Document(allocation, str.size(), [&str](std::pmr::memory_resource* resource) { return DocumentParser(str, resource).parse(); });
             }
-            static Document fromString(std::string&& str)
+            static Document fromString(std::string&& str, DocumentAllocation allocation = DocumentAllocation::PerValue)
             {
-                return Document(std::move(str));
+                const std::size_t size = str.size();
+                return Document(allocation, size, [&str](std::pmr::memory_resource* resource) { return DocumentParser(std::move(str), resource).parse(); });
             }
-            static Document fromFile(const std::string& path)
+            // The string is parsed in place, see DocumentParser::inSitu. It has to outlive the document
+            // and any values taken from it.
+            static Document fromStringInSitu(std::string& str, DocumentAllocation allocation = DocumentAllocation::PerValue)
+            {
+                return Document(allocation, str.size(), [&str](std::pmr::memory_resource* resource) { return DocumentParser::inSitu(str, resource).parse(); });
+            }
+            static Document fromFile(const std::string& path, DocumentAllocation allocation = DocumentAllocation::PerValue)
             {
                 std::fstream file(path, std::ios::in);
                 if (file)
@@ -36,25 +92,58 @@ namespace ls
                     file.seekg(0, std::ios::beg);
                     file.read(contents.data(), contents.size());
                     file.close();
-                    return contents;
+                    return fromString(std::move(contents), allocation);
                 }
                 else throw std::runtime_error("File not found: " + path);
             }
-            static Document emptyObject()
+            static Document emptyObject(DocumentAllocation allocation = DocumentAllocation::PerValue)
+            {
+                return Document(Value(Value::Object{}), allocation);
+            }
+            static Document emptyArray(DocumentAllocation allocation = DocumentAllocation::PerValue)
+            {
+                return Document(Value(Value::Array{}), allocation);
+            }
+            static Document singleValue(const Value& val, DocumentAllocation allocation = DocumentAllocation::PerValue)
             {
-                return Document(Value(Value::Object{}));
+                return Document(Value(val), allocation);
             }
-            static Document emptyArray()
+            static Document singleValue(Value&& val, DocumentAllocation allocation = DocumentAllocation::PerValue)
             {
-                return Document(Value(Value::Array{}));
+                return Document(std::move(val), allocation);
             }
-            static Document singleValue(const Value& val)
+
+            Document(const Document& other) :
+                DocumentArena(other.allocation()),
+                Value(other, memoryResource())
             {
-                return Document(Value(val));
+
             }
-            static Document singleValue(Value&& val)
+
+            Document(Document&& other) noexcept = default;
+
+            Document& operator=(const Document& other)
             {
-                return Document(std::move(val));
+                if (this == &other) return *this;
+
+                return *this = Document(other);
+            }
+
+            Document& operator=(Document&& other) noexcept
+            {
+                if (this == &other) return *this;
+
+                //values have to go before the arena they live in
+                release();
+                DocumentArena::operator=(std::move(other));
+                initFrom(std::move(static_cast<Value&>(other)));
+
+                return *this;
+            }
+
+            ~Document()
+            {
+                release();
             }
 
             std::string stringify(const WriterParams& params = WriterParams::pretty())
@@ -63,22 +152,26 @@ namespace ls
             }
 
         private:
-            Document(const std::string& str) :
-                Value(DocumentParser(str).parse())
+            //the arena is sized after the input, the tree usually takes a similar amount of memory
+            template <typename ParseFuncT>
+            Document(DocumentAllocation allocation, std::size_t inputSize, ParseFuncT&& parse) :
+                DocumentArena(allocation, inputSize),
+                Value(parse(memoryResource()), memoryResource())
             {
 
             }
 
-            Document(std::string&& str) :
-                Value(DocumentParser(std::move(str)).parse())
+            Document(Value&& root, DocumentAllocation allocation) :
+                DocumentArena(allocation),
+                Value(std::move(root), memoryResource())
             {
 
             }
 
-            Document(Value&& root) noexcept :
-                Value(std::move(root))
+            void release() noexcept
             {
-
+                if (m_arena != nullptr) abandon();
+                else destroy();
             }
         };
     }
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ls
+{
+    namespace json
+    {
+        namespace detail
+        {
+            // Map from string keys stored as one contiguous vector of key/value pairs sorted by key.
+            // Lookups are binary searches, iteration is in key order like std::map.
+            // Inserting shifts the following members, so bulk construction should go through the members constructor.
+            template <typename KeyT, typename MappedT, typename AllocatorT = std::allocator<std::pair<KeyT, MappedT>>>
+            struct FlatMap
+            {
+            public:
+                using key_type = KeyT;
+                using mapped_type = MappedT;
+                using value_type = std::pair<KeyT, MappedT>;
+                using allocator_type = AllocatorT;
+                using ContainerType = std::vector<value_type, AllocatorT>;
+                using size_type = typename ContainerType::size_type;
+                using iterator = typename ContainerType::iterator;
+                using const_iterator = typename ContainerType::const_iterator;
+
+                FlatMap() = default;
+
+                explicit FlatMap(const AllocatorT& alloc) :
+                    m_members(alloc)
+                {
+
+                }
+
+                // Takes members in any order. Of members with equal keys only the first one is kept,
+                // the same as inserting them one by one with try_emplace.
+                explicit FlatMap(ContainerType&& members) :
+                    m_members(std::move(members))
+                {
+                    auto keyLess = [](const value_type& lhs, const value_type& rhs) { return std::string_view(lhs.first) < std::string_view(rhs.first); };
+                    auto keyEqual = [](const value_type& lhs, const value_type& rhs) { return std::string_view(lhs.first) == std::string_view(rhs.first); };
+
+                    const bool isStrictlySorted = std::adjacent_find(m_members.begin(), m_members.end(),
+                        [&keyLess](const value_type& lhs, const value_type& rhs) { return !keyLess(lhs, rhs); }) == m_members.end();
+                    if (isStrictlySorted) return;
+
+                    if (m_members.size() <= maxInsertionSortSize)
+                    {
+                        //stable_sort allocates a buffer, objects are usually small
+                        for (auto iter = m_members.begin() + 1; iter != m_members.end(); ++iter)
+                        {
+                            if (!keyLess(*iter, *(iter - 1))) continue;
+
+                            value_type member = std::move(*iter);
+                            auto hole = iter;
+                            do
+                            {
+                                *hole = std::move(*(hole - 1));
+                                --hole;
+                            } while (hole != m_members.begin() && keyLess(member, *(hole - 1)));
+                            *hole = std::move(member);
+                        }
+                    }
+                    else
+                    {
+                        std::stable_sort(m_members.begin(), m_members.end(), keyLess);
+                    }
+                    m_members.erase(std::unique(m_members.begin(), m_members.end(), keyEqual), m_members.end());
+                }
+
+                FlatMap(const FlatMap&) = default;
+                FlatMap(FlatMap&&) noexcept = default;
+                FlatMap(const FlatMap& other, const AllocatorT& alloc) :
+                    m_members(other.m_members, alloc)
+                {
+
+                }
+                FlatMap(FlatMap&& other, const AllocatorT& alloc) :
+                    m_members(std::move(other.m_members), alloc)
+                {
+
+                }
+                FlatMap& operator=(const FlatMap&) = default;
+                FlatMap& operator=(FlatMap&&) = default;
+
+                iterator begin() { return m_members.begin(); }
+                iterator end() { return m_members.end(); }
+                const_iterator begin() const { return m_members.begin(); }
+                const_iterator end() const { return m_members.end(); }
+                const_iterator cbegin() const { return m_members.cbegin(); }
+                const_iterator cend() const { return m_members.cend(); }
+
+                size_type size() const { return m_members.size(); }
+                bool empty() const { return m_members.empty(); }
+                void reserve(size_type n) { m_members.reserve(n); }
+                void clear() { m_members.clear(); }
+
+                allocator_type get_allocator() const { return m_members.get_allocator(); }
+
+                const ContainerType& members() const { return m_members; }
+
+                iterator find(std::string_view key)
+                {
+                    const auto iter = lowerBound(key);
+                    return iter != m_members.end() && std::string_view(iter->first) == key ? iter : m_members.end();
+                }
+                const_iterator find(std::string_view key) const
+                {
+                    return const_cast<FlatMap&>(*this).find(key);
+                }
+
+                size_type count(std::string_view key) const
+                {
+                    return find(key) != end() ? 1 : 0;
+                }
+
+                bool contains(std::string_view key) const
+                {
+                    return find(key) != end();
+                }
+
+                MappedT& at(std::string_view key)
+                {
+                    const auto iter = find(key);
+                    if (iter == end()) throw std::out_of_range("Key not found");
+                    return iter->second;
+                }
+                const MappedT& at(std::string_view key) const
+                {
+                    return const_cast<FlatMap&>(*this).at(key);
+                }
+
+                template <typename KeyArgT, typename... ArgsTs>
+                std::pair<iterator, bool> try_emplace(KeyArgT&& key, ArgsTs&&... args)
+                {
+                    const auto iter = lowerBound(key);
+                    if (iter != m_members.end() && std::string_view(iter->first) == std::string_view(key)) return { iter, false };
+
+                    return {
+                        m_members.emplace(iter, std::piecewise_construct, std::forward_as_tuple(std::forward<KeyArgT>(key)), std::forward_as_tuple(std::forward<ArgsTs>(args)...)),
+                        true
+                    };
+                }
+
+                iterator erase(const_iterator pos)
+                {
+                    return m_members.erase(pos);
+                }
+
+                size_type erase(std::string_view key)
+                {
+                    const auto iter = find(key);
+                    if (iter == end()) return 0;
+                    m_members.erase(iter);
+                    return 1;
+                }
+
+            private:
+                static constexpr size_type maxInsertionSortSize = 32;
+
+                ContainerType m_members;
+
+                iterator lowerBound(std::string_view key)
+                {
+                    return std::lower_bound(m_members.begin(), m_members.end(), key,
+                        [](const value_type& member, std::string_view k) { return std::string_view(member.first) < k; });
+                }
+            };
+        }
+    }
+}
@@ -4,10 +4,13 @@ namespace ls
 {
     namespace json
     {
+        enum struct DocumentAllocation;
+
         struct Value;
         struct Document;
         struct Writer;
         struct DocumentParser;
+        struct SaxParser;
 
         template <typename...>
         struct Reader;
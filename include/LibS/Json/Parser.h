@@ -1,11 +1,17 @@
 #pragma once
 
 #include "Value.h"
+#include "StructuralIndex.h"
 
 #include <cctype>
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace ls
 {
@@ -13,9 +19,10 @@ namespace ls
     {
         namespace detail
         {
+            //only the whitespace allowed by json, the structural index relies on it
             inline bool isWhitespace(char c)
             {
-                return std::isspace(static_cast<unsigned char>(c));
+                return c == ' ' || c == '\t' || c == '\n' || c == '\r';
             }
             inline bool isControl(char c)
             {
@@ -26,6 +33,16 @@ namespace ls
                 return std::isdigit(static_cast<unsigned char>(c));
             }
 
+            struct InputStream;
+
+            // Throws DocumentParser::ParsingError located at the current position of the stream.
+            [[noreturn]] inline void throwParsingError(const char* msg, const InputStream& stream);
+
+            // Input of the parsers. Either the whole text given up front, a source pulled in chunks,
+            // in which case the consumed part of the buffer is dropped on every refill,
+            // or a buffer borrowed from the caller, in which strings can be decoded in place.
+            // Input that is all in memory is indexed first (see findStructuralCharacters),
+            // then whitespace is skipped and strings are found by jumping between the indexed positions.
             struct InputStream
             {
             public:
@@ -35,48 +52,127 @@ namespace ls
                     int character;
                 };
 
-                InputStream(const std::string& str) :
+                // Writes at most the given number of characters to the buffer and returns how many were written.
+                // Returning 0 ends the input.
+                using Source = std::function<size_t(char*, size_t)>;
+
+                // maxSimdLevel limits the instruction set used to build the index, see findStructuralCharacters.
+                InputStream(const std::string& str, SimdLevel maxSimdLevel = SimdLevel::Avx2) :
                     m_str(str),
-                    m_ptr(m_str.begin())
+                    m_data(m_str.data()),
+                    m_size(m_str.size()),
+                    m_pos(0),
+                    m_location{ 1, 1 },
+                    m_locationPos(0),
+                    m_chunkSize(0),
+                    m_structuralCursor(0),
+                    m_isIndexed(false)
                 {
-
+                    buildStructuralIndex(maxSimdLevel);
                 }
-                InputStream(std::string&& str) :
+                InputStream(std::string&& str, SimdLevel maxSimdLevel = SimdLevel::Avx2) :
                     m_str(std::move(str)),
-                    m_ptr(m_str.begin())
+                    m_data(m_str.data()),
+                    m_size(m_str.size()),
+                    m_pos(0),
+                    m_location{ 1, 1 },
+                    m_locationPos(0),
+                    m_chunkSize(0),
+                    m_structuralCursor(0),
+                    m_isIndexed(false)
+                {
+                    buildStructuralIndex(maxSimdLevel);
+                }
+                InputStream(Source source, size_t chunkSize) :
+                    m_data(m_str.data()),
+                    m_size(0),
+                    m_pos(0),
+                    m_location{ 1, 1 },
+                    m_locationPos(0),
+                    m_source(std::move(source)),
+                    m_chunkSize(std::max<size_t>(chunkSize, 1)),
+                    m_structuralCursor(0),
+                    m_isIndexed(false)
+                {
+
+                }
+                // Borrows the buffer, data[size] has to be '\0'.
+                InputStream(char* data, size_t size, SimdLevel maxSimdLevel = SimdLevel::Avx2) :
+                    m_data(data),
+                    m_size(size),
+                    m_pos(0),
+                    m_location{ 1, 1 },
+                    m_locationPos(0),
+                    m_chunkSize(0),
+                    m_structuralCursor(0),
+                    m_isIndexed(false)
                 {
+                    buildStructuralIndex(maxSimdLevel);
+                }
 
+                InputStream(const InputStream&) = delete;
+                InputStream& operator=(const InputStream&) = delete;
+
+                InputStream(InputStream&& other) noexcept :
+                    m_data(other.m_data),
+                    m_size(other.m_size),
+                    m_pos(other.m_pos),
+                    m_location(other.m_location),
+                    m_locationPos(other.m_locationPos),
+                    m_source(std::move(other.m_source)),
+                    m_chunkSize(other.m_chunkSize),
+                    m_structurals(std::move(other.m_structurals)),
+                    m_structuralCursor(other.m_structuralCursor),
+                    m_isIndexed(other.m_isIndexed)
+                {
+                    //the string may keep the characters inline
+                    const bool isOwned = other.m_data == other.m_str.data();
+                    m_str = std::move(other.m_str);
+                    if (isOwned) m_data = m_str.data();
                 }
 
-                char current() const
+                //'\0' on end
+                char current()
                 {
-                    return *m_ptr;
+                    if (m_pos == m_size && !refill()) return '\0';
+                    return m_data[m_pos];
                 }
 
                 void advance(size_t n = 1)
                 {
-                    m_ptr += std::min(n, static_cast<size_t>(m_str.end() - m_ptr));
+                    m_pos += std::min(n, m_size - m_pos);
                 }
 
                 void eatWhitespaces()
                 {
-                    while (m_ptr != m_str.end() && isWhitespace(*m_ptr))
+                    if (m_isIndexed)
                     {
-                        ++m_ptr;
+                        //the first character after whitespace is always indexed
+                        if (m_pos != m_size && isWhitespace(m_data[m_pos])) m_pos = nextStructural(m_pos);
+                        return;
+                    }
+
+                    for (;;)
+                    {
+                        while (m_pos != m_size && isWhitespace(m_data[m_pos]))
+                        {
+                            ++m_pos;
+                        }
+
+                        if (m_pos != m_size || !refill()) return;
                     }
                 }
 
                 bool isOnEnd()
                 {
-                    return m_ptr == m_str.end();
+                    return m_pos == m_size && !refill();
                 }
 
                 double readDouble()
                 {
-                    const char* begin = &*m_ptr;
-                    char* end;
-                    const double result = strtod(begin, &end);
-                    const size_t length = end - begin;
+                    bufferToken();
+                    const size_t length = numberLength();
+                    const double result = strtod(m_data + m_pos, nullptr);
                     advance(length);
 
                     return result;
@@ -84,100 +180,313 @@ namespace ls
 
                 int64_t readInt64()
                 {
-                    const char* begin = &*m_ptr;
-                    char* end;
-                    const int64_t result = static_cast<int64_t>(strtoll(begin, &end, 10));
-                    const size_t length = end - begin;
+                    bufferToken();
+                    const size_t length = numberLength();
+                    const int64_t result = static_cast<int64_t>(strtoll(m_data + m_pos, nullptr, 10));
                     advance(length);
 
                     return result;
                 }
 
-                std::string readString()
+                // Appends the decoded string to result. Returns false if the input ended before the closing quote.
+                template <typename StringT>
+                bool appendString(StringT& result)
                 {
-                    std::string result;
-
                     advance(); // '\"'
-                    while (m_ptr != m_str.end())
+                    if (m_isIndexed)
                     {
-                        const char currentChar = *m_ptr;
+                        const size_t end = findPlainStringEnd();
+                        if (end != m_size)
+                        {
+                            result.append(m_data + m_pos, end - m_pos);
+                            m_pos = end + 1;
+                            return true;
+                        }
+                    }
+
+                    while (!isOnEnd())
+                    {
+                        const char currentChar = m_data[m_pos];
+                        if (isControl(currentChar))
+                        {
+                            throwParsingError("No control characters allowed inside strings", *this);
+                        }
+
                         advance();
                         char outputChar = currentChar;
 
-                        if (iscntrl(currentChar))
+                        if (currentChar == '\"')
                         {
-                            throw std::runtime_error("No control characters allowed inside strings");
+                            return true;
                         }
 
+                        if (currentChar == '\\')
+                        {
+                            outputChar = decodeEscape(current());
+                            advance();
+                        }
+
+                        result += outputChar;
+                    }
+
+                    return false;
+                }
+
+                // Decodes the string in place and sets result to a view of it in the buffer.
+                // Only for borrowed buffers, the decoded characters overwrite the escape sequences.
+                // Returns false if the input ended before the closing quote.
+                bool readStringInSitu(std::string_view& result)
+                {
+                    advance(); // '\"'
+                    const size_t begin = m_pos;
+                    if (m_isIndexed)
+                    {
+                        const size_t end = findPlainStringEnd();
+                        if (end != m_size)
+                        {
+                            m_pos = end + 1;
+                            result = std::string_view(m_data + begin, end - begin);
+                            return true;
+                        }
+                    }
+
+                    size_t out = m_pos;
+                    bool hasEscapes = false;
+                    bool isTerminated = false;
+                    while (m_pos != m_size)
+                    {
+                        const char currentChar = m_data[m_pos];
+                        if (isControl(currentChar))
+                        {
+                            if (hasEscapes) skipLocationInString();
+                            throwParsingError("No control characters allowed inside strings", *this);
+                        }
+
+                        ++m_pos;
+
                         if (currentChar == '\"')
                         {
+                            isTerminated = true;
                             break;
                         }
 
                         if (currentChar == '\\')
                         {
-                            const char nextChar = *m_ptr;
-                            advance();
-                            switch (nextChar)
+                            if (!hasEscapes)
                             {
-                            case '\"': outputChar = '\"'; break;
-                            case '\\': outputChar = '\\'; break;
-                            case 'b': outputChar = '\b'; break;
-                            case 'f': outputChar = '\f'; break;
-                            case 'n': outputChar = '\n'; break;
-                            case 'r': outputChar = '\r'; break;
-                            case 't': outputChar = '\t'; break;
-                            case '/': outputChar = '/'; break;
-                            default: throw std::runtime_error("Invalid escape sequence");
+                                //the location is computed from the original characters, so it has to be taken before they are overwritten
+                                advanceLocation(m_location, m_data + m_locationPos, m_data + begin);
+                                m_locationPos = begin;
+                                hasEscapes = true;
                             }
-                        }
 
-                        result += outputChar;
+                            skipLocationInString();
+                            m_data[out++] = decodeEscape(current());
+                            advance();
+                        }
+                        else
+                        {
+                            m_data[out++] = currentChar;
+                        }
                     }
 
-                    return result;
+                    if (hasEscapes) skipLocationInString();
+
+                    result = std::string_view(m_data + begin, out - begin);
+                    return isTerminated;
                 }
 
                 bool readBool()
                 {
-                    const char currentChar = *m_ptr;
-                    switch (currentChar)
-                    {
-                    case 't':
-                        advance(4);
-                        return true;
-                    case 'f':
-                        advance(5);
-                        return false;
-                    default:
-                        throw std::runtime_error("Invalid boolean constant");
-                    }
+                    bufferToken();
+                    if (readLiteral("true")) return true;
+                    if (readLiteral("false")) return false;
+                    throwParsingError("Invalid boolean constant", *this);
                 }
 
                 void readNull()
                 {
-                    advance(4);
+                    bufferToken();
+                    if (!readLiteral("null")) throwParsingError("Invalid null constant", *this);
                 }
 
                 Location currentLocation() const
                 {
-                    int line = 1;
-                    int character = 1;
-                    for (auto iter = m_str.begin(); iter != m_ptr; ++iter)
+                    Location location = m_location;
+                    advanceLocation(location, m_data + m_locationPos, m_data + m_pos);
+                    return location;
+                }
+
+            private:
+                std::string m_str;
+                char* m_data;
+                size_t m_size;
+                size_t m_pos;
+
+                //location of the character at m_locationPos, characters before it may be already dropped or decoded
+                Location m_location;
+                size_t m_locationPos;
+
+                Source m_source;
+                size_t m_chunkSize;
+
+                std::vector<std::uint32_t> m_structurals;
+                size_t m_structuralCursor;
+                bool m_isIndexed;
+
+                static void advanceLocation(Location& location, const char* begin, const char* end)
+                {
+                    for (; begin != end; ++begin)
                     {
-                        if (*iter == '\n')
+                        if (*begin == '\n')
                         {
-                            ++line;
-                            character = 1;
+                            ++location.line;
+                            location.character = 1;
                         }
-                        else ++character;
+                        else ++location.character;
                     }
-                    return { line, character };
                 }
 
-            private:
-                std::string m_str;
-                std::string::iterator m_ptr;
+                void buildStructuralIndex(SimdLevel maxSimdLevel)
+                {
+                    if (m_size > maxStructuralIndexSize) return;
+
+                    m_structurals = findStructuralCharacters(m_data, m_size, maxSimdLevel);
+                    m_isIndexed = true;
+                }
+
+                //first indexed position not before pos, m_size if there is none
+                //positions are only ever asked for in increasing order
+                size_t nextStructural(size_t pos)
+                {
+                    while (m_structuralCursor != m_structurals.size() && m_structurals[m_structuralCursor] < pos)
+                    {
+                        ++m_structuralCursor;
+                    }
+
+                    if (m_structuralCursor == m_structurals.size()) return m_size;
+                    return m_structurals[m_structuralCursor];
+                }
+
+                //the closing quote is the next indexed position, returns m_size if the string has escapes or control characters
+                size_t findPlainStringEnd()
+                {
+                    const size_t end = nextStructural(m_pos);
+                    if (end == m_size || m_data[end] != '\"') return m_size;
+
+                    const bool isPlain = std::none_of(m_data + m_pos, m_data + end, [](char c) { return c == '\\' || isControl(c); });
+                    return isPlain ? end : m_size;
+                }
+
+                bool readLiteral(std::string_view literal)
+                {
+                    if (std::string_view(m_data + m_pos, m_size - m_pos).substr(0, literal.size()) != literal) return false;
+
+                    advance(literal.size());
+                    return true;
+                }
+
+                //strings can't contain line breaks, so all of the original characters since m_locationPos are on one line
+                //and the location can be moved without looking at the ones already overwritten
+                void skipLocationInString()
+                {
+                    m_location.character += static_cast<int>(m_pos - m_locationPos);
+                    m_locationPos = m_pos;
+                }
+
+                // Length of the number at the current position, which has to follow the json grammar
+                // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+                size_t numberLength() const
+                {
+                    const char* const begin = m_data + m_pos;
+                    const char* const end = m_data + m_size;
+                    const auto skipDigits = [end](const char* it) {
+                        while (it != end && isDigit(*it)) ++it;
+                        return it;
+                    };
+
+                    const char* it = begin;
+                    if (it != end && *it == '-') ++it;
+
+                    if (it != end && *it == '0') ++it;
+                    else if (it != end && isDigit(*it)) it = skipDigits(it);
+                    else throwParsingError("Invalid number", *this);
+
+                    if (it != end && *it == '.')
+                    {
+                        if (it + 1 == end || !isDigit(it[1])) throwParsingError("Invalid number", *this);
+                        it = skipDigits(it + 1);
+                    }
+
+                    if (it != end && (*it == 'e' || *it == 'E'))
+                    {
+                        ++it;
+                        if (it != end && (*it == '+' || *it == '-')) ++it;
+                        if (it == end || !isDigit(*it)) throwParsingError("Invalid number", *this);
+                        it = skipDigits(it);
+                    }
+
+                    //leading zeros and other characters glued to the number
+                    if (it != end && isTokenCharacter(*it)) throwParsingError("Invalid number", *this);
+
+                    return it - begin;
+                }
+
+                char decodeEscape(char c) const
+                {
+                    switch (c)
+                    {
+                    case '\"': return '\"';
+                    case '\\': return '\\';
+                    case 'b': return '\b';
+                    case 'f': return '\f';
+                    case 'n': return '\n';
+                    case 'r': return '\r';
+                    case 't': return '\t';
+                    case '/': return '/';
+                    default: throwParsingError("Invalid escape sequence", *this);
+                    }
+                }
+
+                static bool isTokenCharacter(char c)
+                {
+                    return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '+' || c == '-';
+                }
+
+                // Drops the consumed characters and appends the next chunk. Returns false if there was nothing more to read.
+                bool refill()
+                {
+                    if (!m_source) return false;
+
+                    advanceLocation(m_location, m_data + m_locationPos, m_data + m_pos);
+                    m_str.erase(0, m_pos);
+                    m_pos = 0;
+                    m_locationPos = 0;
+
+                    const size_t size = m_str.size();
+                    m_str.resize(size + m_chunkSize);
+                    const size_t numRead = m_source(m_str.data() + size, m_chunkSize);
+                    m_str.resize(size + std::min(numRead, m_chunkSize));
+                    m_data = m_str.data();
+                    m_size = m_str.size();
+                    if (numRead == 0) m_source = nullptr;
+
+                    return numRead != 0;
+                }
+
+                //numbers and literals are read from the buffer as a whole, so they can't be split between chunks
+                void bufferToken()
+                {
+                    size_t end = m_pos;
+                    while (m_source)
+                    {
+                        while (end != m_size && isTokenCharacter(m_data[end])) ++end;
+                        if (end != m_size) return;
+
+                        end -= m_pos;
+                        if (!refill()) return;
+                    }
+                }
             };
         }
 
@@ -202,17 +511,31 @@ namespace ls
                 }
             };
 
-            DocumentParser(const std::string& str) :
-                m_input(str)
+            // All strings and containers of the parsed tree are allocated from the resource.
+            // maxSimdLevel limits the instruction set used to index the input.
+            DocumentParser(const std::string& str, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), SimdLevel maxSimdLevel = SimdLevel::Avx2) :
+                m_input(str, maxSimdLevel),
+                m_resource(resource),
+                m_inSitu(false)
             {
 
             }
-            DocumentParser(std::string&& str) :
-                m_input(std::move(str))
+            DocumentParser(std::string&& str, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), SimdLevel maxSimdLevel = SimdLevel::Avx2) :
+                m_input(std::move(str), maxSimdLevel),
+                m_resource(resource),
+                m_inSitu(false)
             {
 
             }
 
+            // Parses the buffer in place. Strings in the tree refer to it and escape sequences in it are overwritten
+            // by the decoded characters, so it has to stay unchanged for as long as the tree is used.
+            // Keys are still copied.
+            static DocumentParser inSitu(std::string& buffer, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), SimdLevel maxSimdLevel = SimdLevel::Avx2)
+            {
+                return DocumentParser(detail::InputStream(buffer.data(), buffer.size(), maxSimdLevel), resource, true);
+            }
+
             Value parse()
             {
                 return Value(parseValue());
@@ -220,10 +543,20 @@ namespace ls
 
         private:
             detail::InputStream m_input;
+            std::pmr::memory_resource* m_resource;
+            bool m_inSitu;
+
+            DocumentParser(detail::InputStream&& input, std::pmr::memory_resource* resource, bool inSitu) :
+                m_input(std::move(input)),
+                m_resource(resource),
+                m_inSitu(inSitu)
+            {
+
+            }
 
             [[noreturn]] void parsingError(const char* msg)
             {
-                throw ParsingError(std::string(msg), m_input);
+                detail::throwParsingError(msg, m_input);
             }
 
             Value parseValue()
@@ -234,7 +567,11 @@ namespace ls
 
                 if (currentChar == '{') return Value(parseObject());
                 if (currentChar == '[') return Value(parseArray());
-                if (currentChar == '\"') return Value(parseString());
+                if (currentChar == '\"')
+                {
+                    if (m_inSitu) return Value::fromBorrowedString(parseStringInSitu());
+                    else return Value(parseString());
+                }
                 if (currentChar == 't' || currentChar == 'f') return Value(parseBool());
                 if (currentChar == 'n') { parseNull(); return Value(nullptr); };
                 if (detail::isDigit(currentChar) || currentChar == '-')
@@ -268,16 +605,25 @@ namespace ls
                 return m_input.readBool();
             }
 
-            std::string parseString()
+            Value::String parseString()
             {
-                std::string str = m_input.readString();
-                if (m_input.isOnEnd()) parsingError("Unterminated string"); //string is either not terminated or ends just before '\0'
+                Value::String str(m_resource);
+                if (!m_input.appendString(str)) parsingError("Unterminated string");
+                return str;
+            }
+
+            std::string_view parseStringInSitu()
+            {
+                std::string_view str;
+                if (!m_input.readStringInSitu(str)) parsingError("Unterminated string");
                 return str;
             }
 
             Value::Object parseObject()
             {
-                Value::Object obj;
+                //members are collected first and sorted once
+                Value::Object::ContainerType members(m_resource);
+                members.reserve(8);
 
                 m_input.advance(); // '{'
 
@@ -292,7 +638,7 @@ namespace ls
 
                         if (m_input.current() != '\"') parsingError("Expected key name");
 
-                        std::string key = m_input.readString();
+                        Value::String key = m_inSitu ? Value::String(parseStringInSitu(), m_resource) : parseString();
                         m_input.eatWhitespaces();
 
                         if (m_input.isOnEnd()) parsingError("Unexpected end of stream");
@@ -301,7 +647,7 @@ namespace ls
 
                         m_input.eatWhitespaces();
                         Value val = parseValue();
-                        obj.try_emplace(std::move(key), std::move(val));
+                        members.emplace_back(std::move(key), std::move(val));
 
                         m_input.eatWhitespaces();
                         if (m_input.isOnEnd()) parsingError("Unterminated object");
@@ -316,12 +662,12 @@ namespace ls
                 }
                 m_input.advance(); // '}'
 
-                return obj;
+                return Value::Object(std::move(members));
             }
 
             Value::Array parseArray()
             {
-                Value::Array arr;
+                Value::Array arr(m_resource);
                 arr.reserve(8);
 
                 m_input.advance(); // '['
@@ -355,5 +701,13 @@ namespace ls
             }
 
         };
+
+        namespace detail
+        {
+            [[noreturn]] inline void throwParsingError(const char* msg, const InputStream& stream)
+            {
+                throw DocumentParser::ParsingError(std::string(msg), stream);
+            }
+        }
     }
 }
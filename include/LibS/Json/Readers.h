@@ -39,7 +39,7 @@ namespace ls
         {
             static std::string fromJson(const Value& val)
             {
-                return val.getString();
+                return std::string(val.getString());
             }
         };
 
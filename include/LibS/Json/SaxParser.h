@@ -0,0 +1,215 @@
+#pragma once
+
+#include "Parser.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ls
+{
+    namespace json
+    {
+        // Reads json without building a tree, reporting what is found to a handler as it goes.
+        // The handler has to provide
+        //     startObject(), key(std::string_view), endObject(),
+        //     startArray(), endArray(),
+        //     value(std::string_view), value(int64_t), value(double), value(bool), value(std::nullptr_t)
+        // Strings passed to the handler are only valid during the call.
+        // Numbers are told apart the same way as by DocumentParser.
+        // Input can be pulled in chunks from a stream or a source function, so it doesn't have to fit in memory.
+        struct SaxParser
+        {
+        public:
+            using Location = detail::InputStream::Location;
+            using Source = detail::InputStream::Source;
+            using ParsingError = DocumentParser::ParsingError;
+
+            static constexpr std::size_t defaultChunkSize = 64 * 1024;
+
+            // maxSimdLevel limits the instruction set used to index input that is given whole.
+            SaxParser(const std::string& str, SimdLevel maxSimdLevel = SimdLevel::Avx2) :
+                m_input(str, maxSimdLevel)
+            {
+
+            }
+            SaxParser(std::string&& str, SimdLevel maxSimdLevel = SimdLevel::Avx2) :
+                m_input(std::move(str), maxSimdLevel)
+            {
+
+            }
+            SaxParser(Source source, std::size_t chunkSize = defaultChunkSize) :
+                m_input(std::move(source), chunkSize)
+            {
+
+            }
+            // The stream has to outlive the parser.
+            SaxParser(std::istream& stream, std::size_t chunkSize = defaultChunkSize) :
+                m_input(
+                    [&stream](char* buffer, std::size_t size) {
+                        stream.read(buffer, static_cast<std::streamsize>(size));
+                        return static_cast<std::size_t>(stream.gcount());
+                    },
+                    chunkSize
+                )
+            {
+
+            }
+
+            // Reads the next top level value. Returns false if only whitespace was left.
+            // Values following each other, like in json lines, are read by calling it repeatedly.
+            template <typename HandlerT>
+            bool next(HandlerT& handler)
+            {
+                m_input.eatWhitespaces();
+                if (m_input.isOnEnd()) return false;
+
+                parseValue(handler);
+                return true;
+            }
+
+            // Reads all remaining top level values.
+            template <typename HandlerT>
+            void parse(HandlerT& handler)
+            {
+                while (next(handler));
+            }
+
+            // Location of the next character to be read.
+            Location location() const
+            {
+                return m_input.currentLocation();
+            }
+
+        private:
+            detail::InputStream m_input;
+
+            //reused for all keys and strings
+            std::string m_string;
+
+            [[noreturn]] void parsingError(const char* msg)
+            {
+                throw ParsingError(std::string(msg), m_input);
+            }
+
+            template <typename HandlerT>
+            void parseValue(HandlerT& handler)
+            {
+                m_input.eatWhitespaces();
+
+                const char currentChar = m_input.current();
+
+                if (currentChar == '{') parseObject(handler);
+                else if (currentChar == '[') parseArray(handler);
+                else if (currentChar == '\"') handler.value(std::string_view(parseString()));
+                else if (currentChar == 't' || currentChar == 'f') handler.value(m_input.readBool());
+                else if (currentChar == 'n')
+                {
+                    m_input.readNull();
+                    handler.value(nullptr);
+                }
+                else if (detail::isDigit(currentChar) || currentChar == '-')
+                {
+                    const double number = m_input.readDouble();
+                    if (number == std::floor(number))
+                    {
+                        handler.value(static_cast<int64_t>(number));
+                    }
+                    else
+                    {
+                        handler.value(number);
+                    }
+                }
+                else parsingError("Unexpected character");
+            }
+
+            const std::string& parseString()
+            {
+                m_string.clear();
+                if (!m_input.appendString(m_string)) parsingError("Unterminated string");
+                return m_string;
+            }
+
+            template <typename HandlerT>
+            void parseObject(HandlerT& handler)
+            {
+                handler.startObject();
+
+                m_input.advance(); // '{'
+
+                m_input.eatWhitespaces();
+                if (m_input.isOnEnd()) parsingError("Unterminated object");
+                else if (m_input.current() != '}')
+                {
+                    for (;;)
+                    {
+                        m_input.eatWhitespaces();
+                        if (m_input.isOnEnd()) parsingError("Unterminated object");
+
+                        if (m_input.current() != '\"') parsingError("Expected key name");
+
+                        handler.key(std::string_view(parseString()));
+                        m_input.eatWhitespaces();
+
+                        if (m_input.isOnEnd()) parsingError("Unexpected end of stream");
+                        if (m_input.current() != ':') parsingError("Expected ':' after key name");
+                        m_input.advance(); // ':'
+
+                        parseValue(handler);
+
+                        m_input.eatWhitespaces();
+                        if (m_input.isOnEnd()) parsingError("Unterminated object");
+                        else if (m_input.current() == '}') break;
+                        else if (m_input.current() == ',')
+                        {
+                            m_input.advance(); // ','
+                            continue;
+                        }
+                        else parsingError("Expected ',' or '}'");
+                    }
+                }
+                m_input.advance(); // '}'
+
+                handler.endObject();
+            }
+
+            template <typename HandlerT>
+            void parseArray(HandlerT& handler)
+            {
+                handler.startArray();
+
+                m_input.advance(); // '['
+
+                m_input.eatWhitespaces();
+                if (m_input.isOnEnd()) parsingError("Unterminated array");
+                else if (m_input.current() != ']')
+                {
+                    for (;;)
+                    {
+                        m_input.eatWhitespaces();
+                        if (m_input.isOnEnd()) parsingError("Unterminated array");
+
+                        parseValue(handler);
+
+                        m_input.eatWhitespaces();
+                        if (m_input.isOnEnd()) parsingError("Unterminated array");
+                        else if (m_input.current() == ']') break;
+                        else if (m_input.current() == ',')
+                        {
+                            m_input.advance(); // ','
+                            continue;
+                        }
+                        else parsingError("Expected ',' or ']'");
+                    }
+                }
+                m_input.advance(); // ']'
+
+                handler.endArray();
+            }
+        };
+    }
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "LibS/Simd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace ls
+{
+    namespace json
+    {
+        namespace detail
+        {
+            // Positions are stored as 32 bit integers, longer inputs are parsed without an index.
+            constexpr std::size_t maxStructuralIndexSize = std::numeric_limits<std::uint32_t>::max();
+
+            // Bit i is set if character i of a 64 character block is of the given class.
+            struct CharacterClassMasks
+            {
+                std::uint64_t backslash;
+                std::uint64_t quote;
+                std::uint64_t whitespace;
+                std::uint64_t op;
+            };
+
+            inline int countTrailingZeros(std::uint64_t x)
+            {
+#if defined(__clang__) || defined(__GNUC__) || defined(__GNUG__)
+                return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+                unsigned long index;
+                _BitScanForward64(&index, x);
+                return static_cast<int>(index);
+#else
+                int n = 0;
+                while ((x & 1) == 0)
+                {
+                    x >>= 1;
+                    ++n;
+                }
+                return n;
+#endif
+            }
+
+            // Bit i of the result is the xor of bits [0, i].
+            inline std::uint64_t prefixXor(std::uint64_t x)
+            {
+                x ^= x << 1;
+                x ^= x << 2;
+                x ^= x << 4;
+                x ^= x << 8;
+                x ^= x << 16;
+                x ^= x << 32;
+                return x;
+            }
+
+            // Characters preceded by an odd number of backslashes.
+            // isNextEscaped carries over to the next block if the last character is an escaping backslash.
+            inline std::uint64_t findEscapedCharacters(std::uint64_t backslash, bool& isNextEscaped)
+            {
+                std::uint64_t escaped = isNextEscaped ? 1 : 0;
+                isNextEscaped = false;
+
+                //backslashes are rare, so they are paired with the escaped characters one by one
+                std::uint64_t escaping = backslash & ~escaped;
+                while (escaping != 0)
+                {
+                    const int i = countTrailingZeros(escaping);
+                    if (i == 63)
+                    {
+                        isNextEscaped = true;
+                        break;
+                    }
+
+                    const std::uint64_t next = std::uint64_t(1) << (i + 1);
+                    escaped |= next;
+                    escaping &= ~(next | (next >> 1));
+                }
+
+                return escaped;
+            }
+
+            inline CharacterClassMasks classifyBlockScalar(const char* block)
+            {
+                CharacterClassMasks masks{ 0, 0, 0, 0 };
+                for (int i = 0; i < 64; ++i)
+                {
+                    const std::uint64_t bit = std::uint64_t(1) << i;
+                    switch (block[i])
+                    {
+                    case '\\':
+                        masks.backslash |= bit;
+                        break;
+                    case '\"':
+                        masks.quote |= bit;
+                        break;
+                    case ' ':
+                    case '\t':
+                    case '\n':
+                    case '\r':
+                        masks.whitespace |= bit;
+                        break;
+                    case '{':
+                    case '}':
+                    case '[':
+                    case ']':
+                    case ':':
+                    case ',':
+                        masks.op |= bit;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                return masks;
+            }
+
+#if defined(LS_SIMD_SSE2)
+
+            // '[' and ']' differ from '{' and '}' only by the 0x20 bit, so setting it
+            // leaves 4 comparisons for the operators, as for the whitespace.
+
+            inline __m128i equalSse2(__m128i v, char c)
+            {
+                return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+            }
+
+            inline std::uint64_t bitsSse2(__m128i v, int shift)
+            {
+                return static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(v))) << shift;
+            }
+
+            inline CharacterClassMasks classifyBlockSse2(const char* block)
+            {
+                CharacterClassMasks masks{ 0, 0, 0, 0 };
+                for (int i = 0; i < 4; ++i)
+                {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+                    const __m128i lowered = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+                    const __m128i whitespace = _mm_or_si128(
+                        _mm_or_si128(equalSse2(v, ' '), equalSse2(v, '\t')),
+                        _mm_or_si128(equalSse2(v, '\n'), equalSse2(v, '\r'))
+                    );
+                    const __m128i op = _mm_or_si128(
+                        _mm_or_si128(equalSse2(lowered, '{'), equalSse2(lowered, '}')),
+                        _mm_or_si128(equalSse2(v, ':'), equalSse2(v, ','))
+                    );
+
+                    masks.backslash |= bitsSse2(equalSse2(v, '\\'), i * 16);
+                    masks.quote |= bitsSse2(equalSse2(v, '\"'), i * 16);
+                    masks.whitespace |= bitsSse2(whitespace, i * 16);
+                    masks.op |= bitsSse2(op, i * 16);
+                }
+                return masks;
+            }
+
+            LS_TARGET_AVX2 inline __m256i equalAvx2(__m256i v, char c)
+            {
+                return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+            }
+
+            LS_TARGET_AVX2 inline std::uint64_t bitsAvx2(__m256i v, int shift)
+            {
+                return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(v))) << shift;
+            }
+
+            LS_TARGET_AVX2 inline CharacterClassMasks classifyBlockAvx2(const char* block)
+            {
+                CharacterClassMasks masks{ 0, 0, 0, 0 };
+                for (int i = 0; i < 2; ++i)
+                {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 32));
+                    const __m256i lowered = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+                    const __m256i whitespace = _mm256_or_si256(
+                        _mm256_or_si256(equalAvx2(v, ' '), equalAvx2(v, '\t')),
+                        _mm256_or_si256(equalAvx2(v, '\n'), equalAvx2(v, '\r'))
+                    );
+                    const __m256i op = _mm256_or_si256(
+                        _mm256_or_si256(equalAvx2(lowered, '{'), equalAvx2(lowered, '}')),
+                        _mm256_or_si256(equalAvx2(v, ':'), equalAvx2(v, ','))
+                    );
+
+                    masks.backslash |= bitsAvx2(equalAvx2(v, '\\'), i * 32);
+                    masks.quote |= bitsAvx2(equalAvx2(v, '\"'), i * 32);
+                    masks.whitespace |= bitsAvx2(whitespace, i * 32);
+                    masks.op |= bitsAvx2(op, i * 32);
+                }
+                return masks;
+            }
+
+#endif
+
+            inline CharacterClassMasks classifyBlock(const char* block, SimdLevel level)
+            {
+#if defined(LS_SIMD_SSE2)
+                if (level == SimdLevel::Avx2) return classifyBlockAvx2(block);
+                else if (level == SimdLevel::Sse2) return classifyBlockSse2(block);
+#endif
+                (void)level;
+                return classifyBlockScalar(block);
+            }
+
+            // Finds the characters the parser has to stop at: the operators {}[]:, outside of strings,
+            // the quotes around strings and the first character of every other token.
+            // Everything else is whitespace or the inside of a token, so it can be jumped over.
+            // The input is classified 64 characters at a time with the best instruction set
+            // available up to maxLevel, quotes are then matched with bit operations on the masks.
+            // size must not exceed maxStructuralIndexSize.
+            inline std::vector<std::uint32_t> findStructuralCharacters(const char* data, std::size_t size, SimdLevel maxLevel = SimdLevel::Avx2)
+            {
+                const SimdLevel level = std::min(simdLevel(), maxLevel);
+
+                std::vector<std::uint32_t> positions;
+                std::size_t count = 0;
+
+                //state carried over between blocks
+                bool isNextEscaped = false;
+                std::uint64_t prevInString = 0;
+                std::uint64_t prevScalar = 0;
+
+                char tail[64];
+                for (std::size_t blockStart = 0; blockStart < size; blockStart += 64)
+                {
+                    const char* block = data + blockStart;
+                    if (size - blockStart < 64)
+                    {
+                        //whitespace is never structural
+                        std::memset(tail, ' ', sizeof(tail));
+                        std::memcpy(tail, block, size - blockStart);
+                        block = tail;
+                    }
+
+                    const CharacterClassMasks masks = classifyBlock(block, level);
+
+                    //set from the opening quote up to, but excluding, the closing one
+                    const std::uint64_t quote = masks.quote & ~findEscapedCharacters(masks.backslash, isNextEscaped);
+                    const std::uint64_t inString = prefixXor(quote) ^ prevInString;
+                    prevInString = (inString >> 63) != 0 ? ~std::uint64_t(0) : 0;
+
+                    const std::uint64_t op = masks.op & ~inString;
+                    const std::uint64_t scalar = ~(masks.op | masks.whitespace | masks.quote | inString);
+                    const std::uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+                    prevScalar = scalar >> 63;
+
+                    std::uint64_t structurals = op | quote | scalarStart;
+
+                    if (positions.size() < count + 64)
+                    {
+                        positions.resize(std::max(positions.size() * 2, count + 64));
+                    }
+                    while (structurals != 0)
+                    {
+                        positions[count++] = static_cast<std::uint32_t>(blockStart + countTrailingZeros(structurals));
+                        structurals &= structurals - 1;
+                    }
+                }
+
+                positions.resize(count);
+                return positions;
+            }
+        }
+    }
+}
@@ -1,65 +1,108 @@
 #pragma once
 
-#include <vector>
-#include <unordered_map>
-#include <map>
-#include <memory>
+#include "FlatMap.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace ls
 {
     namespace json
     {
+        // Scalars are stored inline, strings rely on the small string optimization,
+        // so only strings too long for it and containers allocate.
+        // Objects are vectors of key/value pairs sorted by key.
+        // Allocations go through the memory resource of the value. As with std::pmr containers
+        // it's fixed on construction, assignment and setters keep it, and values placed into arrays
+        // or objects are copied to the resource of the container when it differs.
         struct Value
         {
-        private:
-            static constexpr bool useUnorderedMap = false;
-
         public:
-            using Array = std::vector<Value>;
-            using Object = typename std::conditional_t<useUnorderedMap, std::unordered_map<std::string, Value>, std::map<std::string, Value, std::less<>>>;
+            using allocator_type = std::pmr::polymorphic_allocator<Value>;
+            using String = std::pmr::string;
+            using Array = std::pmr::vector<Value>;
+            using Object = detail::FlatMap<String, Value, std::pmr::polymorphic_allocator<std::pair<String, Value>>>;
+            using Member = Object::value_type;
+
+            friend struct Document;
 
-            Value() noexcept : m_valueType(Type::Empty) {}
-            Value(const Value& other) : m_valueType(other.m_valueType)
+            Value() noexcept : Value(allocator_type{}) {}
+            explicit Value(const allocator_type& alloc) noexcept : m_valueType(Type::Empty)
             {
-                if (other.m_value != nullptr)
-                {
-                    m_value = std::make_unique<ValueUnion>(*other.m_value);
-                }
-                else
-                {
-                    m_value = nullptr;
-                }
+                m_value.scalar.resource = alloc.resource();
+            }
+            Value(const Value& other) : Value(other, allocator_type{}) {}
+            Value(const Value& other, const allocator_type& alloc) : Value(alloc)
+            {
+                initFrom(other, alloc.resource());
+            }
+            Value(Value&& other) noexcept : m_valueType(Type::Empty)
+            {
+                initFrom(std::move(other));
+            }
+            Value(Value&& other, const allocator_type& alloc) : Value(alloc)
+            {
+                if (other.resource() == alloc.resource()) initFrom(std::move(other));
+                else initFrom(other, alloc.resource());
             }
-            Value(Value&&) noexcept = default;
             Value& operator=(const Value& other)
             {
-                if (other.m_value != nullptr)
-                {
-                    m_value = std::make_unique<ValueUnion>(*other.m_value);
-                }
-                else
-                {
-                    m_value = nullptr;
-                }
-                m_valueType = other.m_valueType;
+                if (this == &other) return *this;
+
+                Value copy(other, get_allocator());
+                destroy();
+                initFrom(std::move(copy));
+
+                return *this;
+            }
+            Value& operator=(Value&& other)
+            {
+                if (this == &other) return *this;
+
+                //other may be owned by this value
+                Value tmp(std::move(other), get_allocator());
+                destroy();
+                initFrom(std::move(tmp));
 
                 return *this;
             }
-            Value& operator=(Value&&) noexcept = default;
-            explicit Value(const char* str) : m_value(std::make_unique<ValueUnion>(std::string(str))), m_valueType(Type::String) {}
-            explicit Value(const std::string& str) : m_value(std::make_unique<ValueUnion>(str)), m_valueType(Type::String) {}
-            explicit Value(std::string&& str) : m_value(std::make_unique<ValueUnion>(std::move(str))), m_valueType(Type::String) {}
-            explicit Value(double d) : m_value(std::make_unique<ValueUnion>(d)), m_valueType(Type::Float) {}
-            explicit Value(int64_t i) : m_value(std::make_unique<ValueUnion>(i)), m_valueType(Type::Int) {}
-            explicit Value(Object&& obj) : m_value(std::make_unique<ValueUnion>(std::move(obj))), m_valueType(Type::Object) {}
-            explicit Value(Array&& arr) : m_value(std::make_unique<ValueUnion>(std::move(arr))), m_valueType(Type::Array) {}
-            explicit Value(bool b) : m_value(std::make_unique<ValueUnion>(static_cast<int64_t>(b))), m_valueType(Type::Bool) {}
-            explicit Value(std::nullptr_t) : m_valueType(Type::Null) {}
+            ~Value()
+            {
+                destroy();
+            }
+            explicit Value(const char* str, const allocator_type& alloc = {}) : Value(alloc) { initString(String(str, alloc)); }
+            explicit Value(std::string_view str, const allocator_type& alloc = {}) : Value(alloc) { initString(String(str, alloc)); }
+            explicit Value(String&& str) noexcept : m_valueType(Type::Empty) { initString(std::move(str)); }
+            explicit Value(double d, const allocator_type& alloc = {}) noexcept : Value(alloc) { initScalar(Type::Float, d); }
+            explicit Value(int64_t i, const allocator_type& alloc = {}) noexcept : Value(alloc) { initScalar(Type::Int, i); }
+            explicit Value(Object&& obj) noexcept : m_valueType(Type::Empty) { initObject(std::move(obj)); }
+            explicit Value(Array&& arr) noexcept : m_valueType(Type::Empty) { initArray(std::move(arr)); }
+            explicit Value(bool b, const allocator_type& alloc = {}) noexcept : Value(alloc) { initScalar(Type::Bool, static_cast<int64_t>(b)); }
+            explicit Value(std::nullptr_t, const allocator_type& alloc = {}) noexcept : Value(alloc) { m_valueType = Type::Null; }
+
+            // String value referring to the given characters instead of owning a copy, they have to outlive it.
+            // Copies of the value refer to the same characters.
+            static Value fromBorrowedString(std::string_view str, const allocator_type& alloc = {}) noexcept
+            {
+                Value value(alloc);
+                value.initBorrowedString(str);
+                return value;
+            }
+
+            allocator_type get_allocator() const noexcept
+            {
+                return allocator_type(resource());
+            }
 
             bool exists() const { return m_valueType != Type::Empty; }
-            bool isString() const { return m_valueType == Type::String; }
+            bool isString() const { return m_valueType == Type::String || m_valueType == Type::BorrowedString; }
+            bool isBorrowedString() const { return m_valueType == Type::BorrowedString; }
             bool isNumber() const { return m_valueType == Type::Float || m_valueType == Type::Int; }
             bool isFloat() const { return m_valueType == Type::Float; }
             bool isInt() const { return m_valueType == Type::Int; }
@@ -75,78 +118,67 @@ namespace ls
                 else return false;
             }
 
-            void setString(const std::string& str)
+            void setString(std::string_view str)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(str);
-                m_valueType = Type::String;
-            }
-            void setString(std::string&& str)
-            {
-                if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(std::move(str));
-                m_valueType = Type::String;
+                Value(str, get_allocator()).swapInto(*this);
             }
             void setDouble(double d)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(d);
-                m_valueType = Type::Float;
+                destroy();
+                initScalar(Type::Float, d);
             }
             void setInt(int64_t i)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(i);
-                m_valueType = Type::Int;
+                destroy();
+                initScalar(Type::Int, i);
             }
             void setObject(const Object& obj)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(obj);
-                m_valueType = Type::Object;
+                Value(Object(obj, get_allocator())).swapInto(*this);
             }
             void setObject(Object&& obj)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(std::move(obj));
-                m_valueType = Type::Object;
+                Value(Value(std::move(obj)), get_allocator()).swapInto(*this);
             }
             void setArray(const Array& arr)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(arr);
-                m_valueType = Type::Array;
+                Value(Array(arr, get_allocator())).swapInto(*this);
             }
             void setArray(Array&& arr)
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = std::make_unique<ValueUnion>(std::move(arr));
-                m_valueType = Type::Array;
+                Value(Value(std::move(arr)), get_allocator()).swapInto(*this);
             }
             void setNull()
             {
                 if (!exists()) onAttemptToModifyInexistingValue();
-                m_value = nullptr;
+                destroy();
                 m_valueType = Type::Null;
             }
 
-            Value& addMember(std::string key, Value val)
+            Value& addMember(std::string_view key, Value val)
             {
                 if (!isObject()) throw std::runtime_error("Value is not an object");
                 auto& parent = getObject();
-                return parent.try_emplace(std::move(key), std::move(val)).first->second;
+                return parent.try_emplace(key, std::move(val)).first->second;
             }
-            Value& addMember(std::string key, Array arr)
+            Value& addMember(std::string_view key, Array arr)
             {
                 if (!isObject()) throw std::runtime_error("Value is not an object");
                 auto& parent = getObject();
-                return parent.try_emplace(std::move(key), std::move(arr)).first->second;
+                return parent.try_emplace(key, Value(std::move(arr))).first->second;
             }
-            Value& addMember(std::string key, Object obj)
+            Value& addMember(std::string_view key, Object obj)
             {
                 if (!isObject()) throw std::runtime_error("Value is not an object");
                 auto& parent = getObject();
-                return parent.try_emplace(std::move(key), std::move(obj)).first->second;
+                return parent.try_emplace(key, Value(std::move(obj))).first->second;
             }
             Value& addValue(Value val)
             {
@@ -159,19 +191,23 @@ namespace ls
             {
                 if (!isArray()) throw std::runtime_error("Value is not an array");
                 auto& parent = getArray();
-                parent.emplace_back(std::move(arr));
+                parent.emplace_back(Value(std::move(arr)));
                 return parent.back();
             }
             Value& addValue(Object obj)
             {
                 if (!isArray()) throw std::runtime_error("Value is not an array");
                 auto& parent = getArray();
-                parent.emplace_back(std::move(obj));
+                parent.emplace_back(Value(std::move(obj)));
                 return parent.back();
             }
 
-            const std::string& getString() const { return m_value->getString(); }
-            const std::string& getStringOr(const std::string& def) const
+            std::string_view getString() const
+            {
+                if (isBorrowedString()) return std::string_view(m_value.scalar.borrowed.data, m_value.scalar.borrowed.size);
+                return m_value.s;
+            }
+            std::string_view getStringOr(std::string_view def) const
             {
                 if (exists())
                 {
@@ -182,7 +218,7 @@ namespace ls
                     return def;
                 }
             }
-            int64_t getInt() const { return m_value->getInt(); }
+            int64_t getInt() const { return m_value.scalar.i; }
             int64_t getIntOr(int64_t def) const
             {
                 if (exists())
@@ -194,7 +230,7 @@ namespace ls
                     return def;
                 }
             }
-            bool getBool() const { return static_cast<bool>(m_value->getInt()); }
+            bool getBool() const { return static_cast<bool>(m_value.scalar.i); }
             bool getBoolOr(bool def) const
             {
                 if (exists())
@@ -208,8 +244,8 @@ namespace ls
             }
             double getDouble() const
             {
-                if (isFloat()) return m_value->getDouble();
-                return static_cast<double>(m_value->getInt());
+                if (isFloat()) return m_value.scalar.d;
+                return static_cast<double>(m_value.scalar.i);
             }
             double getDoubleOr(double def) const
             {
@@ -223,10 +259,10 @@ namespace ls
                 }
             }
 
-            const Object& getObject() const { return m_value->getObject(); }
-            Object& getObject() { return m_value->getObject(); }
-            const Array& getArray() const { return m_value->getArray(); }
-            Array& getArray() { return m_value->getArray(); }
+            const Object& getObject() const { return m_value.obj; }
+            Object& getObject() { return m_value.obj; }
+            const Array& getArray() const { return m_value.arr; }
+            Array& getArray() { return m_value.arr; }
 
             Value& operator[](int i)
             {
@@ -280,223 +316,11 @@ namespace ls
             }
 
         private:
-            struct ValueUnion
-            {
-            public:
-                ValueUnion(const ValueUnion& other) :
-                    m_valueType(Type::Empty)
-                {
-                    switch (other.m_valueType)
-                    {
-                    case Type::String:
-                        initString(other.m_value.s);
-                        break;
-                    case Type::Double:
-                        initDouble(other.m_value.d);
-                        break;
-                    case Type::Int:
-                        initInt(other.m_value.i);
-                        break;
-                    case Type::Object:
-                        initObject(other.m_value.obj);
-                        break;
-                    case Type::Array:
-                        initArray(other.m_value.arr);
-                        break;
-                    default:
-                        break;
-                    }
-                }
-
-                ValueUnion(ValueUnion&& other) noexcept :
-                    m_valueType(Type::Empty)
-                {
-                    switch (other.m_valueType)
-                    {
-                    case Type::String:
-                        initString(std::move(other.m_value.s));
-                        break;
-                    case Type::Double:
-                        initDouble(other.m_value.d);
-                        break;
-                    case Type::Int:
-                        initInt(other.m_value.i);
-                        break;
-                    case Type::Object:
-                        initObject(std::move(other.m_value.obj));
-                        break;
-                    case Type::Array:
-                        initArray(std::move(other.m_value.arr));
-                        break;
-                    default:
-                        break;
-                    }
-
-                    other.m_valueType = Type::Empty;
-                }
-                ValueUnion(const std::string& str)
-                {
-                    initString(str);
-                }
-                ValueUnion(std::string&& str)
-                {
-                    initString(std::move(str));
-                }
-                ValueUnion(double d)
-                {
-                    initDouble(d);
-                }
-                ValueUnion(int64_t i)
-                {
-                    initInt(i);
-                }
-                ValueUnion(const Object& obj)
-                {
-                    initObject(obj);
-                }
-                ValueUnion(Object&& obj)
-                {
-                    initObject(std::move(obj));
-                }
-                ValueUnion(const Array& arr)
-                {
-                    initArray(arr);
-                }
-                ValueUnion(Array&& arr)
-                {
-                    initArray(std::move(arr));
-                }
-                ~ValueUnion()
-                {
-                    destroy();
-                }
-
-                const std::string& getString() const
-                {
-                    return m_value.s;
-                }
-                std::string& getString()
-                {
-                    return m_value.s;
-                }
-                double getDouble() const
-                {
-                    return m_value.d;
-                }
-                int64_t getInt() const
-                {
-                    return m_value.i;
-                }
-                const Object& getObject() const
-                {
-                    return m_value.obj;
-                }
-                Object& getObject()
-                {
-                    return m_value.obj;
-                }
-                const Array& getArray() const
-                {
-                    return m_value.arr;
-                }
-                Array& getArray()
-                {
-                    return m_value.arr;
-                }
-
-            private:
-                enum struct Type
-                {
-                    Empty,
-                    String,
-                    Double,
-                    Int,
-                    Object,
-                    Array
-                };
-
-                union U
-                {
-                    std::string s;
-                    double d;
-                    int64_t i;
-                    Object obj;
-                    Array arr;
-
-                    U() noexcept {}
-                    ~U() {}
-                } m_value;
-
-                Type m_valueType;
-
-                void destroy()
-                {
-                    if (m_valueType == Type::Empty) return;
-
-                    switch (m_valueType)
-                    {
-                    case Type::String:
-                        (&m_value.s)->std::string::~string();
-                        break;
-                    case Type::Object:
-                        (&m_value.obj)->Object::~Object();
-                        break;
-                    case Type::Array:
-                        (&m_value.arr)->Array::~Array();
-                        break;
-                    default:
-                        break;
-                    }
-
-                    m_valueType = Type::Empty;
-                }
-
-                void initString(const std::string& str)
-                {
-                    new (&m_value.s) std::string(str);
-                    m_valueType = Type::String;
-                }
-                void initString(std::string& str)
-                {
-                    new (&m_value.s) std::string(std::move(str));
-                    m_valueType = Type::String;
-                }
-                void initDouble(double d)
-                {
-                    new (&m_value.d) double(d);
-                    m_valueType = Type::Double;
-                }
-                void initInt(int64_t i)
-                {
-                    new (&m_value.i) int64_t(i);
-                    m_valueType = Type::Int;
-                }
-                void initObject(const Object& obj)
-                {
-                    new (&m_value.obj) Object(obj);
-                    m_valueType = Type::Object;
-                }
-                void initObject(Object&& obj)
-                {
-                    new (&m_value.obj) Object(std::move(obj));
-                    m_valueType = Type::Object;
-                }
-                void initArray(const Array& arr)
-                {
-                    new (&m_value.arr) Array(arr);
-                    m_valueType = Type::Array;
-                }
-                void initArray(Array&& arr)
-                {
-                    new (&m_value.arr) Array(std::move(arr));
-                    m_valueType = Type::Array;
-                }
-            };
-
             enum struct Type
             {
                 Empty,
                 String,
+                BorrowedString,
                 Float,
                 Int,
                 Object,
@@ -505,7 +329,36 @@ namespace ls
                 Null
             };
 
-            std::unique_ptr<ValueUnion> m_value;
+            //bools are stored as ints
+            //the resource is kept so that a value can become a string or a container later
+            struct BorrowedStringStorage
+            {
+                const char* data;
+                size_t size;
+            };
+
+            struct ScalarStorage
+            {
+                union
+                {
+                    double d;
+                    int64_t i;
+                    BorrowedStringStorage borrowed;
+                };
+                std::pmr::memory_resource* resource;
+            };
+
+            union Storage
+            {
+                String s;
+                ScalarStorage scalar;
+                Object obj;
+                Array arr;
+
+                Storage() noexcept {}
+                ~Storage() {}
+            } m_value;
+
             Type m_valueType;
 
             static Value& emptyValue()
@@ -518,6 +371,160 @@ namespace ls
             {
                 throw std::runtime_error("Cannot modify inexisting value");
             }
+
+            //new value is fully constructed before the old one is destroyed, so this may be its parent
+            void swapInto(Value& target) noexcept
+            {
+                Value old(std::move(target));
+                target.initFrom(std::move(*this));
+            }
+
+            std::pmr::memory_resource* resource() const noexcept
+            {
+                switch (m_valueType)
+                {
+                case Type::String:
+                    return m_value.s.get_allocator().resource();
+                case Type::Object:
+                    return m_value.obj.get_allocator().resource();
+                case Type::Array:
+                    return m_value.arr.get_allocator().resource();
+                default:
+                    return m_value.scalar.resource;
+                }
+            }
+
+            //for trees whose memory is released all at once, no destructors are run
+            void abandon() noexcept
+            {
+                m_value.scalar.resource = std::pmr::null_memory_resource();
+                m_valueType = Type::Empty;
+            }
+
+            //the resource is kept
+            void destroy() noexcept
+            {
+                std::pmr::memory_resource* const res = resource();
+                switch (m_valueType)
+                {
+                case Type::String:
+                    m_value.s.~basic_string();
+                    break;
+                case Type::Object:
+                    m_value.obj.~Object();
+                    break;
+                case Type::Array:
+                    m_value.arr.~Array();
+                    break;
+                default:
+                    break;
+                }
+
+                m_value.scalar.resource = res;
+                m_valueType = Type::Empty;
+            }
+
+            //value must be empty, the copy uses the given resource
+            void initFrom(const Value& other, std::pmr::memory_resource* res)
+            {
+                switch (other.m_valueType)
+                {
+                case Type::String:
+                    initString(String(other.m_value.s, res));
+                    break;
+                case Type::Object:
+                    initObject(Object(other.m_value.obj, res));
+                    break;
+                case Type::Array:
+                    initArray(Array(other.m_value.arr, res));
+                    break;
+                case Type::Float:
+                    m_value.scalar.resource = res;
+                    initScalar(Type::Float, other.m_value.scalar.d);
+                    break;
+                case Type::Int:
+                case Type::Bool:
+                    m_value.scalar.resource = res;
+                    initScalar(other.m_valueType, other.m_value.scalar.i);
+                    break;
+                case Type::BorrowedString:
+                    m_value.scalar.resource = res;
+                    initBorrowedString(other.getString());
+                    break;
+                default:
+                    m_value.scalar.resource = res;
+                    m_valueType = other.m_valueType;
+                    break;
+                }
+            }
+
+            //value must be empty, the resource is taken from other, other is left empty
+            void initFrom(Value&& other) noexcept
+            {
+                switch (other.m_valueType)
+                {
+                case Type::String:
+                    initString(std::move(other.m_value.s));
+                    break;
+                case Type::Object:
+                    initObject(std::move(other.m_value.obj));
+                    break;
+                case Type::Array:
+                    initArray(std::move(other.m_value.arr));
+                    break;
+                case Type::Float:
+                    m_value.scalar.resource = other.m_value.scalar.resource;
+                    initScalar(Type::Float, other.m_value.scalar.d);
+                    break;
+                case Type::Int:
+                case Type::Bool:
+                    m_value.scalar.resource = other.m_value.scalar.resource;
+                    initScalar(other.m_valueType, other.m_value.scalar.i);
+                    break;
+                case Type::BorrowedString:
+                    m_value.scalar.resource = other.m_value.scalar.resource;
+                    initBorrowedString(other.getString());
+                    break;
+                default:
+                    m_value.scalar.resource = other.m_value.scalar.resource;
+                    m_valueType = other.m_valueType;
+                    break;
+                }
+
+                other.destroy();
+            }
+
+            void initString(String&& str) noexcept
+            {
+                new (&m_value.s) String(std::move(str));
+                m_valueType = Type::String;
+            }
+            void initBorrowedString(std::string_view str) noexcept
+            {
+                m_value.scalar.borrowed.data = str.data();
+                m_value.scalar.borrowed.size = str.size();
+                m_valueType = Type::BorrowedString;
+            }
+            void initScalar(Type type, double d) noexcept
+            {
+                m_value.scalar.d = d;
+                m_valueType = type;
+            }
+            void initScalar(Type type, int64_t i) noexcept
+            {
+                m_value.scalar.i = i;
+                m_valueType = type;
+            }
+            void initObject(Object&& obj) noexcept
+            {
+                new (&m_value.obj) Object(std::move(obj));
+                m_valueType = Type::Object;
+            }
+            void initArray(Array&& arr) noexcept
+            {
+                new (&m_value.arr) Array(std::move(arr));
+                m_valueType = Type::Array;
+            }
         };
     }
-}
\ No newline at end of file
+}
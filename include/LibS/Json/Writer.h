@@ -3,6 +3,7 @@
 #include "Value.h"
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 namespace ls
@@ -191,7 +192,7 @@ namespace ls
                     newLine();
                 }
             }
-            void key(const std::string& key)
+            void key(std::string_view key)
             {
                 writeString(key);
                 m_result.append(m_params.spacesAfterKey, ' ');
@@ -204,7 +205,7 @@ namespace ls
                 if (b) m_result += "true";
                 else m_result += "false";
             }
-            void writeString(const std::string& str)
+            void writeString(std::string_view str)
             {
                 m_result += '\"';
                 m_result += str;
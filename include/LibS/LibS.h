@@ -7,6 +7,8 @@
 
 #include "Common.h"
 #include "Utility.h"
+#include "Simd.h"
+#include "ThreadPool.h"
 
 #include "Algorithms.h"
 #include "Bezier.h"
@@ -2,5 +2,9 @@
 
 #include "Noise/NoiseUtil.h"
 #include "Noise/NoiseSampler.h"
+#include "Noise/FractalNoiseSampler.h"
+#include "Noise/FixedOctaveNoiseSampler.h"
+#include "Noise/NoiseFieldGenerator.h"
+#include "Noise/NoiseTileCache.h"
 #include "Noise/PerlinNoise.h"
 #include "Noise/SimplexNoise.h"
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "LibS/Shapes/Fwd.h"
+
+#include "NoiseUtil.h"
+
+#include "Fwd.h"
+
+#include <array>
+#include <limits>
+#include <ratio>
+#include <type_traits>
+#include <utility>
+
+namespace ls
+{
+    namespace detail
+    {
+        // Octave amplitudes for a persistence given as a std::ratio.
+        template <typename T, int OctavesV, typename PersistenceT>
+        struct FixedOctaveAmplitudes
+        {
+            static constexpr T persistence = T(PersistenceT::num) / T(PersistenceT::den);
+
+            static constexpr std::array<T, OctavesV> makeAmplitudes()
+            {
+                std::array<T, OctavesV> result{};
+                T amplitude = T(1);
+                for (int i = 0; i < OctavesV; ++i)
+                {
+                    result[i] = amplitude;
+                    amplitude *= persistence;
+                }
+                return result;
+            }
+
+            static constexpr T makeInvAmplitudeSum()
+            {
+                T amplitude = T(1);
+                T amplitudeSum = T(0);
+                for (int i = 0; i < OctavesV; ++i)
+                {
+                    amplitudeSum += amplitude;
+                    amplitude *= persistence;
+                }
+                return T(1) / amplitudeSum;
+            }
+
+            static constexpr std::array<T, OctavesV> amplitudes = makeAmplitudes();
+            static constexpr T invAmplitudeSum = makeInvAmplitudeSum();
+        };
+    }
+
+    // NoiseSampler with the number of octaves known at compile time.
+    // The octave loop is fully unrolled and the amplitude normalization is a multiplication
+    // by a precomputed 1/amplitudeSum. Per octave frequencies and periods are computed
+    // when the sampler is configured, not per sample.
+    // PersistenceT may be a std::ratio, then amplitudes are compile time constants
+    // and setPersistence is not available.
+    // Results can differ from NoiseSampler in the last bit because of the reciprocal.
+    template <typename T, int DimV, int OctavesV, typename PersistenceT>
+    struct FixedOctaveNoiseSampler
+    {
+        static_assert(OctavesV >= 1, "There has to be at least one octave");
+
+    public:
+        using ValueType = T;
+        using VectorType = VecT<ValueType, DimV>;
+        using VectorTypeI = VecT<int, DimV>;
+        static constexpr int dim = DimV;
+        static constexpr int octaves = OctavesV;
+        static constexpr bool hasFixedPersistence = !std::is_void<PersistenceT>::value;
+
+        FixedOctaveNoiseSampler() noexcept :
+            m_scale(1),
+            m_persistence(1)
+        {
+            removePeriod();
+            updateFrequencies();
+            updateAmplitudes();
+        }
+
+        template <typename NoiseGenT>
+        ValueType sample(const VectorType& pos, NoiseGenT&& gen) const
+        {
+            return sampleOctaves(pos, gen, std::make_integer_sequence<int, OctavesV>{});
+        }
+
+        template <typename NoiseGenT, typename RetT = decltype(std::declval<NoiseGenT>().rawDerivative(std::declval<VectorType>(), std::declval<VectorTypeI>()))>
+        RetT sampleDerivative(const VectorType& pos, NoiseGenT&& gen) const
+        {
+            return sampleDerivativeOctaves<RetT>(pos, gen, std::make_integer_sequence<int, OctavesV>{});
+        }
+
+        void setScale(const VectorType& newScale)
+        {
+            m_scale = newScale;
+            updateFrequencies();
+        }
+
+        template <typename P = PersistenceT, typename EnableT = std::enable_if_t<std::is_void<P>::value>>
+        void setPersistence(ValueType newPersistence)
+        {
+            m_persistence = newPersistence;
+            updateAmplitudes();
+        }
+
+        void setPeriod(const VectorTypeI& newPeriod)
+        {
+            m_periods[0] = newPeriod;
+            updatePeriods();
+        }
+
+        void removePeriod()
+        {
+            setPeriod(VectorTypeI(std::numeric_limits<int>::max()));
+        }
+
+        const VectorType& scale() const
+        {
+            return m_scale;
+        }
+
+        ValueType persistence() const
+        {
+            if constexpr (hasFixedPersistence)
+            {
+                return FixedAmplitudes::persistence;
+            }
+            else
+            {
+                return m_persistence;
+            }
+        }
+
+        const VectorTypeI& period() const
+        {
+            return m_periods[0];
+        }
+
+    private:
+        using FixedAmplitudes = detail::FixedOctaveAmplitudes<ValueType, OctavesV, PersistenceT>;
+
+        VectorType m_scale;
+        ValueType m_persistence;
+        ValueType m_invAmplitudeSum;
+
+        std::array<VectorType, OctavesV> m_frequencies;
+        std::array<VectorTypeI, OctavesV> m_periods;
+        std::array<ValueType, OctavesV> m_amplitudes;
+
+        template <typename NoiseGenT, int... OctaveIs>
+        ValueType sampleOctaves(const VectorType& pos, NoiseGenT& gen, std::integer_sequence<int, OctaveIs...>) const
+        {
+            if constexpr (OctavesV == 1)
+            {
+                return gen.raw(pos * m_frequencies[0], m_periods[0]);
+            }
+            else
+            {
+                return (... + (gen.raw(pos * m_frequencies[OctaveIs], m_periods[OctaveIs]) * amplitude<OctaveIs>())) * invAmplitudeSum();
+            }
+        }
+
+        template <typename RetT, typename NoiseGenT, int... OctaveIs>
+        RetT sampleDerivativeOctaves(const VectorType& pos, NoiseGenT& gen, std::integer_sequence<int, OctaveIs...>) const
+        {
+            if constexpr (OctavesV == 1)
+            {
+                return gen.rawDerivative(pos * m_frequencies[0], m_periods[0]);
+            }
+            else
+            {
+                return (... + (gen.rawDerivative(pos * m_frequencies[OctaveIs], m_periods[OctaveIs]) * amplitude<OctaveIs>())) * invAmplitudeSum();
+            }
+        }
+
+        template <int OctaveI>
+        ValueType amplitude() const
+        {
+            if constexpr (hasFixedPersistence)
+            {
+                return std::get<OctaveI>(FixedAmplitudes::amplitudes);
+            }
+            else
+            {
+                return m_amplitudes[OctaveI];
+            }
+        }
+
+        ValueType invAmplitudeSum() const
+        {
+            if constexpr (hasFixedPersistence)
+            {
+                return FixedAmplitudes::invAmplitudeSum;
+            }
+            else
+            {
+                return m_invAmplitudeSum;
+            }
+        }
+
+        void updateFrequencies()
+        {
+            m_frequencies[0] = m_scale;
+            for (int i = 1; i < OctavesV; ++i)
+            {
+                m_frequencies[i] = m_frequencies[i - 1] * ValueType(2);
+            }
+        }
+
+        void updatePeriods()
+        {
+            for (int i = 1; i < OctavesV; ++i)
+            {
+                m_periods[i] = m_periods[i - 1];
+                detail::doublePeriod(m_periods[i]);
+            }
+        }
+
+        void updateAmplitudes()
+        {
+            ValueType amplitude = ValueType(1);
+            ValueType amplitudeSum = ValueType(0);
+            for (int i = 0; i < OctavesV; ++i)
+            {
+                m_amplitudes[i] = amplitude;
+                amplitudeSum += amplitude;
+                amplitude *= m_persistence;
+            }
+            m_invAmplitudeSum = ValueType(1) / amplitudeSum;
+        }
+    };
+}
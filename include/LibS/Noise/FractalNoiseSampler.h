@@ -0,0 +1,300 @@
+#pragma once
+
+#include "LibS/Shapes/Fwd.h"
+
+#include "NoiseSampler.h"
+#include "NoiseUtil.h"
+
+#include "Fwd.h"
+
+#include <type_traits>
+#include <utility>
+#include <cmath>
+
+namespace ls
+{
+    enum struct FractalNoiseType
+    {
+        Fbm,    // sum of octaves
+        Ridged, // sum of (1 - |octave|)^2, sharp ridges where octaves cross 0
+        Billow  // sum of |octave|, rounded bumps
+    };
+
+    // NoiseSampler with selectable octave shaping and domain warping.
+    // Octaves are evaluated in one loop that carries the value and the gradient in locals,
+    // frequencies and periods are updated incrementally like in NoiseSampler::sample.
+    // Unlike NoiseSampler::sampleDerivative derivatives are with respect to the sampled position,
+    // ie. each octave's gradient is scaled by its frequency.
+    // Every octave is remapped to [-1, 1] before weighting, so results stay in [-1, 1].
+    // The batch functions hide NoiseSampler's and produce the values of sample,
+    // or of sampleWarped when warping is enabled with setWarped.
+    template <typename T, int DimV>
+    struct FractalNoiseSampler : NoiseSampler<T, DimV>
+    {
+    public:
+        using BaseType = NoiseSampler<T, DimV>;
+        using ValueType = typename BaseType::ValueType;
+        using VectorType = typename BaseType::VectorType;
+        using VectorTypeI = typename BaseType::VectorTypeI;
+        using SizeType = typename BaseType::SizeType;
+        using ValueDerivativePairType = ValueDerivativePair<T, DimV>;
+        static constexpr int dim = DimV;
+
+    protected:
+        FractalNoiseType m_type;
+        ValueType m_warpStrength;
+        bool m_isWarped;
+
+    public:
+        FractalNoiseSampler() noexcept :
+            BaseType(),
+            m_type(FractalNoiseType::Fbm),
+            m_warpStrength(1),
+            m_isWarped(false)
+        {
+        }
+
+        template <typename NoiseGenT>
+        ValueType sample(const VectorType& pos, NoiseGenT&& gen) const
+        {
+            VectorType frequency = this->m_scale;
+            VectorTypeI period = this->m_period;
+
+            ValueType total = ValueType(0);
+            ValueType amplitude = ValueType(1);
+            ValueType amplitudeSum = ValueType(0);
+
+            for (int i = 0; i < this->m_octaves; ++i)
+            {
+                total += shape(gen.raw(pos * frequency, period)) * amplitude;
+
+                frequency *= ValueType(2);
+                detail::doublePeriod(period);
+                amplitudeSum += amplitude;
+                amplitude *= this->m_persistence;
+            }
+
+            return total / amplitudeSum;
+        }
+
+        // Requires gen.rawDerivative. The value comes from rawDerivative too, so it is
+        // consistent with the derivative (for SimplexNoise it uses other gradients than raw).
+        template <typename NoiseGenT>
+        ValueDerivativePairType sampleDerivative(const VectorType& pos, NoiseGenT&& gen) const
+        {
+            VectorType frequency = this->m_scale;
+            VectorTypeI period = this->m_period;
+
+            ValueType total = ValueType(0);
+            VectorType derivative = VectorType(ValueType(0));
+            ValueType amplitude = ValueType(1);
+            ValueType amplitudeSum = ValueType(0);
+
+            for (int i = 0; i < this->m_octaves; ++i)
+            {
+                const auto octave = gen.rawDerivative(pos * frequency, period);
+                const ValueType slope = shapeSlope(octave.value) * amplitude;
+                total += shape(octave.value) * amplitude;
+                derivative += octave.derivative * frequency * slope;
+
+                frequency *= ValueType(2);
+                detail::doublePeriod(period);
+                amplitudeSum += amplitude;
+                amplitude *= this->m_persistence;
+            }
+
+            return ValueDerivativePairType(total / amplitudeSum, derivative / amplitudeSum);
+        }
+
+        // Samples at pos + warpStrength * q(pos), where each component of q
+        // is this sampler evaluated at an offset copy of pos.
+        template <typename NoiseGenT, int D = DimV, typename EnableT = std::enable_if_t<D >= 2>>
+        ValueType sampleWarped(const VectorType& pos, NoiseGenT&& gen) const
+        {
+            VectorType warp;
+            for (int i = 0; i < DimV; ++i)
+            {
+                warp[i] = sample(pos + warpOffset(i), gen);
+            }
+
+            return sample(pos + warp * m_warpStrength, gen);
+        }
+
+        // The derivative goes through the warp, d/dp f(p + s*q(p)) = (I + s*Jq)^T * grad f.
+        template <typename NoiseGenT, int D = DimV, typename EnableT = std::enable_if_t<D >= 2>>
+        ValueDerivativePairType sampleWarpedDerivative(const VectorType& pos, NoiseGenT&& gen) const
+        {
+            VectorType warp;
+            VectorType warpDerivatives[DimV];
+            for (int i = 0; i < DimV; ++i)
+            {
+                const ValueDerivativePairType q = sampleDerivative(pos + warpOffset(i), gen);
+                warp[i] = q.value;
+                warpDerivatives[i] = q.derivative;
+            }
+
+            ValueDerivativePairType result = sampleDerivative(pos + warp * m_warpStrength, gen);
+            VectorType derivative = result.derivative;
+            for (int i = 0; i < DimV; ++i)
+            {
+                derivative += warpDerivatives[i] * (result.derivative[i] * m_warpStrength);
+            }
+            result.derivative = derivative;
+
+            return result;
+        }
+
+        // Same positions as NoiseSampler::sampleSpan.
+        template <typename NoiseGenT>
+        void sampleSpan(const VectorType& origin, const VectorType& step, SizeType count, ValueType* out, NoiseGenT&& gen) const
+        {
+            BaseType::fillSpan(origin, step, count, out, [&](const VectorType& pos) { return samplePoint(pos, gen); });
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGrid(Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& stepX, const VectorType& stepY, NoiseGenT&& gen) const
+        {
+            sampleGridRegion(out, origin, stepX, stepY, 0, 0, out.width(), out.height(), std::forward<NoiseGenT>(gen));
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, int D = DimV, typename EnableT = std::enable_if_t<D == 2>>
+        void sampleGrid(Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& step, NoiseGenT&& gen) const
+        {
+            sampleGrid(out, origin, VectorType(step.x, ValueType(0)), VectorType(ValueType(0), step.y), std::forward<NoiseGenT>(gen));
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGrid(Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& stepX, const VectorType& stepY, const VectorType& stepZ, NoiseGenT&& gen) const
+        {
+            sampleGridRegion(out, origin, stepX, stepY, stepZ, 0, 0, 0, out.width(), out.height(), out.depth(), std::forward<NoiseGenT>(gen));
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, int D = DimV, typename EnableT = std::enable_if_t<D == 3>>
+        void sampleGrid(Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& step, NoiseGenT&& gen) const
+        {
+            sampleGrid(
+                out,
+                origin,
+                VectorType(step.x, ValueType(0), ValueType(0)),
+                VectorType(ValueType(0), step.y, ValueType(0)),
+                VectorType(ValueType(0), ValueType(0), step.z),
+                std::forward<NoiseGenT>(gen)
+            );
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGridRegion(
+            Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out,
+            const VectorType& origin, const VectorType& stepX, const VectorType& stepY,
+            SizeType beginX, SizeType beginY, SizeType endX, SizeType endY,
+            NoiseGenT&& gen) const
+        {
+            BaseType::fillGridRegion(out, origin, stepX, stepY, beginX, beginY, endX, endY,
+                [&](const VectorType& pos) { return samplePoint(pos, gen); });
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGridRegion(
+            Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out,
+            const VectorType& origin, const VectorType& stepX, const VectorType& stepY, const VectorType& stepZ,
+            SizeType beginX, SizeType beginY, SizeType beginZ, SizeType endX, SizeType endY, SizeType endZ,
+            NoiseGenT&& gen) const
+        {
+            BaseType::fillGridRegion(out, origin, stepX, stepY, stepZ, beginX, beginY, beginZ, endX, endY, endZ,
+                [&](const VectorType& pos) { return samplePoint(pos, gen); });
+        }
+
+        void setType(FractalNoiseType newType)
+        {
+            m_type = newType;
+        }
+        void setWarpStrength(ValueType newWarpStrength)
+        {
+            m_warpStrength = newWarpStrength;
+        }
+        // Whether the batch functions sample with sampleWarped.
+        template <int D = DimV, typename EnableT = std::enable_if_t<D >= 2>>
+        void setWarped(bool newIsWarped)
+        {
+            m_isWarped = newIsWarped;
+        }
+
+        FractalNoiseType type() const
+        {
+            return m_type;
+        }
+        ValueType warpStrength() const
+        {
+            return m_warpStrength;
+        }
+        bool isWarped() const
+        {
+            return m_isWarped;
+        }
+
+    private:
+        template <typename NoiseGenT>
+        ValueType samplePoint(const VectorType& pos, NoiseGenT& gen) const
+        {
+            if constexpr (DimV >= 2)
+            {
+                if (m_isWarped) return sampleWarped(pos, gen);
+            }
+
+            return sample(pos, gen);
+        }
+
+        ValueType shape(ValueType n) const
+        {
+            using std::abs;
+
+            switch (m_type)
+            {
+            case FractalNoiseType::Ridged:
+            {
+                const ValueType r = ValueType(1) - abs(n);
+                return r * r * ValueType(2) - ValueType(1);
+            }
+            case FractalNoiseType::Billow:
+                return abs(n) * ValueType(2) - ValueType(1);
+            default:
+                return n;
+            }
+        }
+
+        // derivative of shape at n
+        ValueType shapeSlope(ValueType n) const
+        {
+            using std::abs;
+
+            const ValueType sign = n < ValueType(0) ? ValueType(-1) : ValueType(1);
+            switch (m_type)
+            {
+            case FractalNoiseType::Ridged:
+                return (ValueType(1) - abs(n)) * sign * ValueType(-4);
+            case FractalNoiseType::Billow:
+                return sign * ValueType(2);
+            default:
+                return ValueType(1);
+            }
+        }
+
+        // arbitrary offsets decorrelating the components of the warp
+        static VectorType warpOffset(int component)
+        {
+            return VectorType(ValueType(component + 1) * ValueType(37.719));
+        }
+    };
+
+    using FractalNoiseSampler1D = FractalNoiseSampler<double, 1>;
+    using FractalNoiseSampler1F = FractalNoiseSampler<float, 1>;
+
+    using FractalNoiseSampler2D = FractalNoiseSampler<double, 2>;
+    using FractalNoiseSampler2F = FractalNoiseSampler<float, 2>;
+
+    using FractalNoiseSampler3D = FractalNoiseSampler<double, 3>;
+    using FractalNoiseSampler3F = FractalNoiseSampler<float, 3>;
+
+    using FractalNoiseSampler4D = FractalNoiseSampler<double, 4>;
+    using FractalNoiseSampler4F = FractalNoiseSampler<float, 4>;
+}
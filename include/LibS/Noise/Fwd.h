@@ -7,10 +7,26 @@ namespace ls
     template <typename T, int DimV>
     struct NoiseSampler;
 
+    enum struct FractalNoiseType;
+
+    template <typename T, int DimV>
+    struct FractalNoiseSampler;
+
+    template <typename T, int DimV, int OctavesV, typename PersistenceT = void>
+    struct FixedOctaveNoiseSampler;
+
+    struct NoiseFieldGenerator;
+
+    template <typename T>
+    struct NoiseTileCache;
+
     template <int SizeV, typename IntT = std::uint32_t>
     struct PermTable;
 
     struct OriginalPerlinPermTable;
+    struct CompactPermTable;
+    struct IntegerHash;
+    struct SeededIntegerHash;
 
     template <typename T, int DimV>
     struct ValueDerivativePair;
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "LibS/Containers/Array2.h"
+#include "LibS/Containers/Array3.h"
+
+#include "LibS/Detail.h"
+#include "LibS/ThreadPool.h"
+
+#include "NoiseSampler.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+namespace ls
+{
+    // Fills arrays with noise in parallel by splitting them into tiles.
+    // Every cell is sampled at a position computed from its global indices,
+    // so the result does not depend on the tile size or the number of threads
+    // and is the same as from the sampler's sampleGrid.
+    // Samplers are taken by their own type, so NoiseSampler and FractalNoiseSampler
+    // each fill the tiles with their own sampleGridRegion.
+    struct NoiseFieldGenerator
+    {
+    public:
+        using SizeType = detail::SizeType;
+
+        explicit NoiseFieldGenerator(ThreadPool& pool, SizeType tileSize = 64) :
+            m_pool(&pool)
+        {
+            setTileSize(tileSize);
+        }
+
+        void setTileSize(SizeType newTileSize)
+        {
+            if (newTileSize <= 0)
+            {
+                throw std::runtime_error("Tile size must be positive.");
+            }
+
+            m_tileSize = newTileSize;
+        }
+
+        SizeType tileSize() const
+        {
+            return m_tileSize;
+        }
+
+        ThreadPool& pool() const
+        {
+            return *m_pool;
+        }
+
+        // Each tile uses its own copy of gen, so generators don't have to be thread safe.
+        template <typename T, typename SamplerT, typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void generate(
+            Array2<T, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out,
+            const SamplerT& sampler,
+            const typename SamplerT::VectorType& origin,
+            const typename SamplerT::VectorType& stepX,
+            const typename SamplerT::VectorType& stepY,
+            const NoiseGenT& gen) const
+        {
+            const SizeType width = out.width();
+            const SizeType height = out.height();
+            const SizeType numTilesX = numTiles(width);
+            const SizeType numTilesY = numTiles(height);
+
+            m_pool->parallelFor(0, numTilesX * numTilesY, [&](SizeType tile) {
+                // consecutive tiles go down a column, which is contiguous in memory
+                const SizeType beginX = (tile / numTilesY) * m_tileSize;
+                const SizeType beginY = (tile % numTilesY) * m_tileSize;
+                const SizeType endX = std::min(beginX + m_tileSize, width);
+                const SizeType endY = std::min(beginY + m_tileSize, height);
+
+                NoiseGenT localGen(gen);
+                sampler.sampleGridRegion(out, origin, stepX, stepY, beginX, beginY, endX, endY, localGen);
+            });
+        }
+
+        template <typename T, typename SamplerT, typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, typename EnableT = std::enable_if_t<SamplerT::dim == 2>>
+        void generate(
+            Array2<T, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out,
+            const SamplerT& sampler,
+            const Vec2<T>& origin,
+            const Vec2<T>& step,
+            const NoiseGenT& gen) const
+        {
+            generate(out, sampler, origin, Vec2<T>(step.x, T(0)), Vec2<T>(T(0), step.y), gen);
+        }
+
+        template <typename T, typename SamplerT, typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void generate(
+            Array3<T, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out,
+            const SamplerT& sampler,
+            const typename SamplerT::VectorType& origin,
+            const typename SamplerT::VectorType& stepX,
+            const typename SamplerT::VectorType& stepY,
+            const typename SamplerT::VectorType& stepZ,
+            const NoiseGenT& gen) const
+        {
+            const SizeType width = out.width();
+            const SizeType height = out.height();
+            const SizeType depth = out.depth();
+            const SizeType numTilesX = numTiles(width);
+            const SizeType numTilesY = numTiles(height);
+            const SizeType numTilesZ = numTiles(depth);
+
+            m_pool->parallelFor(0, numTilesX * numTilesY * numTilesZ, [&](SizeType tile) {
+                const SizeType beginX = (tile / (numTilesY * numTilesZ)) * m_tileSize;
+                const SizeType beginY = ((tile / numTilesZ) % numTilesY) * m_tileSize;
+                const SizeType beginZ = (tile % numTilesZ) * m_tileSize;
+                const SizeType endX = std::min(beginX + m_tileSize, width);
+                const SizeType endY = std::min(beginY + m_tileSize, height);
+                const SizeType endZ = std::min(beginZ + m_tileSize, depth);
+
+                NoiseGenT localGen(gen);
+                sampler.sampleGridRegion(out, origin, stepX, stepY, stepZ, beginX, beginY, beginZ, endX, endY, endZ, localGen);
+            });
+        }
+
+        template <typename T, typename SamplerT, typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, typename EnableT = std::enable_if_t<SamplerT::dim == 3>>
+        void generate(
+            Array3<T, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out,
+            const SamplerT& sampler,
+            const Vec3<T>& origin,
+            const Vec3<T>& step,
+            const NoiseGenT& gen) const
+        {
+            generate(out, sampler, origin, Vec3<T>(step.x, T(0), T(0)), Vec3<T>(T(0), step.y, T(0)), Vec3<T>(T(0), T(0), step.z), gen);
+        }
+
+    private:
+        ThreadPool* m_pool;
+        SizeType m_tileSize;
+
+        SizeType numTiles(SizeType size) const
+        {
+            return (size + m_tileSize - 1) / m_tileSize;
+        }
+    };
+}
@@ -1,11 +1,18 @@
 #pragma once
 
 #include "LibS/Shapes/Fwd.h"
+#include "LibS/Containers/Array2.h"
+#include "LibS/Containers/Array3.h"
 
 #include "LibS/Common.h"
+#include "LibS/Detail.h"
+
+#include "NoiseUtil.h"
 
 #include <type_traits>
+#include <utility>
 #include <limits>
+#include <vector>
 
 namespace ls
 {
@@ -16,6 +23,7 @@ namespace ls
         using ValueType = T;
         using VectorType = VecT<ValueType, DimV>;
         using VectorTypeI = VecT<int, DimV>;
+        using SizeType = detail::SizeType;
         static constexpr int dim = DimV;
 
     protected:
@@ -63,7 +71,7 @@ namespace ls
                 total += gen.raw(pos * frequency, period) * amplitude;
 
                 frequency *= ValueType(2);
-                doublePeriod(period);
+                detail::doublePeriod(period);
                 amplitudeSum += amplitude;
                 amplitude *= m_persistence;
             }
@@ -71,7 +79,7 @@ namespace ls
             return total / amplitudeSum;
         }
 
-        template <typename NoiseGenT, typename RetT = decltype(m_noiseGen.rawDerivative(declval<VectorType>(), declval<VectorTypeI>()))>
+        template <typename NoiseGenT, typename RetT = decltype(std::declval<NoiseGenT>().rawDerivative(std::declval<VectorType>(), std::declval<VectorTypeI>()))>
         RetT sampleDerivative(const VectorType& pos, NoiseGenT&& gen)
         {
             VectorType frequency = m_scale;
@@ -95,7 +103,7 @@ namespace ls
                 total += gen.rawDerivative(pos * frequency, period) * amplitude;
 
                 frequency *= ValueType(2);
-                doublePeriod(period);
+                detail::doublePeriod(period);
                 amplitudeSum += amplitude;
                 amplitude *= m_persistence;
             }
@@ -103,6 +111,84 @@ namespace ls
             return total / amplitudeSum;
         }
 
+        // Fills out[0..count) with samples at origin + step * i.
+        // Produces the same values as calling sample for each position, but octave
+        // frequencies, periods and amplitudes are only computed once per call.
+        template <typename NoiseGenT>
+        void sampleSpan(const VectorType& origin, const VectorType& step, SizeType count, ValueType* out, NoiseGenT&& gen) const
+        {
+            std::vector<OctaveParams> octaves;
+            const ValueType amplitudeSum = makeOctaveParams(octaves);
+
+            fillSpan(origin, step, count, out, [&](const VectorType& pos) { return sampleOctaves(pos, octaves, amplitudeSum, gen); });
+        }
+
+        // Fills out(x, y) with samples at origin + stepX * x + stepY * y.
+        // Cells are visited row by row for row major layouts and column by column otherwise.
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGrid(Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& stepX, const VectorType& stepY, NoiseGenT&& gen) const
+        {
+            sampleGridRegion(out, origin, stepX, stepY, 0, 0, out.width(), out.height(), std::forward<NoiseGenT>(gen));
+        }
+
+        // Axis aligned lattice, out(x, y) is sampled at origin + (step.x * x, step.y * y).
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, int D = DimV, typename EnableT = std::enable_if_t<D == 2>>
+        void sampleGrid(Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& step, NoiseGenT&& gen) const
+        {
+            sampleGrid(out, origin, VectorType(step.x, ValueType(0)), VectorType(ValueType(0), step.y), std::forward<NoiseGenT>(gen));
+        }
+
+        // Fills out(x, y, z) with samples at origin + stepX * x + stepY * y + stepZ * z.
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGrid(Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& stepX, const VectorType& stepY, const VectorType& stepZ, NoiseGenT&& gen) const
+        {
+            sampleGridRegion(out, origin, stepX, stepY, stepZ, 0, 0, 0, out.width(), out.height(), out.depth(), std::forward<NoiseGenT>(gen));
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, int D = DimV, typename EnableT = std::enable_if_t<D == 3>>
+        void sampleGrid(Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out, const VectorType& origin, const VectorType& step, NoiseGenT&& gen) const
+        {
+            sampleGrid(
+                out,
+                origin,
+                VectorType(step.x, ValueType(0), ValueType(0)),
+                VectorType(ValueType(0), step.y, ValueType(0)),
+                VectorType(ValueType(0), ValueType(0), step.z),
+                std::forward<NoiseGenT>(gen)
+            );
+        }
+
+        // Fills only the cells in [beginX, endX) x [beginY, endY) of out.
+        // Positions are computed from the global cell indices exactly like in sampleGrid,
+        // so a grid filled region by region is identical to one filled at once.
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGridRegion(
+            Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out,
+            const VectorType& origin, const VectorType& stepX, const VectorType& stepY,
+            SizeType beginX, SizeType beginY, SizeType endX, SizeType endY,
+            NoiseGenT&& gen) const
+        {
+            std::vector<OctaveParams> octaves;
+            const ValueType amplitudeSum = makeOctaveParams(octaves);
+
+            fillGridRegion(out, origin, stepX, stepY, beginX, beginY, endX, endY,
+                [&](const VectorType& pos) { return sampleOctaves(pos, octaves, amplitudeSum, gen); });
+        }
+
+        template <typename NoiseGenT, SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT>
+        void sampleGridRegion(
+            Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out,
+            const VectorType& origin, const VectorType& stepX, const VectorType& stepY, const VectorType& stepZ,
+            SizeType beginX, SizeType beginY, SizeType beginZ, SizeType endX, SizeType endY, SizeType endZ,
+            NoiseGenT&& gen) const
+        {
+            std::vector<OctaveParams> octaves;
+            const ValueType amplitudeSum = makeOctaveParams(octaves);
+
+            fillGridRegion(out, origin, stepX, stepY, stepZ, beginX, beginY, beginZ, endX, endY, endZ,
+                [&](const VectorType& pos) { return sampleOctaves(pos, octaves, amplitudeSum, gen); });
+        }
+
         void setScale(const VectorType& newScale)
         {
             m_scale = newScale;
@@ -265,32 +351,141 @@ namespace ls
             return m_octaves;
         }
 
-    private:
+    protected:
+        // Loops of the batch functions, shared with derived samplers. sampleAt(pos) returns the value at pos.
+        template <typename SampleFuncT>
+        static void fillSpan(const VectorType& origin, const VectorType& step, SizeType count, ValueType* out, SampleFuncT&& sampleAt)
+        {
+            for (SizeType i = 0; i < count; ++i)
+            {
+                out[i] = sampleAt(origin + step * static_cast<ValueType>(i));
+            }
+        }
+
+        template <SizeType WidthV, SizeType HeightV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, typename SampleFuncT>
+        static void fillGridRegion(
+            Array2<ValueType, WidthV, HeightV, StorageV, LayoutT, AllocatorT>& out,
+            const VectorType& origin, const VectorType& stepX, const VectorType& stepY,
+            SizeType beginX, SizeType beginY, SizeType endX, SizeType endY,
+            SampleFuncT&& sampleAt)
+        {
+            if constexpr (LayoutT::isRowMajor)
+            {
+                for (SizeType y = beginY; y < endY; ++y)
+                {
+                    for (SizeType x = beginX; x < endX; ++x)
+                    {
+                        out(x, y) = sampleAt(gridPosition(origin, stepX, stepY, x, y));
+                    }
+                }
+            }
+            else
+            {
+                for (SizeType x = beginX; x < endX; ++x)
+                {
+                    for (SizeType y = beginY; y < endY; ++y)
+                    {
+                        out(x, y) = sampleAt(gridPosition(origin, stepX, stepY, x, y));
+                    }
+                }
+            }
+        }
 
-        static void doublePeriod(int& period)
+        template <SizeType WidthV, SizeType HeightV, SizeType DepthV, ArrayStorageType StorageV, typename LayoutT, typename AllocatorT, typename SampleFuncT>
+        static void fillGridRegion(
+            Array3<ValueType, WidthV, HeightV, DepthV, StorageV, LayoutT, AllocatorT>& out,
+            const VectorType& origin, const VectorType& stepX, const VectorType& stepY, const VectorType& stepZ,
+            SizeType beginX, SizeType beginY, SizeType beginZ, SizeType endX, SizeType endY, SizeType endZ,
+            SampleFuncT&& sampleAt)
         {
-            if (period < std::numeric_limits<int>::max() / 2) period *= 2;
+            if constexpr (LayoutT::isRowMajor)
+            {
+                for (SizeType z = beginZ; z < endZ; ++z)
+                {
+                    for (SizeType y = beginY; y < endY; ++y)
+                    {
+                        for (SizeType x = beginX; x < endX; ++x)
+                        {
+                            out(x, y, z) = sampleAt(gridPosition(origin, stepX, stepY, stepZ, x, y, z));
+                        }
+                    }
+                }
+            }
+            else
+            {
+                for (SizeType x = beginX; x < endX; ++x)
+                {
+                    for (SizeType y = beginY; y < endY; ++y)
+                    {
+                        for (SizeType z = beginZ; z < endZ; ++z)
+                        {
+                            out(x, y, z) = sampleAt(gridPosition(origin, stepX, stepY, stepZ, x, y, z));
+                        }
+                    }
+                }
+            }
         }
-        static void doublePeriod(Vec2<int>& period)
+
+        // Position of a grid cell, the same expression for every loop order so that the values don't depend on the layout.
+        static VectorType gridPosition(const VectorType& origin, const VectorType& stepX, const VectorType& stepY, SizeType x, SizeType y)
         {
-            if (period.x < std::numeric_limits<int>::max() / 2) period.x *= 2;
-            if (period.y < std::numeric_limits<int>::max() / 2) period.y *= 2;
+            return origin + stepX * static_cast<ValueType>(x) + stepY * static_cast<ValueType>(y);
         }
-        static void doublePeriod(Vec3<int>& period)
+
+        static VectorType gridPosition(const VectorType& origin, const VectorType& stepX, const VectorType& stepY, const VectorType& stepZ, SizeType x, SizeType y, SizeType z)
         {
-            if (period.x < std::numeric_limits<int>::max() / 2) period.x *= 2;
-            if (period.y < std::numeric_limits<int>::max() / 2) period.y *= 2;
-            if (period.z < std::numeric_limits<int>::max() / 2) period.z *= 2;
+            return origin + stepX * static_cast<ValueType>(x) + stepY * static_cast<ValueType>(y) + stepZ * static_cast<ValueType>(z);
         }
 
-        static void doublePeriod(Vec4<int>& period)
+    private:
+        struct OctaveParams
         {
-            if (period.x < std::numeric_limits<int>::max() / 2) period.x *= 2;
-            if (period.y < std::numeric_limits<int>::max() / 2) period.y *= 2;
-            if (period.z < std::numeric_limits<int>::max() / 2) period.z *= 2;
-            if (period.w < std::numeric_limits<int>::max() / 2) period.w *= 2;
+            VectorType frequency;
+            VectorTypeI period;
+            ValueType amplitude;
+        };
+
+        // returns the sum of amplitudes
+        ValueType makeOctaveParams(std::vector<OctaveParams>& octaves) const
+        {
+            octaves.clear();
+            octaves.reserve(m_octaves);
+
+            VectorType frequency = m_scale;
+            VectorTypeI period = m_period;
+            ValueType amplitude = ValueType(1);
+            ValueType amplitudeSum = ValueType(0);
+
+            for (int i = 0; i < m_octaves; ++i)
+            {
+                octaves.push_back(OctaveParams{ frequency, period, amplitude });
+
+                frequency *= ValueType(2);
+                detail::doublePeriod(period);
+                amplitudeSum += amplitude;
+                amplitude *= m_persistence;
+            }
+
+            return amplitudeSum;
+        }
+
+        // Accumulates in the same order as sample, so the results are identical.
+        template <typename NoiseGenT>
+        static ValueType sampleOctaves(const VectorType& pos, const std::vector<OctaveParams>& octaves, ValueType amplitudeSum, NoiseGenT& gen)
+        {
+            if (octaves.size() == 1)
+            {
+                return gen.raw(pos * octaves.front().frequency, octaves.front().period);
+            }
+
+            ValueType total = ValueType(0);
+            for (const OctaveParams& octave : octaves)
+            {
+                total += gen.raw(pos * octave.frequency, octave.period) * octave.amplitude;
+            }
+
+            return total / amplitudeSum;
         }
-        
     };
 
     using NoiseSampler1D = NoiseSampler<double, 1>;
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "LibS/Shapes/Fwd.h"
+#include "LibS/Containers/Array2.h"
+
+#include "LibS/Common.h"
+#include "LibS/Detail.h"
+
+#include "NoiseSampler.h"
+#include "FractalNoiseSampler.h"
+
+#include "Fwd.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <stdexcept>
+
+namespace ls
+{
+    // Memoizes square tiles of 2D noise sampled on a regular lattice.
+    // Tiles are keyed by their coordinates, the sampler parameters and a caller provided seed
+    // that identifies the noise generator, so one cache can serve many samplers and worlds.
+    // Samplers are NoiseSampler<T, 2> or FractalNoiseSampler<T, 2>, tiles are filled with their own sampleGrid.
+    // When the memory used by tiles exceeds the budget the least recently used ones are evicted.
+    // Lattice point (x, y) is at (x * spacing, y * spacing). A tile holds tileSize + 1 points
+    // along each axis so that bilinear lookups never need more than one tile.
+    // Not thread safe. References to tiles are invalidated by later queries.
+    template <typename T>
+    struct NoiseTileCache
+    {
+    public:
+        using ValueType = T;
+        using SizeType = detail::SizeType;
+        using TileType = Array2<T>;
+
+        NoiseTileCache(SizeType tileSize, T spacing, std::size_t memoryBudget) :
+            m_tileSize(tileSize),
+            m_spacing(spacing),
+            m_memoryBudget(memoryBudget),
+            m_memoryUsage(0),
+            m_numHits(0),
+            m_numMisses(0)
+        {
+            if (tileSize <= 0)
+            {
+                throw std::runtime_error("Tile size must be positive.");
+            }
+        }
+
+        // Returns the tile with lattice points [tx * tileSize, (tx + 1) * tileSize] x [ty * tileSize, (ty + 1) * tileSize].
+        template <typename SamplerT, typename NoiseGenT>
+        const TileType& tile(const SamplerT& sampler, NoiseGenT&& gen, std::uint64_t seed, int tx, int ty)
+        {
+            const TileKey key = makeKey(sampler, seed, tx, ty);
+
+            auto iter = m_index.find(key);
+            if (iter != m_index.end())
+            {
+                ++m_numHits;
+                m_tiles.splice(m_tiles.begin(), m_tiles, iter->second);
+                return iter->second->tile;
+            }
+
+            ++m_numMisses;
+
+            TileType tile(m_tileSize + 1, m_tileSize + 1);
+            const Vec2<T> origin(
+                static_cast<T>(static_cast<SizeType>(tx) * m_tileSize) * m_spacing,
+                static_cast<T>(static_cast<SizeType>(ty) * m_tileSize) * m_spacing
+            );
+            sampler.sampleGrid(tile, origin, Vec2<T>(m_spacing, m_spacing), gen);
+
+            m_tiles.push_front(Entry{ key, std::move(tile) });
+            m_index.emplace(key, m_tiles.begin());
+            m_memoryUsage += tileMemory();
+
+            evict();
+
+            return m_tiles.front().tile;
+        }
+
+        // Value at lattice point (x, y).
+        template <typename SamplerT, typename NoiseGenT>
+        T at(const SamplerT& sampler, NoiseGenT&& gen, std::uint64_t seed, SizeType x, SizeType y)
+        {
+            const SizeType tx = floorDiv(x);
+            const SizeType ty = floorDiv(y);
+            const TileType& t = tile(sampler, gen, seed, static_cast<int>(tx), static_cast<int>(ty));
+            return t(x - tx * m_tileSize, y - ty * m_tileSize);
+        }
+
+        // Bilinear interpolation between the cached lattice points around pos.
+        template <typename SamplerT, typename NoiseGenT>
+        T sample(const SamplerT& sampler, NoiseGenT&& gen, std::uint64_t seed, const Vec2<T>& pos)
+        {
+            const T u = pos.x / m_spacing;
+            const T v = pos.y / m_spacing;
+            const SizeType x = floorToInt<T, SizeType>(u);
+            const SizeType y = floorToInt<T, SizeType>(v);
+            const T fx = u - static_cast<T>(x);
+            const T fy = v - static_cast<T>(y);
+
+            const SizeType tx = floorDiv(x);
+            const SizeType ty = floorDiv(y);
+            const SizeType lx = x - tx * m_tileSize;
+            const SizeType ly = y - ty * m_tileSize;
+            const TileType& t = tile(sampler, gen, seed, static_cast<int>(tx), static_cast<int>(ty));
+
+            const T top = lerp(t(lx, ly), t(lx + 1, ly), fx);
+            const T bottom = lerp(t(lx, ly + 1), t(lx + 1, ly + 1), fx);
+            return lerp(top, bottom, fy);
+        }
+
+        void clear()
+        {
+            m_index.clear();
+            m_tiles.clear();
+            m_memoryUsage = 0;
+        }
+
+        void setMemoryBudget(std::size_t newMemoryBudget)
+        {
+            m_memoryBudget = newMemoryBudget;
+            evict();
+        }
+
+        SizeType tileSize() const
+        {
+            return m_tileSize;
+        }
+        T spacing() const
+        {
+            return m_spacing;
+        }
+        std::size_t memoryBudget() const
+        {
+            return m_memoryBudget;
+        }
+        std::size_t memoryUsage() const
+        {
+            return m_memoryUsage;
+        }
+        std::size_t numTiles() const
+        {
+            return m_tiles.size();
+        }
+        std::size_t numHits() const
+        {
+            return m_numHits;
+        }
+        std::size_t numMisses() const
+        {
+            return m_numMisses;
+        }
+
+    private:
+        struct TileKey
+        {
+            int tx;
+            int ty;
+            std::uint64_t seed;
+            Vec2<T> scale;
+            Vec2<int> period;
+            T persistence;
+            int octaves;
+            FractalNoiseType type;
+            bool isWarped;
+            T warpStrength;
+
+            friend bool operator==(const TileKey& lhs, const TileKey& rhs)
+            {
+                return lhs.tx == rhs.tx
+                    && lhs.ty == rhs.ty
+                    && lhs.seed == rhs.seed
+                    && lhs.scale == rhs.scale
+                    && lhs.period == rhs.period
+                    && lhs.persistence == rhs.persistence
+                    && lhs.octaves == rhs.octaves
+                    && lhs.type == rhs.type
+                    && lhs.isWarped == rhs.isWarped
+                    && lhs.warpStrength == rhs.warpStrength;
+            }
+        };
+
+        struct TileKeyHash
+        {
+            std::size_t operator()(const TileKey& key) const
+            {
+                std::size_t h = std::hash<int>{}(key.tx);
+                combine(h, std::hash<int>{}(key.ty));
+                combine(h, std::hash<std::uint64_t>{}(key.seed));
+                combine(h, std::hash<T>{}(key.scale.x));
+                combine(h, std::hash<T>{}(key.scale.y));
+                combine(h, std::hash<int>{}(key.period.x));
+                combine(h, std::hash<int>{}(key.period.y));
+                combine(h, std::hash<T>{}(key.persistence));
+                combine(h, std::hash<int>{}(key.octaves));
+                combine(h, std::hash<int>{}(static_cast<int>(key.type)));
+                combine(h, std::hash<bool>{}(key.isWarped));
+                combine(h, std::hash<T>{}(key.warpStrength));
+                return h;
+            }
+
+            static void combine(std::size_t& h, std::size_t v)
+            {
+                h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+            }
+        };
+
+        struct Entry
+        {
+            TileKey key;
+            TileType tile;
+        };
+
+        SizeType m_tileSize;
+        T m_spacing;
+        std::size_t m_memoryBudget;
+        std::size_t m_memoryUsage;
+        std::size_t m_numHits;
+        std::size_t m_numMisses;
+
+        // most recently used at the front
+        std::list<Entry> m_tiles;
+        std::unordered_map<TileKey, typename std::list<Entry>::iterator, TileKeyHash> m_index;
+
+        //plain fbm samples the same as NoiseSampler, so they share tiles
+        TileKey makeKey(const NoiseSampler<T, 2>& sampler, std::uint64_t seed, int tx, int ty) const
+        {
+            return TileKey{ tx, ty, seed, sampler.scale(), sampler.period(), sampler.persistence(), sampler.octaves(), FractalNoiseType::Fbm, false, T(0) };
+        }
+
+        //warp strength only matters when the warp is used
+        TileKey makeKey(const FractalNoiseSampler<T, 2>& sampler, std::uint64_t seed, int tx, int ty) const
+        {
+            return TileKey{
+                tx, ty, seed, sampler.scale(), sampler.period(), sampler.persistence(), sampler.octaves(),
+                sampler.type(), sampler.isWarped(), sampler.isWarped() ? sampler.warpStrength() : T(0)
+            };
+        }
+
+        std::size_t tileMemory() const
+        {
+            return sizeof(Entry) + sizeof(T) * static_cast<std::size_t>((m_tileSize + 1) * (m_tileSize + 1));
+        }
+
+        SizeType floorDiv(SizeType v) const
+        {
+            return (v >= 0 ? v : v - m_tileSize + 1) / m_tileSize;
+        }
+
+        // always keeps the most recently used tile
+        void evict()
+        {
+            while (m_memoryUsage > m_memoryBudget && m_tiles.size() > 1)
+            {
+                m_index.erase(m_tiles.back().key);
+                m_tiles.pop_back();
+                m_memoryUsage -= tileMemory();
+            }
+        }
+    };
+}
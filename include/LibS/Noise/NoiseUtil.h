@@ -3,9 +3,12 @@
 #include "LibS/Shapes/Fwd.h"
 
 #include <memory>
+#include <iterator>
+#include <cstdint>
 #include <algorithm>
 #include <numeric>
 #include <utility>
+#include <limits>
 
 namespace ls
 {
@@ -62,7 +65,80 @@ namespace ls
 
         IntT operator()(IntT x) const
         {
-            return m_perm[x % N];
+            return m_perm[x % SizeV];
+        }
+    };
+
+
+    // 256 entry byte table stored inline, 256 bytes instead of a heap allocated
+    // table of IntT, so it stays in L1 next to the gradients.
+    // Default constructed it holds the original Perlin permutation.
+    struct CompactPermTable
+    {
+    private:
+        std::uint8_t m_perm[256];
+
+    public:
+        CompactPermTable() noexcept
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                m_perm[i] = static_cast<std::uint8_t>(OriginalPerlinPermTable{}(i));
+            }
+        }
+
+        template <typename RngT>
+        static CompactPermTable shuffled(RngT&& rng)
+        {
+            CompactPermTable table;
+            std::iota(std::begin(table.m_perm), std::end(table.m_perm), 0);
+            std::shuffle(std::begin(table.m_perm), std::end(table.m_perm), rng);
+            return table;
+        }
+
+        std::uint32_t operator()(std::uint32_t x) const
+        {
+            return m_perm[x & 0xFF];
+        }
+    };
+
+    // Stateless integer hash (lowbias32 by Chris Wellons), no memory lookups.
+    // Unlike the tables it doesn't repeat every 256 lattice cells.
+    struct IntegerHash
+    {
+        IntegerHash() = default;
+
+        std::uint32_t operator()(std::uint32_t x) const
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+    };
+
+    // IntegerHash mixed with a seed, different seeds give unrelated noise.
+    struct SeededIntegerHash
+    {
+    private:
+        std::uint32_t m_seed;
+
+    public:
+        SeededIntegerHash() noexcept :
+            m_seed(0)
+        {
+        }
+
+        explicit SeededIntegerHash(std::uint32_t seed) noexcept :
+            m_seed(IntegerHash{}(seed))
+        {
+        }
+
+        std::uint32_t operator()(std::uint32_t x) const
+        {
+            return IntegerHash{}(x ^ m_seed);
         }
     };
 
@@ -175,5 +251,32 @@ namespace ls
         {
             return (t * t * t * (t * (t * T(6) - T(15)) + T(10)));
         }
+
+        // Doubles the period for the next octave, saturates instead of overflowing.
+        inline void doublePeriod(int& period)
+        {
+            if (period < std::numeric_limits<int>::max() / 2) period *= 2;
+        }
+        template <typename IntT>
+        inline void doublePeriod(Vec2<IntT>& period)
+        {
+            doublePeriod(period.x);
+            doublePeriod(period.y);
+        }
+        template <typename IntT>
+        inline void doublePeriod(Vec3<IntT>& period)
+        {
+            doublePeriod(period.x);
+            doublePeriod(period.y);
+            doublePeriod(period.z);
+        }
+        template <typename IntT>
+        inline void doublePeriod(Vec4<IntT>& period)
+        {
+            doublePeriod(period.x);
+            doublePeriod(period.y);
+            doublePeriod(period.z);
+            doublePeriod(period.w);
+        }
     }
 }
\ No newline at end of file
@@ -5,9 +5,12 @@
 #include "LibS/Shapes/Vec4.h"
 
 #include "LibS/Common.h"
+#include "LibS/Detail.h"
+#include "LibS/Simd.h"
 
 #include "Fwd.h"
 
+#include <algorithm>
 #include <utility>
 #include <cstdint>
 #include <type_traits>
@@ -24,6 +27,7 @@ namespace ls
     public:
         using ValueType = T;
         using HashType = HashT;
+        using SizeType = detail::SizeType;
 
     public:
         SimplexNoise() noexcept :
@@ -1308,6 +1312,62 @@ namespace ls
             return ValueDerivativePair<T, 4>(noise, Vec4<T>(dx, dy, dz, dw));
         }
 
+        // Evaluates raw for each of coords[0..count) and writes the results to out.
+        // For float the points are processed 4 (SSE2) or 8 (AVX2) at a time,
+        // the instruction set is chosen at runtime and can be limited with maxLevel.
+        // The kernels follow raw operation by operation, so the results are the same up to rounding.
+        // They are bitwise equal only when raw is compiled without floating point contraction
+        // (-ffp-contract=off), otherwise the compiler may fuse its multiplies and adds into fma.
+        void rawBatch(const Vec2<T>* coords, SizeType count, const Vec2<int>& period, T* out, SimdLevel maxLevel = SimdLevel::Avx2)
+        {
+            if constexpr (std::is_same<T, float>::value)
+            {
+#if defined(LS_SIMD_SSE2)
+                const SimdLevel level = std::min(simdLevel(), maxLevel);
+                if (level == SimdLevel::Avx2)
+                {
+                    rawBatchAvx2(coords, count, period, out);
+                    return;
+                }
+                else if (level == SimdLevel::Sse2)
+                {
+                    rawBatchSse2(coords, count, period, out);
+                    return;
+                }
+#endif
+            }
+
+            for (SizeType i = 0; i < count; ++i)
+            {
+                out[i] = raw(coords[i], period);
+            }
+        }
+
+        void rawBatch(const Vec3<T>* coords, SizeType count, const Vec3<int>& period, T* out, SimdLevel maxLevel = SimdLevel::Avx2)
+        {
+            if constexpr (std::is_same<T, float>::value)
+            {
+#if defined(LS_SIMD_SSE2)
+                const SimdLevel level = std::min(simdLevel(), maxLevel);
+                if (level == SimdLevel::Avx2)
+                {
+                    rawBatchAvx2(coords, count, period, out);
+                    return;
+                }
+                else if (level == SimdLevel::Sse2)
+                {
+                    rawBatchSse2(coords, count, period, out);
+                    return;
+                }
+#endif
+            }
+
+            for (SizeType i = 0; i < count; ++i)
+            {
+                out[i] = raw(coords[i], period);
+            }
+        }
+
     private:
         static T grad1(std::uint32_t hash, T x)
         {
@@ -1492,6 +1552,406 @@ namespace ls
             { 1.0, 1.0, 1.0, 0.0 },{ 1.0, 1.0, -1.0, 0.0 },{ 1.0, -1.0, 1.0, 0.0 },{ 1.0, -1.0, -1.0, 0.0 },
             { -1.0, 1.0, 1.0, 0.0 },{ -1.0, 1.0, -1.0, 0.0 },{ -1.0, -1.0, 1.0, 0.0 },{ -1.0, -1.0, -1.0, 0.0 }
         };
+
+        std::uint32_t hashCorner(int i, int j, int px, int py)
+        {
+            const std::uint32_t ip = periodicMod(i, px);
+            const std::uint32_t jp = periodicMod(j, py);
+            return HashType::operator()(ip + HashType::operator()(jp));
+        }
+        std::uint32_t hashCorner(int i, int j, int k, int px, int py, int pz)
+        {
+            const std::uint32_t ip = periodicMod(i, px);
+            const std::uint32_t jp = periodicMod(j, py);
+            const std::uint32_t kp = periodicMod(k, pz);
+            return HashType::operator()(ip + HashType::operator()(jp + HashType::operator()(kp)));
+        }
+
+#if defined(LS_SIMD_SSE2)
+
+        // The kernels mirror the scalar raw operation by operation, corner selection
+        // is done with masks instead of branches. Hashing stays scalar per lane
+        // so that any HashT can be used.
+
+        static __m128i floorToIntSse2(__m128 v)
+        {
+            // same as floorToInt, truncate and subtract one for negative values
+            const __m128i truncated = _mm_cvttps_epi32(v);
+            const __m128i negative = _mm_castps_si128(_mm_cmplt_ps(v, _mm_setzero_ps()));
+            return _mm_add_epi32(truncated, negative);
+        }
+        static __m128 flipSignSse2(__m128 v, __m128i signBit)
+        {
+            return _mm_xor_ps(v, _mm_castsi128_ps(signBit));
+        }
+        static __m128 selectSse2(__m128 mask, __m128 a, __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+        static __m128 grad2Sse2(__m128i hash, __m128 x, __m128 y)
+        {
+            const __m128 hLess4 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hash, _mm_set1_epi32(0b100)), _mm_setzero_si128()));
+            const __m128 u = selectSse2(hLess4, x, y);
+            const __m128 v = selectSse2(hLess4, y, x);
+            const __m128i signU = _mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(0b001)), 31);
+            const __m128i signV = _mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(0b010)), 30);
+            return _mm_add_ps(flipSignSse2(u, signU), flipSignSse2(_mm_add_ps(v, v), signV));
+        }
+        static __m128 grad3Sse2(__m128i hash, __m128 x, __m128 y, __m128 z)
+        {
+            const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(0b1111));
+            const __m128 hLess8 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(0b1000)), _mm_setzero_si128()));
+            const __m128 hLess4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+            const __m128 h12or14 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(0b1101)), _mm_set1_epi32(12)));
+            const __m128 u = selectSse2(hLess8, x, y);
+            const __m128 v = selectSse2(hLess4, y, selectSse2(h12or14, x, z));
+            const __m128i signU = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0b01)), 31);
+            const __m128i signV = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0b10)), 30);
+            return _mm_add_ps(flipSignSse2(u, signU), flipSignSse2(v, signV));
+        }
+        // t^4 * grad, or 0 when the corner is too far
+        static __m128 contributionSse2(__m128 t, __m128 grad)
+        {
+            const __m128 t2 = _mm_mul_ps(t, t);
+            const __m128 n = _mm_mul_ps(_mm_mul_ps(t2, t2), grad);
+            return _mm_andnot_ps(_mm_cmplt_ps(t, _mm_setzero_ps()), n);
+        }
+
+        void rawBatchSse2(const Vec2<T>* coords, SizeType count, const Vec2<int>& period, T* out)
+        {
+            const __m128 F2 = _mm_set1_ps(m_F2);
+            const __m128 G2 = _mm_set1_ps(m_G2);
+            const __m128 twoG2 = _mm_set1_ps(T(2) * m_G2);
+            const __m128 one = _mm_set1_ps(T(1));
+            const __m128 half = _mm_set1_ps(T(0.5));
+            const __m128i oneI = _mm_set1_epi32(1);
+
+            alignas(16) std::int32_t is[4], js[4], i1s[4];
+            alignas(16) std::uint32_t h0[4], h1[4], h2[4];
+
+            SizeType n = 0;
+            for (; n + 4 <= count; n += 4)
+            {
+                const __m128 x = _mm_setr_ps(coords[n].x, coords[n + 1].x, coords[n + 2].x, coords[n + 3].x);
+                const __m128 y = _mm_setr_ps(coords[n].y, coords[n + 1].y, coords[n + 2].y, coords[n + 3].y);
+
+                const __m128 s = _mm_mul_ps(_mm_add_ps(x, y), F2);
+                const __m128i i = floorToIntSse2(_mm_add_ps(x, s));
+                const __m128i j = floorToIntSse2(_mm_add_ps(y, s));
+
+                const __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), G2);
+                const __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+                const __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+                // lower triangle: (i1, j1) = (1, 0), upper triangle: (i1, j1) = (0, 1)
+                const __m128 lower = _mm_cmpgt_ps(x0, y0);
+                const __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(lower, one)), G2);
+                const __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_andnot_ps(lower, one)), G2);
+                const __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), twoG2);
+                const __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), twoG2);
+
+                _mm_store_si128(reinterpret_cast<__m128i*>(is), i);
+                _mm_store_si128(reinterpret_cast<__m128i*>(js), j);
+                _mm_store_si128(reinterpret_cast<__m128i*>(i1s), _mm_and_si128(_mm_castps_si128(lower), oneI));
+                for (int l = 0; l < 4; ++l)
+                {
+                    h0[l] = hashCorner(is[l], js[l], period.x, period.y);
+                    h1[l] = hashCorner(is[l] + i1s[l], js[l] + 1 - i1s[l], period.x, period.y);
+                    h2[l] = hashCorner(is[l] + 1, js[l] + 1, period.x, period.y);
+                }
+
+                const __m128 t0 = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0));
+                const __m128 t1 = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1));
+                const __m128 t2 = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2));
+                const __m128 n0 = contributionSse2(t0, grad2Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h0)), x0, y0));
+                const __m128 n1 = contributionSse2(t1, grad2Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h1)), x1, y1));
+                const __m128 n2 = contributionSse2(t2, grad2Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h2)), x2, y2));
+
+                _mm_storeu_ps(out + n, _mm_mul_ps(_mm_set1_ps(T(40)), _mm_add_ps(_mm_add_ps(n0, n1), n2)));
+            }
+
+            for (; n < count; ++n)
+            {
+                out[n] = raw(coords[n], period);
+            }
+        }
+
+        void rawBatchSse2(const Vec3<T>* coords, SizeType count, const Vec3<int>& period, T* out)
+        {
+            const __m128 F3 = _mm_set1_ps(m_F3);
+            const __m128 G3 = _mm_set1_ps(m_G3);
+            const __m128 twoG3 = _mm_set1_ps(T(2) * m_G3);
+            const __m128 threeG3 = _mm_set1_ps(T(3) * m_G3);
+            const __m128 one = _mm_set1_ps(T(1));
+            const __m128 limit = _mm_set1_ps(T(0.6));
+            const __m128 allOnes = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            const __m128i oneI = _mm_set1_epi32(1);
+
+            alignas(16) std::int32_t is[4], js[4], ks[4];
+            alignas(16) std::int32_t i1s[4], j1s[4], k1s[4], i2s[4], j2s[4], k2s[4];
+            alignas(16) std::uint32_t h0[4], h1[4], h2[4], h3[4];
+
+            SizeType n = 0;
+            for (; n + 4 <= count; n += 4)
+            {
+                const __m128 x = _mm_setr_ps(coords[n].x, coords[n + 1].x, coords[n + 2].x, coords[n + 3].x);
+                const __m128 y = _mm_setr_ps(coords[n].y, coords[n + 1].y, coords[n + 2].y, coords[n + 3].y);
+                const __m128 z = _mm_setr_ps(coords[n].z, coords[n + 1].z, coords[n + 2].z, coords[n + 3].z);
+
+                const __m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(x, y), z), F3);
+                const __m128i i = floorToIntSse2(_mm_add_ps(x, s));
+                const __m128i j = floorToIntSse2(_mm_add_ps(y, s));
+                const __m128i k = floorToIntSse2(_mm_add_ps(z, s));
+
+                const __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(i, j), k)), G3);
+                const __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+                const __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+                const __m128 z0 = _mm_sub_ps(z, _mm_sub_ps(_mm_cvtepi32_ps(k), t));
+
+                // branchless form of the corner ordering in raw
+                const __m128 xy = _mm_cmpge_ps(x0, y0);
+                const __m128 yz = _mm_cmpge_ps(y0, z0);
+                const __m128 xz = _mm_cmpge_ps(x0, z0);
+                const __m128 i1 = _mm_and_ps(xy, _mm_or_ps(yz, xz));
+                const __m128 j1 = _mm_andnot_ps(xy, yz);
+                const __m128 k1 = _mm_andnot_ps(_mm_or_ps(yz, _mm_and_ps(xy, xz)), allOnes);
+                const __m128 i2 = _mm_or_ps(xy, _mm_and_ps(yz, xz));
+                const __m128 j2 = _mm_or_ps(_mm_andnot_ps(xy, allOnes), yz);
+                const __m128 k2 = _mm_andnot_ps(_mm_and_ps(yz, _mm_or_ps(xy, xz)), allOnes);
+
+                const __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(i1, one)), G3);
+                const __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(j1, one)), G3);
+                const __m128 z1 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(k1, one)), G3);
+                const __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(i2, one)), twoG3);
+                const __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(j2, one)), twoG3);
+                const __m128 z2 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(k2, one)), twoG3);
+                const __m128 x3 = _mm_add_ps(_mm_sub_ps(x0, one), threeG3);
+                const __m128 y3 = _mm_add_ps(_mm_sub_ps(y0, one), threeG3);
+                const __m128 z3 = _mm_add_ps(_mm_sub_ps(z0, one), threeG3);
+
+                _mm_store_si128(reinterpret_cast<__m128i*>(is), i);
+                _mm_store_si128(reinterpret_cast<__m128i*>(js), j);
+                _mm_store_si128(reinterpret_cast<__m128i*>(ks), k);
+                _mm_store_si128(reinterpret_cast<__m128i*>(i1s), _mm_and_si128(_mm_castps_si128(i1), oneI));
+                _mm_store_si128(reinterpret_cast<__m128i*>(j1s), _mm_and_si128(_mm_castps_si128(j1), oneI));
+                _mm_store_si128(reinterpret_cast<__m128i*>(k1s), _mm_and_si128(_mm_castps_si128(k1), oneI));
+                _mm_store_si128(reinterpret_cast<__m128i*>(i2s), _mm_and_si128(_mm_castps_si128(i2), oneI));
+                _mm_store_si128(reinterpret_cast<__m128i*>(j2s), _mm_and_si128(_mm_castps_si128(j2), oneI));
+                _mm_store_si128(reinterpret_cast<__m128i*>(k2s), _mm_and_si128(_mm_castps_si128(k2), oneI));
+                for (int l = 0; l < 4; ++l)
+                {
+                    h0[l] = hashCorner(is[l], js[l], ks[l], period.x, period.y, period.z);
+                    h1[l] = hashCorner(is[l] + i1s[l], js[l] + j1s[l], ks[l] + k1s[l], period.x, period.y, period.z);
+                    h2[l] = hashCorner(is[l] + i2s[l], js[l] + j2s[l], ks[l] + k2s[l], period.x, period.y, period.z);
+                    h3[l] = hashCorner(is[l] + 1, js[l] + 1, ks[l] + 1, period.x, period.y, period.z);
+                }
+
+                const __m128 t0 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(limit, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0)), _mm_mul_ps(z0, z0));
+                const __m128 t1 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(limit, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1)), _mm_mul_ps(z1, z1));
+                const __m128 t2 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(limit, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2)), _mm_mul_ps(z2, z2));
+                const __m128 t3 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(limit, _mm_mul_ps(x3, x3)), _mm_mul_ps(y3, y3)), _mm_mul_ps(z3, z3));
+                const __m128 n0 = contributionSse2(t0, grad3Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h0)), x0, y0, z0));
+                const __m128 n1 = contributionSse2(t1, grad3Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h1)), x1, y1, z1));
+                const __m128 n2 = contributionSse2(t2, grad3Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h2)), x2, y2, z2));
+                const __m128 n3 = contributionSse2(t3, grad3Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(h3)), x3, y3, z3));
+
+                _mm_storeu_ps(out + n, _mm_mul_ps(_mm_set1_ps(T(32)), _mm_add_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), n3)));
+            }
+
+            for (; n < count; ++n)
+            {
+                out[n] = raw(coords[n], period);
+            }
+        }
+
+        LS_TARGET_AVX2 static __m256i floorToIntAvx2(__m256 v)
+        {
+            const __m256i truncated = _mm256_cvttps_epi32(v);
+            const __m256i negative = _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_LT_OQ));
+            return _mm256_add_epi32(truncated, negative);
+        }
+        LS_TARGET_AVX2 static __m256 flipSignAvx2(__m256 v, __m256i signBit)
+        {
+            return _mm256_xor_ps(v, _mm256_castsi256_ps(signBit));
+        }
+        LS_TARGET_AVX2 static __m256 grad2Avx2(__m256i hash, __m256 x, __m256 y)
+        {
+            const __m256 hLess4 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(hash, _mm256_set1_epi32(0b100)), _mm256_setzero_si256()));
+            const __m256 u = _mm256_blendv_ps(y, x, hLess4);
+            const __m256 v = _mm256_blendv_ps(x, y, hLess4);
+            const __m256i signU = _mm256_slli_epi32(_mm256_and_si256(hash, _mm256_set1_epi32(0b001)), 31);
+            const __m256i signV = _mm256_slli_epi32(_mm256_and_si256(hash, _mm256_set1_epi32(0b010)), 30);
+            return _mm256_add_ps(flipSignAvx2(u, signU), flipSignAvx2(_mm256_add_ps(v, v), signV));
+        }
+        LS_TARGET_AVX2 static __m256 grad3Avx2(__m256i hash, __m256 x, __m256 y, __m256 z)
+        {
+            const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(0b1111));
+            const __m256 hLess8 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0b1000)), _mm256_setzero_si256()));
+            const __m256 hLess4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+            const __m256 h12or14 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0b1101)), _mm256_set1_epi32(12)));
+            const __m256 u = _mm256_blendv_ps(y, x, hLess8);
+            const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, h12or14), y, hLess4);
+            const __m256i signU = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0b01)), 31);
+            const __m256i signV = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0b10)), 30);
+            return _mm256_add_ps(flipSignAvx2(u, signU), flipSignAvx2(v, signV));
+        }
+        LS_TARGET_AVX2 static __m256 contributionAvx2(__m256 t, __m256 grad)
+        {
+            const __m256 t2 = _mm256_mul_ps(t, t);
+            const __m256 n = _mm256_mul_ps(_mm256_mul_ps(t2, t2), grad);
+            return _mm256_andnot_ps(_mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ), n);
+        }
+        LS_TARGET_AVX2 static __m256 lanesAvx2(const T* v, SizeType stride)
+        {
+            return _mm256_setr_ps(v[0], v[stride], v[2 * stride], v[3 * stride], v[4 * stride], v[5 * stride], v[6 * stride], v[7 * stride]);
+        }
+
+        LS_TARGET_AVX2 void rawBatchAvx2(const Vec2<T>* coords, SizeType count, const Vec2<int>& period, T* out)
+        {
+            const __m256 F2 = _mm256_set1_ps(m_F2);
+            const __m256 G2 = _mm256_set1_ps(m_G2);
+            const __m256 twoG2 = _mm256_set1_ps(T(2) * m_G2);
+            const __m256 one = _mm256_set1_ps(T(1));
+            const __m256 half = _mm256_set1_ps(T(0.5));
+            const __m256i oneI = _mm256_set1_epi32(1);
+
+            alignas(32) std::int32_t is[8], js[8], i1s[8];
+            alignas(32) std::uint32_t h0[8], h1[8], h2[8];
+
+            SizeType n = 0;
+            for (; n + 8 <= count; n += 8)
+            {
+                const __m256 x = lanesAvx2(&coords[n].x, 2);
+                const __m256 y = lanesAvx2(&coords[n].y, 2);
+
+                const __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), F2);
+                const __m256i i = floorToIntAvx2(_mm256_add_ps(x, s));
+                const __m256i j = floorToIntAvx2(_mm256_add_ps(y, s));
+
+                const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(i, j)), G2);
+                const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+                const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+
+                const __m256 lower = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+                const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(lower, one)), G2);
+                const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_andnot_ps(lower, one)), G2);
+                const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, one), twoG2);
+                const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, one), twoG2);
+
+                _mm256_store_si256(reinterpret_cast<__m256i*>(is), i);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(js), j);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(i1s), _mm256_and_si256(_mm256_castps_si256(lower), oneI));
+                for (int l = 0; l < 8; ++l)
+                {
+                    h0[l] = hashCorner(is[l], js[l], period.x, period.y);
+                    h1[l] = hashCorner(is[l] + i1s[l], js[l] + 1 - i1s[l], period.x, period.y);
+                    h2[l] = hashCorner(is[l] + 1, js[l] + 1, period.x, period.y);
+                }
+
+                const __m256 t0 = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x0, x0)), _mm256_mul_ps(y0, y0));
+                const __m256 t1 = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x1, x1)), _mm256_mul_ps(y1, y1));
+                const __m256 t2 = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x2, x2)), _mm256_mul_ps(y2, y2));
+                const __m256 n0 = contributionAvx2(t0, grad2Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h0)), x0, y0));
+                const __m256 n1 = contributionAvx2(t1, grad2Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h1)), x1, y1));
+                const __m256 n2 = contributionAvx2(t2, grad2Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h2)), x2, y2));
+
+                _mm256_storeu_ps(out + n, _mm256_mul_ps(_mm256_set1_ps(T(40)), _mm256_add_ps(_mm256_add_ps(n0, n1), n2)));
+            }
+
+            for (; n < count; ++n)
+            {
+                out[n] = raw(coords[n], period);
+            }
+        }
+
+        LS_TARGET_AVX2 void rawBatchAvx2(const Vec3<T>* coords, SizeType count, const Vec3<int>& period, T* out)
+        {
+            const __m256 F3 = _mm256_set1_ps(m_F3);
+            const __m256 G3 = _mm256_set1_ps(m_G3);
+            const __m256 twoG3 = _mm256_set1_ps(T(2) * m_G3);
+            const __m256 threeG3 = _mm256_set1_ps(T(3) * m_G3);
+            const __m256 one = _mm256_set1_ps(T(1));
+            const __m256 limit = _mm256_set1_ps(T(0.6));
+            const __m256 allOnes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            const __m256i oneI = _mm256_set1_epi32(1);
+
+            alignas(32) std::int32_t is[8], js[8], ks[8];
+            alignas(32) std::int32_t i1s[8], j1s[8], k1s[8], i2s[8], j2s[8], k2s[8];
+            alignas(32) std::uint32_t h0[8], h1[8], h2[8], h3[8];
+
+            SizeType n = 0;
+            for (; n + 8 <= count; n += 8)
+            {
+                const __m256 x = lanesAvx2(&coords[n].x, 3);
+                const __m256 y = lanesAvx2(&coords[n].y, 3);
+                const __m256 z = lanesAvx2(&coords[n].z, 3);
+
+                const __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), F3);
+                const __m256i i = floorToIntAvx2(_mm256_add_ps(x, s));
+                const __m256i j = floorToIntAvx2(_mm256_add_ps(y, s));
+                const __m256i k = floorToIntAvx2(_mm256_add_ps(z, s));
+
+                const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(i, j), k)), G3);
+                const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+                const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+                const __m256 z0 = _mm256_sub_ps(z, _mm256_sub_ps(_mm256_cvtepi32_ps(k), t));
+
+                const __m256 xy = _mm256_cmp_ps(x0, y0, _CMP_GE_OQ);
+                const __m256 yz = _mm256_cmp_ps(y0, z0, _CMP_GE_OQ);
+                const __m256 xz = _mm256_cmp_ps(x0, z0, _CMP_GE_OQ);
+                const __m256 i1 = _mm256_and_ps(xy, _mm256_or_ps(yz, xz));
+                const __m256 j1 = _mm256_andnot_ps(xy, yz);
+                const __m256 k1 = _mm256_andnot_ps(_mm256_or_ps(yz, _mm256_and_ps(xy, xz)), allOnes);
+                const __m256 i2 = _mm256_or_ps(xy, _mm256_and_ps(yz, xz));
+                const __m256 j2 = _mm256_or_ps(_mm256_andnot_ps(xy, allOnes), yz);
+                const __m256 k2 = _mm256_andnot_ps(_mm256_and_ps(yz, _mm256_or_ps(xy, xz)), allOnes);
+
+                const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(i1, one)), G3);
+                const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(j1, one)), G3);
+                const __m256 z1 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_and_ps(k1, one)), G3);
+                const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(i2, one)), twoG3);
+                const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(j2, one)), twoG3);
+                const __m256 z2 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_and_ps(k2, one)), twoG3);
+                const __m256 x3 = _mm256_add_ps(_mm256_sub_ps(x0, one), threeG3);
+                const __m256 y3 = _mm256_add_ps(_mm256_sub_ps(y0, one), threeG3);
+                const __m256 z3 = _mm256_add_ps(_mm256_sub_ps(z0, one), threeG3);
+
+                _mm256_store_si256(reinterpret_cast<__m256i*>(is), i);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(js), j);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(ks), k);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(i1s), _mm256_and_si256(_mm256_castps_si256(i1), oneI));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(j1s), _mm256_and_si256(_mm256_castps_si256(j1), oneI));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(k1s), _mm256_and_si256(_mm256_castps_si256(k1), oneI));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(i2s), _mm256_and_si256(_mm256_castps_si256(i2), oneI));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(j2s), _mm256_and_si256(_mm256_castps_si256(j2), oneI));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(k2s), _mm256_and_si256(_mm256_castps_si256(k2), oneI));
+                for (int l = 0; l < 8; ++l)
+                {
+                    h0[l] = hashCorner(is[l], js[l], ks[l], period.x, period.y, period.z);
+                    h1[l] = hashCorner(is[l] + i1s[l], js[l] + j1s[l], ks[l] + k1s[l], period.x, period.y, period.z);
+                    h2[l] = hashCorner(is[l] + i2s[l], js[l] + j2s[l], ks[l] + k2s[l], period.x, period.y, period.z);
+                    h3[l] = hashCorner(is[l] + 1, js[l] + 1, ks[l] + 1, period.x, period.y, period.z);
+                }
+
+                const __m256 t0 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(limit, _mm256_mul_ps(x0, x0)), _mm256_mul_ps(y0, y0)), _mm256_mul_ps(z0, z0));
+                const __m256 t1 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(limit, _mm256_mul_ps(x1, x1)), _mm256_mul_ps(y1, y1)), _mm256_mul_ps(z1, z1));
+                const __m256 t2 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(limit, _mm256_mul_ps(x2, x2)), _mm256_mul_ps(y2, y2)), _mm256_mul_ps(z2, z2));
+                const __m256 t3 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(limit, _mm256_mul_ps(x3, x3)), _mm256_mul_ps(y3, y3)), _mm256_mul_ps(z3, z3));
+                const __m256 n0 = contributionAvx2(t0, grad3Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h0)), x0, y0, z0));
+                const __m256 n1 = contributionAvx2(t1, grad3Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h1)), x1, y1, z1));
+                const __m256 n2 = contributionAvx2(t2, grad3Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h2)), x2, y2, z2));
+                const __m256 n3 = contributionAvx2(t3, grad3Avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(h3)), x3, y3, z3));
+
+                _mm256_storeu_ps(out + n, _mm256_mul_ps(_mm256_set1_ps(T(32)), _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(n0, n1), n2), n3)));
+            }
+
+            for (; n < count; ++n)
+            {
+                out[n] = raw(coords[n], period);
+            }
+        }
+
+#endif
     };
 
     using SimplexNoiseD = SimplexNoise<double>;
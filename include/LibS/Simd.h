@@ -0,0 +1,84 @@
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#define LS_SIMD_SSE2
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+
+#endif
+
+#endif
+
+
+#if defined(LS_SIMD_SSE2) && (defined(__clang__) || defined(__GNUC__) || defined(__GNUG__))
+
+// allows AVX2 kernels to be compiled without -mavx2, they are only called after a runtime check
+#define LS_TARGET_AVX2 __attribute__((target("avx2")))
+
+#else
+
+#define LS_TARGET_AVX2
+
+#endif
+
+namespace ls
+{
+    enum struct SimdLevel
+    {
+        None,
+        Sse2,
+        Avx2
+    };
+
+    namespace detail
+    {
+        inline SimdLevel detectSimdLevel()
+        {
+#if defined(LS_SIMD_SSE2)
+
+#if defined(__clang__) || defined(__GNUC__) || defined(__GNUG__)
+
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+
+#elif defined(_MSC_VER)
+
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] >= 7)
+            {
+                __cpuid(info, 1);
+                const bool osxsave = (info[2] & (1 << 27)) != 0;
+                const bool avx = (info[2] & (1 << 28)) != 0;
+                // the OS has to save ymm registers on context switch
+                if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+                {
+                    __cpuidex(info, 7, 0);
+                    if (info[1] & (1 << 5)) return SimdLevel::Avx2;
+                }
+            }
+
+#endif
+
+            return SimdLevel::Sse2;
+
+#else
+
+            return SimdLevel::None;
+
+#endif
+        }
+    }
+
+    // the best instruction set available on the machine, detected once
+    inline SimdLevel simdLevel()
+    {
+        static const SimdLevel level = detail::detectSimdLevel();
+        return level;
+    }
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "LibS/Detail.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <type_traits>
+#include <cstdint>
+
+namespace ls
+{
+    // Fixed set of worker threads for data parallel loops.
+    // The calling thread takes part in the work, so a pool of N threads spawns N - 1 workers.
+    struct ThreadPool
+    {
+    public:
+        using SizeType = detail::SizeType;
+
+        explicit ThreadPool(int numThreads = defaultNumThreads()) :
+            m_job(nullptr),
+            m_generation(0),
+            m_stop(false)
+        {
+            const int numWorkers = numThreads > 1 ? numThreads - 1 : 0;
+            m_workers.reserve(numWorkers);
+            for (int i = 0; i < numWorkers; ++i)
+            {
+                m_workers.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_workAvailable.notify_all();
+
+            for (std::thread& worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        static int defaultNumThreads()
+        {
+            const unsigned n = std::thread::hardware_concurrency();
+            return n > 0 ? static_cast<int>(n) : 1;
+        }
+
+        int numThreads() const
+        {
+            return static_cast<int>(m_workers.size()) + 1;
+        }
+
+        // Calls func(i) for each i in [begin, end) and blocks until all calls finish.
+        // Indices are handed out dynamically, so the order of calls is unspecified.
+        // The first exception thrown by func stops handing out indices and is rethrown here.
+        // Must not be called from inside func.
+        template <typename FuncT>
+        void parallelFor(SizeType begin, SizeType end, FuncT&& func)
+        {
+            if (begin >= end) return;
+
+            if (m_workers.empty() || end - begin == 1)
+            {
+                for (SizeType i = begin; i < end; ++i)
+                {
+                    func(i);
+                }
+                return;
+            }
+
+            std::lock_guard<std::mutex> submitLock(m_submitMutex);
+
+            Job job;
+            job.next = begin;
+            job.end = end;
+            job.func = const_cast<void*>(static_cast<const void*>(&func));
+            job.invoke = [](void* f, SizeType i) { (*static_cast<std::remove_reference_t<FuncT>*>(f))(i); };
+            job.pendingWorkers = static_cast<int>(m_workers.size());
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_job = &job;
+                ++m_generation;
+            }
+            m_workAvailable.notify_all();
+
+            runJob(job);
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobDone.wait(lock, [&job]() { return job.pendingWorkers == 0; });
+                m_job = nullptr;
+            }
+
+            if (job.error)
+            {
+                std::rethrow_exception(job.error);
+            }
+        }
+
+    private:
+        struct Job
+        {
+            std::atomic<SizeType> next;
+            SizeType end;
+            void* func;
+            void(*invoke)(void*, SizeType);
+            int pendingWorkers; // guarded by m_mutex
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_submitMutex;
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_jobDone;
+        Job* m_job;
+        std::uint64_t m_generation;
+        bool m_stop;
+
+        void workerLoop()
+        {
+            std::uint64_t lastGeneration = 0;
+            for (;;)
+            {
+                Job* job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_workAvailable.wait(lock, [&]() { return m_stop || m_generation != lastGeneration; });
+                    if (m_stop) return;
+
+                    lastGeneration = m_generation;
+                    job = m_job;
+                }
+
+                runJob(*job);
+
+                bool isLast;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    isLast = --job->pendingWorkers == 0;
+                }
+                if (isLast)
+                {
+                    m_jobDone.notify_all();
+                }
+            }
+        }
+
+        static void runJob(Job& job)
+        {
+            for (;;)
+            {
+                const SizeType i = job.next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= job.end) return;
+
+                try
+                {
+                    job.invoke(job.func, i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(job.errorMutex);
+                    if (!job.error) job.error = std::current_exception();
+                    job.next.store(job.end, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+}
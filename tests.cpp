@@ -0,0 +1,737 @@
+#include "LibS.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    void check(bool condition, const std::string& what)
+    {
+        if (!condition)
+        {
+            throw std::runtime_error("Check failed: " + what);
+        }
+    }
+
+    // The batch functions of FractalNoiseSampler, and everything built on them,
+    // have to give exactly the values of per point sampling.
+    template <typename LayoutT>
+    void testFractalNoiseBatchMatchesSample(const ls::FractalNoiseSampler2F& sampler, const std::string& name)
+    {
+        using ArrayType = ls::Array2<float, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Dynamic, LayoutT>;
+
+        ls::SimplexNoiseF noise;
+        const ls::Vec2F origin(124.0f, 321.0f);
+        const ls::Vec2F step(0.75f, 0.5f);
+        const ls::Vec2F stepX(step.x, 0.0f);
+        const ls::Vec2F stepY(0.0f, step.y);
+
+        const auto expected = [&](const ls::Vec2F& pos) {
+            return sampler.isWarped() ? sampler.sampleWarped(pos, noise) : sampler.sample(pos, noise);
+        };
+
+        std::vector<float> span(37);
+        sampler.sampleSpan(origin, step, static_cast<int>(span.size()), span.data(), noise);
+        for (int i = 0; i < static_cast<int>(span.size()); ++i)
+        {
+            check(span[i] == expected(origin + step * static_cast<float>(i)), name + " sampleSpan");
+        }
+
+        ArrayType grid(8, 8);
+        sampler.sampleGrid(grid, origin, step, noise);
+
+        ls::ThreadPool pool(2);
+        ls::NoiseFieldGenerator generator(pool, 3);
+        ArrayType generated(8, 8);
+        generator.generate(generated, sampler, origin, step, noise);
+
+        for (int x = 0; x < grid.width(); ++x)
+        {
+            for (int y = 0; y < grid.height(); ++y)
+            {
+                const float value = expected(origin + stepX * static_cast<float>(x) + stepY * static_cast<float>(y));
+                check(grid(x, y) == value, name + " sampleGrid");
+                check(generated(x, y) == value, name + " NoiseFieldGenerator::generate");
+            }
+        }
+    }
+
+    void testFractalNoise()
+    {
+        for (ls::FractalNoiseType type : { ls::FractalNoiseType::Fbm, ls::FractalNoiseType::Ridged, ls::FractalNoiseType::Billow })
+        {
+            for (bool isWarped : { false, true })
+            {
+                ls::FractalNoiseSampler2F sampler;
+                sampler.setOctaves(5);
+                sampler.setPersistence(0.5f);
+                sampler.setScale(ls::Vec2F(0.05f, 0.07f));
+                sampler.setType(type);
+                sampler.setWarpStrength(4.0f);
+                sampler.setWarped(isWarped);
+
+                const std::string name = "fractal noise type " + std::to_string(static_cast<int>(type)) + (isWarped ? " warped" : "");
+                testFractalNoiseBatchMatchesSample<ls::ColumnMajorLayout>(sampler, name);
+                testFractalNoiseBatchMatchesSample<ls::RowMajorLayout>(sampler, name + " row major");
+            }
+        }
+    }
+
+    // Cell positions are computed by the same expression in every loop order, but when the compiler contracts
+    // multiplies and adds into fma, which of them are fused depends on what is hoisted out of the inner loop,
+    // and the inlined noise is contracted differently in each loop too. Exact equality only holds
+    // with -ffp-contract=off, otherwise the values match up to rounding amplified by the noise gradients.
+    bool isNoiseValueClose(float lhs, float rhs)
+    {
+        return std::abs(lhs - rhs) <= 1e-3f;
+    }
+
+    // Grids are filled in storage order, which must not change the values.
+    template <typename LayoutT>
+    void testNoiseGridLayout(const std::string& name)
+    {
+        using Array2Type = ls::Array2<float, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Dynamic, LayoutT>;
+        using Array3Type = ls::Array3<float, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::detail::dynamicExtent, ls::ArrayStorageType::Dynamic, LayoutT>;
+
+        ls::SimplexNoiseF noise;
+
+        ls::NoiseSampler2F sampler2;
+        sampler2.setOctaves(3);
+        ls::Array2<float> expected2(13, 7);
+        Array2Type grid2(13, 7);
+        sampler2.sampleGrid(expected2, ls::Vec2F(1.5f, -2.0f), ls::Vec2F(0.3f, 0.7f), noise);
+        sampler2.sampleGrid(grid2, ls::Vec2F(1.5f, -2.0f), ls::Vec2F(0.3f, 0.7f), noise);
+        for (int x = 0; x < 13; ++x)
+        {
+            for (int y = 0; y < 7; ++y)
+            {
+                check(isNoiseValueClose(grid2(x, y), expected2(x, y)), name + " 2D sampleGrid");
+            }
+        }
+
+        ls::NoiseSampler3F sampler3;
+        sampler3.setOctaves(3);
+        ls::Array3<float> expected3(5, 6, 7);
+        Array3Type grid3(5, 6, 7);
+        sampler3.sampleGrid(expected3, ls::Vec3F(1.5f, -2.0f, 0.25f), ls::Vec3F(0.3f, 0.7f, 0.4f), noise);
+        sampler3.sampleGrid(grid3, ls::Vec3F(1.5f, -2.0f, 0.25f), ls::Vec3F(0.3f, 0.7f, 0.4f), noise);
+        for (int x = 0; x < 5; ++x)
+        {
+            for (int y = 0; y < 6; ++y)
+            {
+                for (int z = 0; z < 7; ++z)
+                {
+                    check(isNoiseValueClose(grid3(x, y, z), expected3(x, y, z)), name + " 3D sampleGrid");
+                }
+            }
+        }
+    }
+
+    void testNoiseGridLayouts()
+    {
+        testNoiseGridLayout<ls::RowMajorLayout>("row major");
+        testNoiseGridLayout<ls::PaddedRowMajorLayout<16>>("padded row major");
+        testNoiseGridLayout<ls::PaddedColumnMajorLayout<16>>("padded column major");
+        testNoiseGridLayout<ls::MortonTiledLayout<4>>("morton tiled");
+    }
+
+    // Differently shaped samplers with the same base parameters must not share tiles.
+    void testNoiseTileCache()
+    {
+        ls::SimplexNoiseF noise;
+        ls::NoiseTileCache<float> cache(16, 0.5f, 16 * 1024 * 1024);
+
+        ls::FractalNoiseSampler2F sampler;
+        sampler.setOctaves(4);
+        sampler.setPersistence(0.5f);
+        sampler.setWarpStrength(2.0f);
+
+        int numTiles = 0;
+        for (ls::FractalNoiseType type : { ls::FractalNoiseType::Fbm, ls::FractalNoiseType::Ridged, ls::FractalNoiseType::Billow })
+        {
+            for (bool isWarped : { false, true })
+            {
+                sampler.setType(type);
+                sampler.setWarped(isWarped);
+
+                for (int x = -3; x < 20; x += 7)
+                {
+                    for (int y = -5; y < 20; y += 6)
+                    {
+                        const ls::Vec2F pos(static_cast<float>(x) * cache.spacing(), static_cast<float>(y) * cache.spacing());
+                        const float expected = isWarped ? sampler.sampleWarped(pos, noise) : sampler.sample(pos, noise);
+                        check(cache.at(sampler, noise, 1234, x, y) == expected, "NoiseTileCache::at with fractal noise");
+                    }
+                }
+
+                numTiles += 9;
+                check(static_cast<int>(cache.numTiles()) == numTiles, "NoiseTileCache keys fractal noise parameters");
+            }
+        }
+    }
+
+    // The bit packed backend has to produce the generations of CellularAutomaton2 with the same rule,
+    // including the cells next to the edges and across the word boundaries of a column.
+    template <typename RuleT, ls::CellularAutomatonTopology TopologyV>
+    void testBitPackedCellularAutomaton(const RuleT& rule, const std::string& name)
+    {
+        using StateType = typename RuleT::StateType;
+
+        const int width = 37;
+        const int height = 131;
+        ls::CellularAutomaton2<RuleT, TopologyV> reference(width, height, rule);
+        ls::BitPackedCellularAutomaton2<RuleT, TopologyV> packed(width, height, rule);
+
+        std::mt19937 rng(1234);
+        reference.fill([&rng](int, int) { return rng() % 3 == 0 ? StateType::Live : StateType::Dead; });
+        packed.fill([&reference](int x, int y) { return reference(x, y); });
+
+        for (int generation = 1; generation <= 20; ++generation)
+        {
+            reference.iterate();
+            packed.iterate();
+
+            for (int x = 0; x < width; ++x)
+            {
+                for (int y = 0; y < height; ++y)
+                {
+                    check(packed(x, y) == reference(x, y), name + " generation " + std::to_string(generation));
+                }
+            }
+        }
+    }
+
+    void testBitPackedCellularAutomata()
+    {
+        //B36/S23
+        const ls::LifeLikeRule highLife(0b1001000, 0b1100);
+
+        testBitPackedCellularAutomaton<ls::ConwaysGameOfLifeRule, ls::CellularAutomatonTopology::Finite>(ls::ConwaysGameOfLifeRule{}, "bit packed conway finite");
+        testBitPackedCellularAutomaton<ls::ConwaysGameOfLifeRule, ls::CellularAutomatonTopology::Toroidal>(ls::ConwaysGameOfLifeRule{}, "bit packed conway toroidal");
+        testBitPackedCellularAutomaton<ls::LifeLikeRule, ls::CellularAutomatonTopology::Finite>(highLife, "bit packed highlife finite");
+        testBitPackedCellularAutomaton<ls::LifeLikeRule, ls::CellularAutomatonTopology::Toroidal>(highLife, "bit packed highlife toroidal");
+    }
+
+    // HashLife has to match a finite automaton as long as the pattern can't reach its edges,
+    // which takes at least (size - seedSize) / 2 generations. A low garbage collection threshold
+    // makes advance collect before almost every step, so the remapping of nodes is exercised too.
+    void testHashLife()
+    {
+        using Rule = ls::ConwaysGameOfLifeRule;
+        using StateType = Rule::StateType;
+
+        const int size = 240;
+        const int seedSize = 24;
+        const int seedX = size / 2 - seedSize / 2;
+        const int seedY = size / 2 - seedSize / 2;
+
+        std::mt19937 rng(4321);
+        ls::Array2<StateType> seed(seedSize, seedSize);
+        for (auto& cell : seed) cell = rng() % 3 == 0 ? StateType::Live : StateType::Dead;
+
+        ls::FiniteCellularAutomaton2<Rule> reference(size, size);
+        reference.fill(StateType::Dead);
+        for (int x = 0; x < seedSize; ++x)
+        {
+            for (int y = 0; y < seedSize; ++y)
+            {
+                reference(seedX + x, seedY + y) = seed(x, y);
+            }
+        }
+
+        //placed away from the origin so that the root is not centered on the pattern
+        ls::HashLife<Rule> hashLife;
+        hashLife.setGarbageCollectionThreshold(64);
+        hashLife.insert(seed, seedX - 1000, seedY + 333);
+
+        std::uint64_t generation = 0;
+        for (int generations : { 1, 5, 16, 37 })
+        {
+            hashLife.advance(generations);
+            reference.iterate(generations);
+            generation += generations;
+            check(hashLife.generation() == generation, "HashLife generation");
+
+            const ls::Array2<StateType> cells = hashLife.extract(-1000, 333, size, size);
+            for (int x = 0; x < size; ++x)
+            {
+                for (int y = 0; y < size; ++y)
+                {
+                    check(cells(x, y) == reference(x, y), "HashLife after " + std::to_string(generation) + " generations");
+                }
+            }
+        }
+    }
+
+    // Reference for the flood fill and the labeling, a breadth first search over face neighbours.
+    // Visits the cells connected to the start that are equal to it and calls visit(x, y, z) for each of them.
+    template <typename CellFuncT, typename VisitFuncT>
+    void referenceFloodFill(int width, int height, int depth, int x, int y, int z, std::vector<unsigned char>& isVisited, CellFuncT&& cellAt, VisitFuncT&& visit)
+    {
+        const auto index = [&](int cx, int cy, int cz) { return (cx * height + cy) * depth + cz; };
+        const int offsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+        const auto initialCell = cellAt(x, y, z);
+
+        std::vector<std::array<int, 3>> queue{ { x, y, z } };
+        isVisited[index(x, y, z)] = 1;
+        for (std::size_t i = 0; i < queue.size(); ++i)
+        {
+            const auto [cx, cy, cz] = queue[i];
+            visit(cx, cy, cz);
+
+            for (const auto& offset : offsets)
+            {
+                const int nx = cx + offset[0];
+                const int ny = cy + offset[1];
+                const int nz = cz + offset[2];
+                if (nx < 0 || ny < 0 || nz < 0 || nx >= width || ny >= height || nz >= depth) continue;
+                if (isVisited[index(nx, ny, nz)] || !(cellAt(nx, ny, nz) == initialCell)) continue;
+
+                isVisited[index(nx, ny, nz)] = 1;
+                queue.push_back({ nx, ny, nz });
+            }
+        }
+    }
+
+    // Number of components found by repeated reference fills.
+    template <typename CellFuncT>
+    int referenceComponentCount(int width, int height, int depth, CellFuncT&& cellAt)
+    {
+        std::vector<unsigned char> isVisited(static_cast<std::size_t>(width * height * depth), 0);
+        int numComponents = 0;
+        for (int x = 0; x < width; ++x)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                for (int z = 0; z < depth; ++z)
+                {
+                    if (isVisited[(x * height + y) * depth + z]) continue;
+
+                    referenceFloodFill(width, height, depth, x, y, z, isVisited, cellAt, [](int, int, int) {});
+                    ++numComponents;
+                }
+            }
+        }
+        return numComponents;
+    }
+
+    // Labels have to be equal exactly for neighbours that are equal, there have to be as many as reference components,
+    // and ids have to appear consecutively when going through the cells in column major order.
+    template <typename CellFuncT, typename LabelFuncT>
+    void checkComponentLabels(int width, int height, int depth, int numComponents, CellFuncT&& cellAt, LabelFuncT&& labelAt, const std::string& name)
+    {
+        check(numComponents == referenceComponentCount(width, height, depth, cellAt), name + " component count");
+
+        int nextId = 0;
+        for (int x = 0; x < width; ++x)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                for (int z = 0; z < depth; ++z)
+                {
+                    const int label = labelAt(x, y, z);
+                    check(label >= 0 && label <= nextId, name + " component ids in first cell order");
+                    if (label == nextId) ++nextId;
+
+                    if (x > 0) check((cellAt(x - 1, y, z) == cellAt(x, y, z)) == (labelAt(x - 1, y, z) == label), name + " labels of x neighbours");
+                    if (y > 0) check((cellAt(x, y - 1, z) == cellAt(x, y, z)) == (labelAt(x, y - 1, z) == label), name + " labels of y neighbours");
+                    if (z > 0) check((cellAt(x, y, z - 1) == cellAt(x, y, z)) == (labelAt(x, y, z - 1) == label), name + " labels of z neighbours");
+                }
+            }
+        }
+        check(nextId == numComponents, name + " component ids are consecutive");
+    }
+
+    // Few distinct values, so that there are both large and single cell regions.
+    void testFloodFillAndConnectedComponents()
+    {
+        std::mt19937 rng(2468);
+        ls::ThreadPool pool(4);
+
+        for (int iteration = 0; iteration < 20; ++iteration)
+        {
+            const int width = 1 + static_cast<int>(rng() % 40);
+            const int height = 1 + static_cast<int>(rng() % 40);
+            ls::Array2<int> arr(width, height);
+            for (auto& cell : arr) cell = static_cast<int>(rng() % 3);
+            const auto cellAt2 = [&arr](int x, int y, int) { return arr(x, y); };
+
+            const int seedX = static_cast<int>(rng() % width);
+            const int seedY = static_cast<int>(rng() % height);
+            ls::Array2<int> filled = arr;
+            filled.floodFill(seedX, seedY, 7);
+            ls::Array2<int> expected = arr;
+            std::vector<unsigned char> isVisited(static_cast<std::size_t>(width * height), 0);
+            referenceFloodFill(width, height, 1, seedX, seedY, 0, isVisited, cellAt2, [&expected](int x, int y, int) { expected(x, y) = 7; });
+            check(std::equal(filled.begin(), filled.end(), expected.begin()), "2D flood fill");
+
+            ls::Array2<int> labels(width, height);
+            const int numComponents = static_cast<int>(ls::labelConnectedComponents(arr, labels, pool));
+            checkComponentLabels(width, height, 1, numComponents, cellAt2, [&labels](int x, int y, int) { return labels(x, y); }, "2D connected components");
+        }
+
+        for (int iteration = 0; iteration < 20; ++iteration)
+        {
+            const int width = 1 + static_cast<int>(rng() % 12);
+            const int height = 1 + static_cast<int>(rng() % 12);
+            const int depth = 1 + static_cast<int>(rng() % 12);
+            ls::Array3<int> arr(width, height, depth);
+            for (auto& cell : arr) cell = static_cast<int>(rng() % 3);
+            const auto cellAt3 = [&arr](int x, int y, int z) { return arr(x, y, z); };
+
+            const int seedX = static_cast<int>(rng() % width);
+            const int seedY = static_cast<int>(rng() % height);
+            const int seedZ = static_cast<int>(rng() % depth);
+            ls::Array3<int> filled = arr;
+            filled.floodFill(seedX, seedY, seedZ, 7);
+            ls::Array3<int> expected = arr;
+            std::vector<unsigned char> isVisited(static_cast<std::size_t>(width * height * depth), 0);
+            referenceFloodFill(width, height, depth, seedX, seedY, seedZ, isVisited, cellAt3, [&expected](int x, int y, int z) { expected(x, y, z) = 7; });
+            check(std::equal(filled.begin(), filled.end(), expected.begin()), "3D flood fill");
+
+            ls::Array3<int> labels(width, height, depth);
+            const int numComponents = static_cast<int>(ls::labelConnectedComponents(arr, labels, pool));
+            checkComponentLabels(width, height, depth, numComponents, cellAt3, [&labels](int x, int y, int z) { return labels(x, y, z); }, "3D connected components");
+        }
+    }
+
+    // A mapped array has to read back what was written, and files that don't match the type,
+    // the layout or the size recorded in the header have to be refused.
+    void testMappedArray()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string path = (directory / "libs_tests_mapped_array.bin").string();
+        const std::string truncatedPath = (directory / "libs_tests_mapped_array_truncated.bin").string();
+
+        const auto throws = [](auto&& func) {
+            try
+            {
+                func();
+            }
+            catch (const std::runtime_error&)
+            {
+                return true;
+            }
+            return false;
+        };
+
+        {
+            auto arr = ls::MappedArray2<float>::createFile(path, 37, 23);
+            for (int x = 0; x < arr.width(); ++x)
+            {
+                for (int y = 0; y < arr.height(); ++y)
+                {
+                    arr(x, y) = static_cast<float>(x * 1000 + y);
+                }
+            }
+            arr.flush();
+        }
+
+        {
+            const auto arr = ls::MappedArray2<float>::fromFile(path);
+            check(arr.width() == 37 && arr.height() == 23, "mapped array extents");
+            for (int x = 0; x < arr.width(); ++x)
+            {
+                for (int y = 0; y < arr.height(); ++y)
+                {
+                    check(arr(x, y) == static_cast<float>(x * 1000 + y), "mapped array values");
+                }
+            }
+        }
+
+        check(throws([&]() { ls::MappedArray2<std::int32_t>::fromFile(path); }), "mapped array with a different element type");
+        check(throws([&]() { ls::MappedArray2<float, ls::RowMajorLayout>::fromFile(path); }), "mapped array with a different layout");
+        check(throws([&]() { ls::MappedArray3<float>::fromFile(path); }), "mapped array with a different number of dimensions");
+
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            contents.resize(contents.size() - sizeof(float));
+            std::ofstream out(truncatedPath, std::ios::binary);
+            out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        }
+        check(throws([&]() { ls::MappedArray2<float>::fromFile(truncatedPath); }), "truncated mapped array");
+
+        std::filesystem::remove(path);
+        std::filesystem::remove(truncatedPath);
+    }
+
+    // Json values written so that they can be compared between the tree and the sax parser.
+    // Object members are sorted and only the first of equal keys is kept, like in Value::Object.
+    std::string describeJsonString(std::string_view str)
+    {
+        return "s" + std::to_string(str.size()) + ":" + std::string(str);
+    }
+
+    std::string describeJsonDouble(double d)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "d%a", d);
+        return buffer;
+    }
+
+    std::string describeJsonContainer(bool isObject, std::vector<std::pair<std::string, std::string>> members)
+    {
+        if (isObject)
+        {
+            const auto keyLess = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+            const auto keyEqual = [](const auto& lhs, const auto& rhs) { return lhs.first == rhs.first; };
+            std::stable_sort(members.begin(), members.end(), keyLess);
+            members.erase(std::unique(members.begin(), members.end(), keyEqual), members.end());
+        }
+
+        std::string result = isObject ? "{" : "[";
+        for (const auto& member : members)
+        {
+            if (isObject) result += describeJsonString(member.first) + "=";
+            result += member.second + ",";
+        }
+        result += isObject ? "}" : "]";
+        return result;
+    }
+
+    std::string describeJson(const ls::json::Value& val)
+    {
+        if (val.isArray())
+        {
+            std::vector<std::pair<std::string, std::string>> members;
+            for (const auto& element : val.getArray()) members.emplace_back(std::string(), describeJson(element));
+            return describeJsonContainer(false, std::move(members));
+        }
+        if (val.isObject())
+        {
+            std::vector<std::pair<std::string, std::string>> members;
+            for (const auto& member : val.getObject()) members.emplace_back(std::string(member.first), describeJson(member.second));
+            return describeJsonContainer(true, std::move(members));
+        }
+        if (val.isString()) return describeJsonString(val.getString());
+        if (val.isInt()) return "i" + std::to_string(val.getInt());
+        if (val.isFloat()) return describeJsonDouble(val.getDouble());
+        if (val.isBool()) return val.getBool() ? "true" : "false";
+        return "null";
+    }
+
+    struct JsonDescriptionHandler
+    {
+        struct Container
+        {
+            bool isObject;
+            std::vector<std::pair<std::string, std::string>> members;
+            std::string key;
+        };
+
+        std::vector<Container> stack;
+        std::string result;
+
+        void startObject() { stack.push_back(Container{ true, {}, {} }); }
+        void endObject() { end(); }
+        void startArray() { stack.push_back(Container{ false, {}, {} }); }
+        void endArray() { end(); }
+        void key(std::string_view k) { stack.back().key = std::string(k); }
+        void value(std::string_view str) { add(describeJsonString(str)); }
+        void value(int64_t i) { add("i" + std::to_string(i)); }
+        void value(double d) { add(describeJsonDouble(d)); }
+        void value(bool b) { add(b ? "true" : "false"); }
+        void value(std::nullptr_t) { add("null"); }
+
+        void add(std::string description)
+        {
+            if (stack.empty()) result = std::move(description);
+            else stack.back().members.emplace_back(stack.back().key, std::move(description));
+        }
+
+        void end()
+        {
+            Container container = std::move(stack.back());
+            stack.pop_back();
+            add(describeJsonContainer(container.isObject, std::move(container.members)));
+        }
+    };
+
+    // Description of the first value in the document, or the message of the parsing error.
+    // Other exceptions are not caught, all errors have to be located.
+    template <typename ParseT>
+    std::string describeJsonOrError(ParseT&& parse)
+    {
+        try
+        {
+            return parse();
+        }
+        catch (const ls::json::DocumentParser::ParsingError& e)
+        {
+            return std::string("error: ") + e.what();
+        }
+    }
+
+    // Results of all parsing paths, labeled. Documents given whole are parsed with every simd level.
+    std::vector<std::pair<std::string, std::string>> parseJsonAllPaths(const std::string& doc)
+    {
+        std::vector<std::pair<std::string, std::string>> results;
+
+        for (ls::SimdLevel level : { ls::SimdLevel::None, ls::SimdLevel::Sse2, ls::SimdLevel::Avx2 })
+        {
+            const std::string levelName = " simd level " + std::to_string(static_cast<int>(level));
+
+            results.emplace_back("indexed" + levelName, describeJsonOrError([&]() {
+                return describeJson(ls::json::DocumentParser(doc, std::pmr::get_default_resource(), level).parse());
+            }));
+
+            results.emplace_back("arena" + levelName, describeJsonOrError([&]() {
+                std::pmr::monotonic_buffer_resource arena;
+                return describeJson(ls::json::DocumentParser(doc, &arena, level).parse());
+            }));
+
+            results.emplace_back("in situ" + levelName, describeJsonOrError([&]() {
+                std::string buffer = doc;
+                return describeJson(ls::json::DocumentParser::inSitu(buffer, std::pmr::get_default_resource(), level).parse());
+            }));
+
+            results.emplace_back("sax" + levelName, describeJsonOrError([&]() {
+                ls::json::SaxParser parser(doc, level);
+                JsonDescriptionHandler handler;
+                parser.next(handler);
+                return handler.result;
+            }));
+        }
+
+        for (std::size_t chunkSize : { std::size_t(1), std::size_t(3), ls::json::SaxParser::defaultChunkSize })
+        {
+            results.emplace_back("streamed sax chunk size " + std::to_string(chunkSize), describeJsonOrError([&]() {
+                std::istringstream stream(doc);
+                ls::json::SaxParser parser(stream, chunkSize);
+                JsonDescriptionHandler handler;
+                parser.next(handler);
+                return handler.result;
+            }));
+        }
+
+        return results;
+    }
+
+    // Documents in the spirit of JSONTestSuite. Every parsing path has to give the same value,
+    // or for invalid documents the same error at the same location.
+    // Only single values are used, DocumentParser doesn't look past the first one.
+    void testJsonConformance()
+    {
+        std::vector<std::string> validDocs = {
+            "[]",
+            "{}",
+            "[[]   ]",
+            " \t\r\n[1] \n",
+            "[-0]",
+            "[-0.0]",
+            "[0.5, -1.25, 1E22, 1e-2, 1E+2, 123.456e78, 20e1, 1.5e-0]",
+            "[-123, 0, 9223372036854775807]",
+            "[true, false, null]",
+            "{\"a\":\"b\",\"\":0}",
+            "{\"a\":[],\"b\":{},\"c\":[{}]}",
+            "{\"a\":1,\"a\":2}",
+            "{\"b\":1,\"a\":2,\"c\":{\"z\":null,\"y\":true}}",
+            "[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"]",
+            "[\"\xc3\xa9\xe2\x82\xac\"]",
+            "[\"a\" , \"\" ,\"b\"]",
+            "{ \"k\\\"ey\" : [1, {\"x\" : null}] }",
+            "\"top level string\"",
+            "42",
+            "-1.5",
+            "true",
+            "null",
+            "[1,\n2,\r\n3]",
+            // escapes and quotes around the 64 character blocks of the index
+            "[\"" + std::string(61, 'a') + "\\\"\\\\\", \"" + std::string(63, 'b') + "\\n\"]",
+            "{\"" + std::string(62, 'k') + "\":\"" + std::string(130, 'v') + "\\\\\"}",
+            std::string(100, '[') + "0" + std::string(100, ']')
+        };
+
+        std::vector<std::pair<std::string, std::string>> invalidDocs = {
+            { "]", "Unexpected character at 1:1" },
+            { "[", "Unterminated array at 1:2" },
+            { "[1,]", "Unexpected character at 1:4" },
+            { "[1 2]", "Expected ',' or ']' at 1:4" },
+            { "[1,\n  x]", "Unexpected character at 2:3" },
+            { "[\"a\",,1]", "Unexpected character at 1:6" },
+            { "{", "Unterminated object at 1:2" },
+            { "{\"a\":1", "Unterminated object at 1:7" },
+            { "{\"a\" 1}", "Expected ':' after key name at 1:6" },
+            { "{1:1}", "Expected key name at 1:2" },
+            { "{\"a\":1,}", "Expected key name at 1:8" },
+            { "{\"a\":1 \"b\":2}", "Expected ',' or '}' at 1:8" },
+            { "{\"a\"", "Unexpected end of stream at 1:5" },
+            { "[tru]", "Invalid boolean constant at 1:2" },
+            { "[True]", "Unexpected character at 1:2" },
+            { "[1, nul]", "Invalid null constant at 1:5" },
+            { "[01]", "Invalid number at 1:2" },
+            { "[-01]", "Invalid number at 1:2" },
+            { "[1.]", "Invalid number at 1:2" },
+            { "[.5]", "Unexpected character at 1:2" },
+            { "[+1]", "Unexpected character at 1:2" },
+            { "[-]", "Invalid number at 1:2" },
+            { "[1e]", "Invalid number at 1:2" },
+            { "[1e+]", "Invalid number at 1:2" },
+            { "[1.2.3]", "Invalid number at 1:2" },
+            { "[0x10]", "Invalid number at 1:2" },
+            { "[1a]", "Invalid number at 1:2" },
+            { "[-Infinity]", "Invalid number at 1:2" },
+            { "[NaN]", "Unexpected character at 1:2" },
+            { "\n  -", "Invalid number at 2:3" },
+            { "[\"abc", "Unterminated string at 1:6" },
+            { "[\"a\\qb\"]", "Invalid escape sequence at 1:5" },
+            { "[\"a\\", "Invalid escape sequence at 1:5" },
+            { "[\"a\tb\"]", "No control characters allowed inside strings at 1:4" },
+            { "[\"a\nb\"]", "No control characters allowed inside strings at 1:4" },
+            // the in situ path overwrites escapes, which must not move the reported location
+            { "[\"a\\nb\\tc\",\n \"d\\\"e\", tru]", "Invalid boolean constant at 2:10" },
+            { "[\"a\\nb\\tc\\q\"]", "Invalid escape sequence at 1:11" },
+            { "[\"a\\nb\x01\"]", "No control characters allowed inside strings at 1:7" },
+            { "[\"" + std::string(70, 'a') + "\\n\", " + "x]", "Unexpected character at 1:78" }
+        };
+
+        for (const std::string& doc : validDocs)
+        {
+            const auto results = parseJsonAllPaths(doc);
+            check(results.front().second.rfind("error", 0) != 0, "json document " + doc + " is valid, but " + results.front().second);
+            for (const auto& [path, result] : results)
+            {
+                check(result == results.front().second, "json document " + doc + " parsed by " + path + " is " + result + " instead of " + results.front().second);
+            }
+        }
+
+        for (const auto& [doc, error] : invalidDocs)
+        {
+            for (const auto& [path, result] : parseJsonAllPaths(doc))
+            {
+                check(result == "error: " + error, "json document " + doc + " parsed by " + path + " gives " + result + " instead of " + error);
+            }
+        }
+    }
+}
+
+// Throws on the first failed check.
+void mainTests()
+{
+    testNoiseGridLayouts();
+    testFractalNoise();
+    testNoiseTileCache();
+    testJsonConformance();
+    testBitPackedCellularAutomata();
+    testHashLife();
+    testFloodFillAndConnectedComponents();
+    testMappedArray();
+
+    std::cout << "All tests passed\n";
+}